@@ -205,6 +205,8 @@ static constexpr consoleCommand_t commands[] = {
 	{ "loadhud",       CG_LoadHud_f },
 	{ "nextframe",     CG_TestModelNextFrame_f },
 	{ "nextskin",      CG_TestModelNextSkin_f },
+	{ "pmovebench",    CG_PmoveBench_f },
+	{ "predictstats",  CG_PredictStats_f },
 	{ "prevframe",     CG_TestModelPrevFrame_f },
 	{ "prevskin",      CG_TestModelPrevSkin_f },
 	{ "sizedown",      CG_SizeDown_f },
@@ -2655,8 +2655,21 @@ void CG_AdjustPositionForMover( const vec3_t in, int moverNum, int fromTime, int
 	// FIXME: origin change when on a rotating object
 }
 
+// The endpoints only depend on the two snapshots, so they are evaluated once per snapshot instead of every frame
+static void CG_EvaluateSnapLerp( centity_t *cent ) {
+	BG_EvaluateTrajectory( &cent->currentState.pos, cg.snap->serverTime, cent->snapLerpOrigin[0] );
+	BG_EvaluateTrajectory( &cent->nextState.pos, cg.nextSnap->serverTime, cent->snapLerpOrigin[1] );
+	BG_EvaluateTrajectory( &cent->currentState.apos, cg.snap->serverTime, cent->snapLerpAngles[0] );
+	BG_EvaluateTrajectory( &cent->nextState.apos, cg.nextSnap->serverTime, cent->snapLerpAngles[1] );
+
+	cent->snapLerpStatic = VectorCompare( cent->snapLerpOrigin[0], cent->snapLerpOrigin[1] )
+		&& VectorCompare( cent->snapLerpAngles[0], cent->snapLerpAngles[1] );
+	cent->snapLerpType = cent->currentState.pos.trType;
+	cent->snapLerpValid = true;
+}
+
 static void CG_InterpolateEntityPosition( centity_t *cent ) {
-	vec3_t		current, next;
+	const float	*current, *next;
 	float		f;
 
 	// it would be an internal error to find an entity that interpolates without
@@ -2666,19 +2679,30 @@ static void CG_InterpolateEntityPosition( centity_t *cent ) {
 		return;
 	}
 
+	// cg_smoothClients can retype the trajectory under us
+	if ( !cent->snapLerpValid || cent->snapLerpType != cent->currentState.pos.trType ) {
+		CG_EvaluateSnapLerp( cent );
+	}
+
+	if ( cent->snapLerpStatic ) {
+		VectorCopy( cent->snapLerpOrigin[0], cent->lerpOrigin );
+		VectorCopy( cent->snapLerpAngles[0], cent->lerpAngles );
+		return;
+	}
+
 	f = cg.frameInterpolation;
 
 	// this will linearize a sine or parabolic curve, but it is important
 	// to not extrapolate player positions if more recent data is available
-	BG_EvaluateTrajectory( &cent->currentState.pos, cg.snap->serverTime, current );
-	BG_EvaluateTrajectory( &cent->nextState.pos, cg.nextSnap->serverTime, next );
+	current = cent->snapLerpOrigin[0];
+	next = cent->snapLerpOrigin[1];
 
 	cent->lerpOrigin[0] = current[0] + f * ( next[0] - current[0] );
 	cent->lerpOrigin[1] = current[1] + f * ( next[1] - current[1] );
 	cent->lerpOrigin[2] = current[2] + f * ( next[2] - current[2] );
 
-	BG_EvaluateTrajectory( &cent->currentState.apos, cg.snap->serverTime, current );
-	BG_EvaluateTrajectory( &cent->nextState.apos, cg.nextSnap->serverTime, next );
+	current = cent->snapLerpAngles[0];
+	next = cent->snapLerpAngles[1];
 
 	cent->lerpAngles[0] = LerpAngle( current[0], next[0], f );
 	cent->lerpAngles[1] = LerpAngle( current[1], next[1], f );
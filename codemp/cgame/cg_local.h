@@ -55,7 +55,6 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define MAX_CUSTOM_EXTRA_SOUNDS        40
 #define MAX_CUSTOM_JEDI_SOUNDS         40
 #define MAX_CUSTOM_SOUNDS              40
-#define MAX_MARK_POLYS                 256
 #define MAX_PREDICTED_EVENTS           16
 #define MAX_REWARDSTACK                10
 #define MAX_SKULLTRAIL                 10
@@ -70,6 +69,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define NUM_FONT_BIG                   1
 #define NUM_FONT_CHUNKY                3
 #define NUM_FONT_SMALL                 2
+#define NUM_SAVED_STATES               ( CMD_BACKUP + 2 ) // predicted states kept for cg_optimizePrediction
 #define PAIN_TWITCH_TIME               200
 #define POWERUP_BLINK_TIME             1000
 #define POWERUP_BLINKS                 5
@@ -141,7 +141,8 @@ enum leType_e {
 	LE_SCOREPLUM,
 	LE_OLINE,
 	LE_SHOWREFENTITY,
-	LE_LINE
+	LE_LINE,
+	LE_NUM_TYPES
 };
 
 enum leFlag_e : uint32_t {
@@ -300,6 +301,11 @@ struct centity_t {
 	entityState_t   nextState;              // from cg.nextFrame, if available
 	bool            interpolate;            // true if next is valid to interpolate to
 	bool            currentValid;           // true if cg.frame holds this entity
+	bool            snapLerpValid;          // snapLerpOrigin/Angles hold the endpoints for cg.snap -> cg.nextSnap
+	bool            snapLerpStatic;         // both endpoints are the same, so there is nothing to lerp
+	int             snapLerpType;           // pos.trType the endpoints were evaluated with
+	vec3_t          snapLerpOrigin[2];      // evaluated at cg.snap and cg.nextSnap serverTime
+	vec3_t          snapLerpAngles[2];
 	int             muzzleFlashTime;        // move to playerEntity?
 	int             previousEvent;
 	int             trailTime;              // so missile trails can handle dropped initial packets
@@ -363,6 +369,8 @@ struct centity_t {
 struct markPoly_t {
 	markPoly_t *prevMark, *nextMark;
 	int         time;
+	vec3_t      cullOrigin; // off the surface, so the PVS test doesn't land in solid
+	float       cullRadius;
 	qhandle_t   markShader;
 	bool        alphaFade; // fade alpha instead of rgb
 	float       color[4];
@@ -372,6 +380,7 @@ struct markPoly_t {
 
 struct localEntity_t {
 	localEntity_t       *prev, *next;
+	unsigned int         allocOrder;   // picks the oldest to evict across the per-type lists
 	leType_e             leType;
 	int                  leFlags;
 	int                  startTime;
@@ -580,6 +589,16 @@ struct cg_t {
 	bool           hyperspace;                      // true if prediction has hit a trigger_teleport
 	playerState_t  predictedPlayerState;
 	bool           validPPS;                        // clear until the first call to CG_PredictPlayerState
+	playerState_t  savedPmoveStates[NUM_SAVED_STATES]; // ring of states predicted after each command, for cg_optimizePrediction
+	int            stateHead;                       // oldest saved state still usable
+	int            stateTail;                       // one past the newest saved state
+	int            lastPredictedCommand;            // command number of the newest saved state
+	int            lastServerTime;                  // physicsTime the saved states were checked against
+	int            savedStartSlopeRecalcTime;       // slopeRecalcTime of the state the saved states were predicted from
+	int            predictIncremental;              // frames that resumed from the saved states
+	int            predictFull;                     // frames that replayed every command
+	int            predictPmoves;                   // commands actually run through Pmove
+	int            predictPlayedBack;               // commands taken from the saved states
 	int            predictedErrorTime;
 	vec3_t         predictedError;
 	int            eventSequence;
@@ -848,7 +867,7 @@ extern centity_t      *cg_permanents[MAX_GENTITIES];
 extern int             cg_numpermanents;
 extern weaponInfo_t    cg_weapons[MAX_WEAPONS];
 extern itemInfo_t      cg_items[MAX_ITEMS];
-extern markPoly_t      cg_markPolys[MAX_MARK_POLYS];
+extern markPoly_t     *cg_markPolys;
 extern cgs_t           cgs;
 extern cgscreffects_t  cgScreenEffects;
 extern forceTicPos_t   forceTicPos[];
@@ -997,11 +1016,15 @@ void           CG_PlayDoorLoopSound             ( centity_t *cent );
 void           CG_PlayDoorSound                 ( centity_t *cent, int type );
 void           CG_Player                        ( centity_t *cent );
 void           CG_PlayerShieldHit               ( int entitynum, vec3_t angles, int amount );
+void           CG_PmoveBench_f                  ( void );
+void           CG_PmoveBenchRecord              ( const pmove_t *pmove );
+void           CG_PmoveBenchRecorded            ( const playerState_t *ps );
 void           CG_PmoveClientPointerUpdate      ( void );
 int            CG_PointContents                 ( const vec3_t point, int passEntityNum );
 void           CG_PositionEntityOnTag           ( refEntity_t *entity, const refEntity_t *parent, qhandle_t parentModel, char *tagName );
 void           CG_PositionRotatedEntityOnTag    ( refEntity_t *entity, const refEntity_t *parent, qhandle_t parentModel, char *tagName );
 void           CG_PredictPlayerState            ( void );
+void           CG_PredictStats_f                ( void );
 void           CG_PrevForcePower_f              ( void );
 void           CG_PrevInventory_f               ( void );
 void           CG_PrevWeapon_f                  ( void );
@@ -1031,6 +1054,8 @@ void           CG_SetScoreSelection             ( void *menu );
 void           CG_ShaderStateChanged            ( void );
 void           CG_ShowResponseHead              ( void );
 void           CG_ShutDownG2Weapons             ( void );
+void           CG_ShutdownLocalEntities         ( void );
+void           CG_ShutdownMarkPolys             ( void );
 localEntity_t *CG_SmokePuff                     ( const vec3_t p, const vec3_t vel, float radius, float r, float g, float b, float a, float duration, int startTime, int fadeInTime, int leFlags, qhandle_t hShader );
 void           CG_Spark                         ( vec3_t origin, vec3_t dir );
 void           CG_Spark                         ( vec3_t origin, vec3_t dir );
@@ -28,22 +28,63 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "cgame/cg_local.h"
 #include "cgame/cg_media.h"
 
-#define	MAX_LOCAL_ENTITIES	2048 // 512
-localEntity_t	cg_localEntities[MAX_LOCAL_ENTITIES];
-localEntity_t	cg_activeLocalEntities;		// double linked list
+// the pool is sized by cg_maxLocalEntities, active entities are kept in one list per leType so CG_AddLocalEntities
+//	can run each type as a batch
+#define	MIN_LOCAL_ENTITIES	512
+#define	MAX_LOCAL_ENTITIES	16384
+
+localEntity_t	*cg_localEntities;
+static int		cg_numLocalEntities;
+static localEntity_t	cg_newLocalEntities;					// double linked list, allocated since the last binning
+static localEntity_t	cg_activeLocalEntities[LE_NUM_TYPES];	// double linked lists, oldest at the tail
 localEntity_t	*cg_freeLocalEntities;		// single linked list
+static localEntity_t	*cg_nextLocalEntity;	// CG_AddLocalEntities' walk, moved on if that entity is freed under it
+static unsigned int		cg_localEntityOrder;
+
+static void CG_ClearLocalEntityList( localEntity_t *list ) {
+	list->next = list;
+	list->prev = list;
+}
+
+static void CG_LinkLocalEntity( localEntity_t *list, localEntity_t *le ) {
+	le->next = list->next;
+	le->prev = list;
+	list->next->prev = le;
+	list->next = le;
+}
 
 // This is called at startup and for tournament restarts
 void	CG_InitLocalEntities( void ) {
 	int		i;
+	const int	numLocalEntities = Com_Clampi( MIN_LOCAL_ENTITIES, MAX_LOCAL_ENTITIES, cg_maxLocalEntities.integer );
 
-	memset( cg_localEntities, 0, sizeof( cg_localEntities ) );
-	cg_activeLocalEntities.next = &cg_activeLocalEntities;
-	cg_activeLocalEntities.prev = &cg_activeLocalEntities;
+	if ( cg_localEntities && cg_numLocalEntities != numLocalEntities ) {
+		CG_ShutdownLocalEntities();
+	}
+	if ( !cg_localEntities ) {
+		trap->TrueMalloc( (void **)&cg_localEntities, numLocalEntities * sizeof( localEntity_t ) );
+		cg_numLocalEntities = numLocalEntities;
+	}
+
+	memset( cg_localEntities, 0, cg_numLocalEntities * sizeof( localEntity_t ) );
+	CG_ClearLocalEntityList( &cg_newLocalEntities );
+	for ( i = 0 ; i < LE_NUM_TYPES ; i++ ) {
+		CG_ClearLocalEntityList( &cg_activeLocalEntities[i] );
+	}
 	cg_freeLocalEntities = cg_localEntities;
-	for ( i = 0 ; i < MAX_LOCAL_ENTITIES - 1 ; i++ ) {
+	for ( i = 0 ; i < cg_numLocalEntities - 1 ; i++ ) {
 		cg_localEntities[i].next = &cg_localEntities[i+1];
 	}
+	cg_nextLocalEntity = nullptr;
+}
+
+void CG_ShutdownLocalEntities( void ) {
+	if ( cg_localEntities ) {
+		trap->TrueFree( (void **)&cg_localEntities );
+	}
+	cg_localEntities = nullptr;
+	cg_freeLocalEntities = nullptr;
+	cg_numLocalEntities = 0;
 }
 
 void CG_FreeLocalEntity( localEntity_t *le ) {
@@ -52,6 +93,11 @@ void CG_FreeLocalEntity( localEntity_t *le ) {
 		return;
 	}
 
+	// the walk goes from the tail towards the head
+	if ( le == cg_nextLocalEntity ) {
+		cg_nextLocalEntity = le->prev;
+	}
+
 	// remove from the doubly linked active list
 	le->prev->next = le->next;
 	le->next->prev = le->prev;
@@ -61,29 +107,84 @@ void CG_FreeLocalEntity( localEntity_t *le ) {
 	cg_freeLocalEntities = le;
 }
 
+// The oldest entity is at the tail of one of the type lists, or of the new list if nothing has been binned yet
+static localEntity_t *CG_OldestLocalEntity( void ) {
+	localEntity_t	*oldest = nullptr;
+
+	for ( int i = -1 ; i < LE_NUM_TYPES ; i++ ) {
+		localEntity_t *list = ( i < 0 ) ? &cg_newLocalEntities : &cg_activeLocalEntities[i];
+		localEntity_t *le = list->prev;
+
+		if ( le != list && ( !oldest || (int)( le->allocOrder - oldest->allocOrder ) < 0 ) ) {
+			oldest = le;
+		}
+	}
+
+	return oldest;
+}
+
 // Will allways succeed, even if it requires freeing an old active entity
 localEntity_t	*CG_AllocLocalEntity( void ) {
 	localEntity_t	*le;
 
 	if ( !cg_freeLocalEntities ) {
-		// no free entities, so free the one at the end of the chain
-		// remove the oldest active entity
-		CG_FreeLocalEntity( cg_activeLocalEntities.prev );
+		// no free entities, so free the oldest active entity
+		CG_FreeLocalEntity( CG_OldestLocalEntity() );
 	}
 
 	le = cg_freeLocalEntities;
 	cg_freeLocalEntities = cg_freeLocalEntities->next;
 
 	memset( le, 0, sizeof( *le ) );
+	le->allocOrder = cg_localEntityOrder++;
 
-	// link into the active list
-	le->next = cg_activeLocalEntities.next;
-	le->prev = &cg_activeLocalEntities;
-	cg_activeLocalEntities.next->prev = le;
-	cg_activeLocalEntities.next = le;
+	// the type is only filled in by the caller, so it waits on the new list until the next CG_AddLocalEntities
+	CG_LinkLocalEntity( &cg_newLocalEntities, le );
 	return le;
 }
 
+// Coarse frustum and PVS cull for sprites and models. The renderer only frustum culls entities, so smoke and debris
+//	behind walls would otherwise still be drawn. Physics, marks and lights have already run by the time this is called
+static bool CG_CullLocalRefEntity( const refEntity_t *re ) {
+	float	radius;
+
+	if ( !cg_cullLocalEntities.integer ) {
+		return false;
+	}
+
+	if ( re->reType == RT_SPRITE ) {
+		radius = re->radius;
+	} else if ( re->reType == RT_MODEL ) {
+		vec3_t	mins, maxs, corner;
+		float	scale = 1.0f;
+
+		trap->R_ModelBounds( re->hModel, mins, maxs );
+		for ( int i = 0 ; i < 3 ; i++ ) {
+			corner[i] = Q_max( fabsf( mins[i] ), fabsf( maxs[i] ) );
+			scale = Q_max( scale, VectorLength( re->axis[i] ) );
+		}
+		radius = VectorLength( corner ) * scale;
+	} else {
+		return false;
+	}
+
+	if ( radius <= 0.0f ) {
+		return false;
+	}
+
+	if ( CG_CullPointAndRadius( re->origin, radius ) ) {
+		return true;
+	}
+
+	return !trap->R_InPVS( cg.refdef.vieworg, re->origin, cg.refdef.areamask );
+}
+
+static void CG_AddLocalRefEntityToScene( const refEntity_t *re ) {
+	if ( !CG_CullLocalRefEntity( re ) ) {
+		trap->R_AddRefEntityToScene( re );
+	}
+}
+
 // FRAGMENT PROCESSING
 // A fragment localentity interacts with the environment in some way (hitting walls), or generates more localentities along a trail.
 
@@ -230,9 +331,9 @@ void CG_AddFragment( localEntity_t *le ) {
 
 			le->refEntity.shaderRGBA[3] = t_e;
 
-			trap->R_AddRefEntityToScene( &le->refEntity );
+			CG_AddLocalRefEntityToScene( &le->refEntity );
 		} else {
-			trap->R_AddRefEntityToScene( &le->refEntity );
+			CG_AddLocalRefEntityToScene( &le->refEntity );
 		}
 
 		return;
@@ -255,7 +356,7 @@ void CG_AddFragment( localEntity_t *le ) {
 			ScaleModelAxis(&le->refEntity);
 		}
 
-		trap->R_AddRefEntityToScene( &le->refEntity );
+		CG_AddLocalRefEntityToScene( &le->refEntity );
 
 		// add a blood trail
 		if ( le->leBounceSoundType == LEBS_BLOOD ) {
@@ -289,7 +390,7 @@ void CG_AddFragment( localEntity_t *le ) {
 		// reflect the velocity on the trace plane
 		CG_ReflectVelocity( le, &trace );
 
-		trap->R_AddRefEntityToScene( &le->refEntity );
+		CG_AddLocalRefEntityToScene( &le->refEntity );
 	}
 }
 
@@ -309,7 +410,7 @@ void CG_AddFadeRGB( localEntity_t *le ) {
 	re->shaderRGBA[2] = le->color[2] * c;
 	re->shaderRGBA[3] = le->color[3] * c;
 
-	trap->R_AddRefEntityToScene( re );
+	CG_AddLocalRefEntityToScene( re );
 }
 
 static void CG_AddFadeScaleModel( localEntity_t *le )
@@ -336,7 +437,7 @@ static void CG_AddFadeScaleModel( localEntity_t *le )
 	ent->shaderRGBA[3] = le->color[3] * frac;
 
 	// add the entity
-	trap->R_AddRefEntityToScene( ent );
+	CG_AddLocalRefEntityToScene( ent );
 }
 
 static void CG_AddMoveScaleFade( localEntity_t *le ) {
@@ -373,7 +474,7 @@ static void CG_AddMoveScaleFade( localEntity_t *le ) {
 		return;
 	}
 
-	trap->R_AddRefEntityToScene( re );
+	CG_AddLocalRefEntityToScene( re );
 }
 
 static void CG_AddPuff( localEntity_t *le ) {
@@ -406,7 +507,7 @@ static void CG_AddPuff( localEntity_t *le ) {
 		return;
 	}
 
-	trap->R_AddRefEntityToScene( re );
+	CG_AddLocalRefEntityToScene( re );
 }
 
 // For rocket smokes that hang in place, fade out, and are removed if the view passes through them.
@@ -434,7 +535,7 @@ static void CG_AddScaleFade( localEntity_t *le ) {
 		return;
 	}
 
-	trap->R_AddRefEntityToScene( re );
+	CG_AddLocalRefEntityToScene( re );
 }
 
 // This is just an optimized CG_AddMoveScaleFade
@@ -466,7 +567,7 @@ static void CG_AddFallScaleFade( localEntity_t *le ) {
 		return;
 	}
 
-	trap->R_AddRefEntityToScene( re );
+	CG_AddLocalRefEntityToScene( re );
 }
 
 static void CG_AddExplosion( localEntity_t *ex ) {
@@ -475,7 +576,7 @@ static void CG_AddExplosion( localEntity_t *ex ) {
 	ent = &ex->refEntity;
 
 	// add the entity
-	trap->R_AddRefEntityToScene(ent);
+	CG_AddLocalRefEntityToScene( ent );
 
 	// add the dlight
 	if ( ex->light ) {
@@ -511,7 +612,7 @@ static void CG_AddSpriteExplosion( localEntity_t *le ) {
 	re.reType = RT_SPRITE;
 	re.radius = 42 * ( 1.0 - c ) + 30;
 
-	trap->R_AddRefEntityToScene( &re );
+	CG_AddLocalRefEntityToScene( &re );
 
 	// add the dlight
 	if ( le->light ) {
@@ -533,7 +634,7 @@ void CG_AddRefEntity( localEntity_t *le ) {
 		CG_FreeLocalEntity( le );
 		return;
 	}
-	trap->R_AddRefEntityToScene( &le->refEntity );
+	CG_AddLocalRefEntityToScene( &le->refEntity );
 }
 
 #define NUMBER_SIZE		8
@@ -668,80 +769,81 @@ void CG_AddLine( localEntity_t *le )
 	trap->R_AddRefEntityToScene( re );
 }
 
-void CG_AddLocalEntities( void ) {
-	localEntity_t	*le, *next;
-
-	// walk the list backwards, so any new local entities generated
-	// (trails, marks, etc) will be present this frame
-	le = cg_activeLocalEntities.prev;
-	for ( ; le != &cg_activeLocalEntities ; le = next ) {
-		// grab next now, so if the local entity is freed we
-		// still have it
-		next = le->prev;
-
-		if ( cg.time >= le->endTime ) {
-			CG_FreeLocalEntity( le );
-			continue;
-		}
-		switch ( le->leType ) {
-		default:
-			trap->Error( ERR_DROP, "Bad leType: %i", le->leType );
-			break;
-
-		case LE_MARK:
-			break;
-
-		case LE_SPRITE_EXPLOSION:
-			CG_AddSpriteExplosion( le );
-			break;
-
-		case LE_EXPLOSION:
-			CG_AddExplosion( le );
-			break;
-
-		case LE_FADE_SCALE_MODEL:
-			CG_AddFadeScaleModel( le );
-			break;
+typedef void ( *leAddFunc_t )( localEntity_t *le );
+
+static const leAddFunc_t leAddFuncs[LE_NUM_TYPES] = {
+	nullptr,					// LE_MARK
+	CG_AddExplosion,			// LE_EXPLOSION
+	CG_AddSpriteExplosion,		// LE_SPRITE_EXPLOSION
+	CG_AddFadeScaleModel,		// LE_FADE_SCALE_MODEL
+	CG_AddFragment,				// LE_FRAGMENT, gibs and brass
+	CG_AddPuff,					// LE_PUFF
+	CG_AddMoveScaleFade,		// LE_MOVE_SCALE_FADE, water bubbles
+	CG_AddFallScaleFade,		// LE_FALL_SCALE_FADE, gib blood trails
+	CG_AddFadeRGB,				// LE_FADE_RGB, teleporters, railtrails
+	CG_AddScaleFade,			// LE_SCALE_FADE, rocket trails
+	CG_AddScorePlum,			// LE_SCOREPLUM
+	CG_AddOLine,				// LE_OLINE
+	CG_AddRefEntity,			// LE_SHOWREFENTITY
+	CG_AddLine,					// LE_LINE, oriented lines for FX
+};
+
+// Moves the oldest entity off the new list into its type's list and returns it
+static localEntity_t *CG_BinNewLocalEntity( void ) {
+	localEntity_t	*le = cg_newLocalEntities.prev;
+
+	if ( (unsigned)le->leType >= LE_NUM_TYPES ) {
+		trap->Error( ERR_DROP, "Bad leType: %i", le->leType );
+	}
 
-		case LE_FRAGMENT:			// gibs and brass
-			CG_AddFragment( le );
-			break;
+	le->prev->next = le->next;
+	le->next->prev = le->prev;
+	CG_LinkLocalEntity( &cg_activeLocalEntities[le->leType], le );
 
-		case LE_PUFF:
-			CG_AddPuff( le );
-			break;
+	return le;
+}
 
-		case LE_MOVE_SCALE_FADE:		// water bubbles
-			CG_AddMoveScaleFade( le );
-			break;
+static void CG_AddLocalEntity( localEntity_t *le ) {
+	if ( cg.time >= le->endTime ) {
+		CG_FreeLocalEntity( le );
+		return;
+	}
 
-		case LE_FADE_RGB:				// teleporters, railtrails
-			CG_AddFadeRGB( le );
-			break;
+	if ( leAddFuncs[le->leType] ) {
+		leAddFuncs[le->leType]( le );
+	}
+}
 
-		case LE_FALL_SCALE_FADE: // gib blood trails
-			CG_AddFallScaleFade( le );
-			break;
+void CG_AddLocalEntities( void ) {
+	localEntity_t	*le;
 
-		case LE_SCALE_FADE:		// rocket trails
-			CG_AddScaleFade( le );
-			break;
+	while ( cg_newLocalEntities.prev != &cg_newLocalEntities ) {
+		CG_BinNewLocalEntity();
+	}
 
-		case LE_SCOREPLUM:
-			CG_AddScorePlum( le );
-			break;
+	// walk each list backwards, oldest first
+	for ( int type = 0 ; type < LE_NUM_TYPES ; type++ ) {
+		localEntity_t *list = &cg_activeLocalEntities[type];
 
-		case LE_OLINE:
-			CG_AddOLine( le );
-			break;
+		for ( le = list->prev ; le != list ; le = cg_nextLocalEntity ) {
+			// grab next now, CG_FreeLocalEntity keeps it valid if that one is freed
+			cg_nextLocalEntity = le->prev;
 
-		case LE_SHOWREFENTITY:
-			CG_AddRefEntity( le );
-			break;
+			if ( le->leType != type ) {
+				// retyped after it was binned, the pass below picks it up
+				le->prev->next = le->next;
+				le->next->prev = le->prev;
+				CG_LinkLocalEntity( &cg_newLocalEntities, le );
+				continue;
+			}
 
-		case LE_LINE:					// oriented lines for FX
-			CG_AddLine( le );
-			break;
+			CG_AddLocalEntity( le );
 		}
 	}
+	cg_nextLocalEntity = nullptr;
+
+	// any new local entities generated (trails, marks, etc) will be present this frame
+	while ( cg_newLocalEntities.prev != &cg_newLocalEntities ) {
+		CG_AddLocalEntity( CG_BinNewLocalEntity() );
+	}
 }
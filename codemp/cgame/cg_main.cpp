@@ -1254,6 +1254,9 @@ void CG_Shutdown( void )
 	UI_CleanupGhoul2();
 	//If there was any ghoul2 stuff in our side of the shared ui code, then remove it now.
 
+	CG_ShutdownLocalEntities();
+	CG_ShutdownMarkPolys();
+
 	// some mods may need to do cleanup work here,
 	// like closing files or archiving session data
 }
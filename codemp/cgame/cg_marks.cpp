@@ -26,25 +26,48 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "cgame/cg_local.h"
 
+// the pool is sized by cg_maxMarkPolys
+#define	MIN_MARK_POLYS	256
+#define	MAX_MARK_POLYS	8192
+
 markPoly_t	cg_activeMarkPolys;			// double linked list
 markPoly_t	*cg_freeMarkPolys;			// single linked list
-markPoly_t	cg_markPolys[MAX_MARK_POLYS];
+markPoly_t	*cg_markPolys;
+static		int	cg_numMarkPolys;
 static		int	markTotal;
 
 // This is called at startup and for tournament restarts
 void	CG_InitMarkPolys( void ) {
 	int		i;
+	const int	numMarkPolys = Com_Clampi( MIN_MARK_POLYS, MAX_MARK_POLYS, cg_maxMarkPolys.integer );
 
-	memset( cg_markPolys, 0, sizeof(cg_markPolys) );
+	if ( cg_markPolys && cg_numMarkPolys != numMarkPolys ) {
+		CG_ShutdownMarkPolys();
+	}
+	if ( !cg_markPolys ) {
+		trap->TrueMalloc( (void **)&cg_markPolys, numMarkPolys * sizeof( markPoly_t ) );
+		cg_numMarkPolys = numMarkPolys;
+	}
+
+	memset( cg_markPolys, 0, cg_numMarkPolys * sizeof( markPoly_t ) );
 
 	cg_activeMarkPolys.nextMark = &cg_activeMarkPolys;
 	cg_activeMarkPolys.prevMark = &cg_activeMarkPolys;
 	cg_freeMarkPolys = cg_markPolys;
-	for ( i = 0 ; i < MAX_MARK_POLYS - 1 ; i++ ) {
+	for ( i = 0 ; i < cg_numMarkPolys - 1 ; i++ ) {
 		cg_markPolys[i].nextMark = &cg_markPolys[i+1];
 	}
 }
 
+void CG_ShutdownMarkPolys( void ) {
+	if ( cg_markPolys ) {
+		trap->TrueFree( (void **)&cg_markPolys );
+	}
+	cg_markPolys = nullptr;
+	cg_freeMarkPolys = nullptr;
+	cg_numMarkPolys = 0;
+}
+
 void CG_FreeMarkPoly( markPoly_t *le ) {
 	if ( !le->prevMark ) {
 		trap->Error( ERR_DROP, "CG_FreeLocalEntity: not active" );
@@ -183,6 +206,8 @@ void CG_ImpactMark( qhandle_t markShader, const vec3_t origin, const vec3_t dir,
 		// otherwise save it persistantly
 		mark = CG_AllocMark();
 		mark->time = cg.time;
+		VectorMA( origin, 2.0f, axis[0], mark->cullOrigin );
+		mark->cullRadius = radius * 1.4142136f + 2.0f;	// the corners of the square
 		mark->alphaFade = alphaFade;
 		mark->markShader = markShader;
 		mark->poly.numVerts = mf->numPoints;
@@ -220,6 +245,14 @@ void CG_AddMarks( void ) {
 			continue;
 		}
 
+		// marks never move, so one sphere around the projected square covers every fragment of it
+		if ( cg_cullLocalEntities.integer ) {
+			if ( CG_CullPointAndRadius( mp->cullOrigin, mp->cullRadius )
+				|| !trap->R_InPVS( cg.refdef.vieworg, mp->cullOrigin, cg.refdef.areamask ) ) {
+				continue;
+			}
+		}
+
 		// fade out the energy bursts
 		//if ( mp->markShader == media.gfx.null ) {
 		if (0) {
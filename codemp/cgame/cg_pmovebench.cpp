@@ -0,0 +1,270 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// cg_pmovebench.cpp -- records predicted pmoves and replays them against the loaded map
+
+// The replay runs every recorded move from its recorded starting state, first with the pmove trace cache off to get
+// reference results, then timed with it off and on. Each run has to reproduce the reference bit for bit, or
+// prediction would disagree with the server.
+
+#include "cgame/cg_local.h"
+
+#include <chrono>
+
+#define MAX_PMOVEBENCH_FRAMES	1024
+#define PMOVEBENCH_IDENT		(('B'<<24)+('M'<<16)+('P'<<8)+'P')
+#define PMOVEBENCH_VERSION		1
+
+struct pmoveBenchHeader_t {
+	int		ident;
+	int		version;
+	int		frameSize;		// recordings are only good for the build that made them
+	int		numFrames;
+	char	mapname[MAX_QPATH];
+};
+
+struct pmoveBenchFrame_t {
+	pmove_t			pmove;		// pointers are set again on replay
+	int				animIndex;
+	playerState_t	before;
+	playerState_t	after;		// what prediction got, with the entities of that frame
+};
+
+static pmoveBenchFrame_t	pmoveBenchFrames[MAX_PMOVEBENCH_FRAMES];
+static playerState_t		pmoveBenchResults[MAX_PMOVEBENCH_FRAMES];
+static int					pmoveBenchNumFrames;
+static int					pmoveBenchRecordFrames;		// still to record
+static bool					pmoveBenchRecording;		// a frame has been started
+static char					pmoveBenchMapname[MAX_QPATH];
+static pmove_t				pmoveBenchPmove;
+
+static int64_t CG_PmoveBench_Now( void ) {
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// called before prediction runs a pmove
+void CG_PmoveBenchRecord( const pmove_t *pmove ) {
+	if ( !pmoveBenchRecordFrames ) {
+		return;
+	}
+
+	pmoveBenchFrame_t *frame = &pmoveBenchFrames[pmoveBenchNumFrames];
+
+	frame->pmove = *pmove;
+	frame->animIndex = cg_entities[pmove->ps->clientNum].localAnimIndex;
+	frame->before = *pmove->ps;
+	pmoveBenchRecording = true;
+}
+
+// called with the state prediction ended up with
+void CG_PmoveBenchRecorded( const playerState_t *ps ) {
+	if ( !pmoveBenchRecording ) {
+		return;
+	}
+
+	pmoveBenchFrames[pmoveBenchNumFrames++].after = *ps;
+	pmoveBenchRecording = false;
+
+	if ( !--pmoveBenchRecordFrames ) {
+		trap->Print( "pmovebench: recorded %i moves\n", pmoveBenchNumFrames );
+	}
+}
+
+static void CG_PmoveBench_Run( const pmoveBenchFrame_t *frame, playerState_t *ps ) {
+	*ps = frame->before;
+
+	pmoveBenchPmove = frame->pmove;
+	pmoveBenchPmove.ps = ps;
+	pmoveBenchPmove.ghoul2 = nullptr;
+	pmoveBenchPmove.animations = bgAllAnims[frame->animIndex].anims;
+	pmoveBenchPmove.trace = CG_Trace;
+	pmoveBenchPmove.pointcontents = CG_PointContents;
+	pmoveBenchPmove.baseEnt = (bgEntity_t *)cg_entities;
+	pmoveBenchPmove.entSize = sizeof( centity_t );
+
+	Pmove( &pmoveBenchPmove );
+}
+
+// runs every frame iterations times, returns the number of runs that did not reproduce the reference results
+static int CG_PmoveBench_Replay( int iterations, bool traceCache, int64_t *usec ) {
+	playerState_t	ps;
+	int				mismatches = 0;
+
+	bgPmoveTraceCache = traceCache;
+	*usec = 0;
+
+	for ( int i = 0; i < iterations; i++ ) {
+		for ( int f = 0; f < pmoveBenchNumFrames; f++ ) {
+			const int64_t start = CG_PmoveBench_Now();
+			CG_PmoveBench_Run( &pmoveBenchFrames[f], &ps );
+			*usec += CG_PmoveBench_Now() - start;
+
+			if ( memcmp( &ps, &pmoveBenchResults[f], sizeof( ps ) ) ) {
+				mismatches++;
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+static void CG_PmoveBench_Save( const char *name ) {
+	pmoveBenchHeader_t	header;
+	fileHandle_t		f;
+	const char			*path = va( "pmovebench/%s.pmb", name );
+
+	if ( !pmoveBenchNumFrames || pmoveBenchRecordFrames ) {
+		trap->Print( "pmovebench: nothing recorded yet\n" );
+		return;
+	}
+
+	trap->FS_Open( path, &f, FS_WRITE );
+	if ( !f ) {
+		trap->Print( "pmovebench: couldn't write %s\n", path );
+		return;
+	}
+
+	memset( &header, 0, sizeof( header ) );
+	header.ident = PMOVEBENCH_IDENT;
+	header.version = PMOVEBENCH_VERSION;
+	header.frameSize = sizeof( pmoveBenchFrame_t );
+	header.numFrames = pmoveBenchNumFrames;
+	Q_strncpyz( header.mapname, pmoveBenchMapname, sizeof( header.mapname ) );
+
+	trap->FS_Write( &header, sizeof( header ), f );
+	trap->FS_Write( pmoveBenchFrames, pmoveBenchNumFrames * sizeof( pmoveBenchFrame_t ), f );
+	trap->FS_Close( f );
+
+	trap->Print( "pmovebench: wrote %i moves to %s\n", pmoveBenchNumFrames, path );
+}
+
+static bool CG_PmoveBench_Load( const char *name ) {
+	pmoveBenchHeader_t	header;
+	fileHandle_t		f;
+	const char			*path = va( "pmovebench/%s.pmb", name );
+	const int			len = trap->FS_Open( path, &f, FS_READ );
+
+	if ( !f ) {
+		trap->Print( "pmovebench: couldn't open %s\n", path );
+		return false;
+	}
+
+	if ( len < (int)sizeof( header ) ) {
+		trap->FS_Close( f );
+		trap->Print( "pmovebench: %s is too short\n", path );
+		return false;
+	}
+
+	trap->FS_Read( &header, sizeof( header ), f );
+	if ( header.ident != PMOVEBENCH_IDENT || header.version != PMOVEBENCH_VERSION
+		|| header.frameSize != (int)sizeof( pmoveBenchFrame_t )
+		|| header.numFrames < 1 || header.numFrames > MAX_PMOVEBENCH_FRAMES
+		|| len != (int)( sizeof( header ) + header.numFrames * sizeof( pmoveBenchFrame_t ) ) )
+	{
+		trap->FS_Close( f );
+		trap->Print( "pmovebench: %s was not recorded by this build\n", path );
+		return false;
+	}
+
+	header.mapname[sizeof( header.mapname ) - 1] = '\0';
+	if ( Q_stricmp( header.mapname, cgs.mapname ) ) {
+		trap->FS_Close( f );
+		trap->Print( "pmovebench: %s was recorded on %s\n", path, header.mapname );
+		return false;
+	}
+
+	trap->FS_Read( pmoveBenchFrames, header.numFrames * sizeof( pmoveBenchFrame_t ), f );
+	trap->FS_Close( f );
+
+	pmoveBenchNumFrames = header.numFrames;
+	pmoveBenchRecordFrames = 0;
+	pmoveBenchRecording = false;
+	Q_strncpyz( pmoveBenchMapname, header.mapname, sizeof( pmoveBenchMapname ) );
+
+	return true;
+}
+
+// pmovebench record <moves>
+// pmovebench save <name>
+// pmovebench replay [name] [iterations]
+void CG_PmoveBench_f( void ) {
+	const char	*cmd = CG_Argv( 1 );
+	int			iterations = 100;
+
+	if ( !Q_stricmp( cmd, "record" ) ) {
+		pmoveBenchNumFrames = 0;
+		pmoveBenchRecording = false;
+		pmoveBenchRecordFrames = Com_Clampi( 1, MAX_PMOVEBENCH_FRAMES, atoi( CG_Argv( 2 ) ) );
+		Q_strncpyz( pmoveBenchMapname, cgs.mapname, sizeof( pmoveBenchMapname ) );
+		trap->Print( "pmovebench: recording the next %i predicted moves\n", pmoveBenchRecordFrames );
+		return;
+	}
+
+	if ( !Q_stricmp( cmd, "save" ) && trap->Cmd_Argc() > 2 ) {
+		CG_PmoveBench_Save( CG_Argv( 2 ) );
+		return;
+	}
+
+	if ( Q_stricmp( cmd, "replay" ) ) {
+		trap->Print( "usage: pmovebench record <moves> | save <name> | replay [name] [iterations]\n" );
+		return;
+	}
+
+	if ( trap->Cmd_Argc() > 2 && !CG_PmoveBench_Load( CG_Argv( 2 ) ) ) {
+		return;
+	}
+	if ( trap->Cmd_Argc() > 3 ) {
+		iterations = Com_Clampi( 1, 100000, atoi( CG_Argv( 3 ) ) );
+	}
+	if ( !pmoveBenchNumFrames || pmoveBenchRecordFrames ) {
+		trap->Print( "pmovebench: nothing recorded yet\n" );
+		return;
+	}
+	if ( Q_stricmp( pmoveBenchMapname, cgs.mapname ) ) {
+		trap->Print( "pmovebench: the moves were recorded on %s\n", pmoveBenchMapname );
+		return;
+	}
+
+	const bool	oldTraceCache = bgPmoveTraceCache;
+	int			liveMismatches = 0;
+	int64_t		uncachedUsec, cachedUsec;
+
+	// reference results without the cache
+	bgPmoveTraceCache = false;
+	for ( int f = 0; f < pmoveBenchNumFrames; f++ ) {
+		CG_PmoveBench_Run( &pmoveBenchFrames[f], &pmoveBenchResults[f] );
+		if ( memcmp( &pmoveBenchResults[f], &pmoveBenchFrames[f].after, sizeof( playerState_t ) ) ) {
+			liveMismatches++;
+		}
+	}
+
+	const int uncachedMismatches = CG_PmoveBench_Replay( iterations, false, &uncachedUsec );
+	const int cachedMismatches = CG_PmoveBench_Replay( iterations, true, &cachedUsec );
+	const int runs = iterations * pmoveBenchNumFrames;
+
+	bgPmoveTraceCache = oldTraceCache;
+
+	trap->Print( "pmovebench: %i moves x %i\n", pmoveBenchNumFrames, iterations );
+	trap->Print( "  uncached %8.3f usec/move, %i mismatches\n", (double)uncachedUsec / runs, uncachedMismatches );
+	trap->Print( "  cached   %8.3f usec/move, %i mismatches\n", (double)cachedUsec / runs, cachedMismatches );
+	// entities that have moved since the recording change the results, so this one is only exact on an empty server
+	trap->Print( "  %i of %i moves differ from the recorded prediction\n", liveMismatches, pmoveBenchNumFrames );
+}
@@ -558,6 +558,61 @@ void CG_PmoveClientPointerUpdate()
 	cg_pmove.ghoul2 = nullptr;
 }
 
+// Returns the offset of the first byte that differs between two playerStates, or -1 if they are identical
+static int CG_PlayerStateDiffers( const playerState_t *a, const playerState_t *b )
+{
+	const byte *pa = (const byte *)a;
+	const byte *pb = (const byte *)b;
+
+	if ( !memcmp( pa, pb, sizeof( *a ) ) )
+		return -1;
+
+	int offset = 0;
+	while ( pa[offset] == pb[offset] )
+		offset++;
+	return offset;
+}
+
+// Compares a new snapshot's playerState_t against the state we predicted for the same command time.
+// A full replay starts from the snapshot as it is, so everything has to match, including the fields the server
+//	doesn't send (those are zero in every snapshot). Only slopeRecalcTime can't be taken from the snapshot, a full
+//	replay carries it over from the last prediction. Returns the offset of the first byte that differs, or -1 if
+//	the saved states can be reused.
+static int CG_PredictionMismatch( const playerState_t *snap, const playerState_t *saved )
+{
+	static playerState_t	compare;
+
+	compare = *snap;
+	compare.slopeRecalcTime = saved->slopeRecalcTime;
+
+	return CG_PlayerStateDiffers( &compare, saved );
+}
+
+// cg_optimizePrediction 2: runs a command that is about to be played back through Pmove as well and reports where the
+//	result differs from the saved state
+static void CG_CheckPlayedBackState( const playerState_t *saved )
+{
+	static playerState_t	check;
+	static pmove_t			checkPmove;	// bg_pmove keeps pointing at the last one
+
+	check = *cg_pmove.ps;
+	checkPmove = cg_pmove;
+	checkPmove.ps = &check;
+	Pmove( &checkPmove );
+
+	const int offset = CG_PlayerStateDiffers( &check, saved );
+	if ( offset >= 0 ) {
+		trap->Print( "prediction playback differs from Pmove at command time %i, byte %i\n", saved->commandTime, offset );
+	}
+}
+
+// Drops all saved states so the next commands are predicted from scratch
+static void CG_ClearSavedPmoveStates( void )
+{
+	cg.stateHead = cg.stateTail = 0;
+	cg.lastPredictedCommand = 0;
+}
+
 //check if local client is on an eweb
 bool CG_UsingEWeb(void)
 {
@@ -578,11 +633,12 @@ bool CG_UsingEWeb(void)
 // Each new snapshot will usually have one or more new usercmd over the last, but we simulate all unacknowledged
 //	commands each time, not just the new ones.
 // This means that on an internet connection, quite a few pmoves may be issued each frame.
-// OPTIMIZE: don't re-simulate unless the newly arrived snapshot playerState_t differs from the predicted one.
-// Would require saving all intermediate playerState_t during prediction.
+// With cg_optimizePrediction the intermediate playerState_t are saved, so a frame without a new snapshot, or with one
+//	that agrees with what we predicted for its command time, only has to run the commands it hasn't seen yet.
 // We detect prediction errors and allow them to be decayed off over several frames to ease the jerk.
 void CG_PredictPlayerState( void ) {
 	int			cmdNum, current, i;
+	int			predictCmd, stateIndex;
 	playerState_t	oldPlayerState;
 	bool	moved;
 	usercmd_t	oldestCmd;
@@ -699,6 +755,62 @@ void CG_PredictPlayerState( void ) {
 	cg_pmove.pmove_float = pmove_float.integer;
 	cg_pmove.pmove_msec = pmove_msec.integer;
 
+	// Work out how many commands we can take from the saved states instead of running them again. Without a new
+	//	snapshot nothing has changed since last frame, and a new snapshot that agrees with what we predicted for
+	//	its command time lets us keep everything predicted after it.
+	predictCmd = current - CMD_BACKUP + 1;
+	stateIndex = 0;
+	if ( cg_optimizePrediction.integer ) {
+		if ( cg.nextFrameTeleport || cg.thisFrameTeleport ) {
+			CG_ClearSavedPmoveStates();
+		} else if ( cg.physicsTime == cg.lastServerTime ) {
+			// start from the same state as the frame that predicted the saved states
+			cg.predictedPlayerState.slopeRecalcTime = cg.savedStartSlopeRecalcTime;
+			predictCmd = cg.lastPredictedCommand + 1;
+		} else {
+			bool	found = false;
+			int		mismatch = -1;
+
+			for ( i = cg.stateHead; i != cg.stateTail; i = (i + 1) % NUM_SAVED_STATES ) {
+				if ( cg.savedPmoveStates[i].commandTime == cg.predictedPlayerState.commandTime ) {
+					mismatch = CG_PredictionMismatch( &cg.predictedPlayerState, &cg.savedPmoveStates[i] );
+					found = true;
+					break;
+				}
+			}
+
+			if ( !found || mismatch >= 0 ) {
+				if ( cg_showMiss.integer ) {
+					if ( !found ) {
+						trap->Print( "prediction replay: no saved state\n" );
+					} else {
+						trap->Print( "prediction replay: playerState differs at byte %i\n", mismatch );
+					}
+				}
+				CG_ClearSavedPmoveStates();
+			} else {
+				// the saved state is the snapshot, with the slopeRecalcTime the later saved states were predicted from
+				cg.predictedPlayerState = cg.savedPmoveStates[i];
+				cg.stateHead = (i + 1) % NUM_SAVED_STATES;
+				predictCmd = cg.lastPredictedCommand + 1;
+			}
+		}
+
+		cg.lastServerTime = cg.physicsTime;
+		cg.savedStartSlopeRecalcTime = cg.predictedPlayerState.slopeRecalcTime;
+		stateIndex = cg.stateHead;
+
+		if ( predictCmd > current - CMD_BACKUP + 1 ) {
+			cg.predictIncremental++;
+		} else {
+			cg.predictFull++;
+		}
+	} else if ( cg.lastServerTime ) {
+		// anything saved is stale once we stop keeping it up to date
+		CG_ClearSavedPmoveStates();
+		cg.lastServerTime = 0;
+	}
+
 	for ( i = 0 ; i < MAX_GENTITIES ; i++ )
 	{
 		//Written this way for optimal speed, even though it doesn't look pretty.
@@ -839,7 +951,41 @@ void CG_PredictPlayerState( void ) {
 		cg_pmove.saberSpecialMoves = cgs.saberSpecialMoves;
 		cg_pmove.saberTweaks = cgs.saberTweaks;
 
-		Pmove (&cg_pmove);
+		if ( cg_optimizePrediction.integer && cmdNum < predictCmd ) {
+			// play this one back, unless the saved states ran out or don't line up with the commands any more
+			if ( stateIndex == cg.stateTail || cg.savedPmoveStates[stateIndex].commandTime != cg_pmove.cmd.serverTime ) {
+				if ( cg_showMiss.integer ) {
+					trap->Print( "saved state miss\n" );
+				}
+				cg.stateTail = stateIndex;
+				predictCmd = cmdNum;
+			} else {
+				if ( cg_optimizePrediction.integer > 1 ) {
+					CG_CheckPlayedBackState( &cg.savedPmoveStates[stateIndex] );
+				}
+				*cg_pmove.ps = cg.savedPmoveStates[stateIndex];
+				stateIndex = (stateIndex + 1) % NUM_SAVED_STATES;
+				cg.predictPlayedBack++;
+			}
+		}
+
+		if ( !cg_optimizePrediction.integer || cmdNum >= predictCmd ) {
+			CG_PmoveBenchRecord( &cg_pmove );
+			Pmove (&cg_pmove);
+			CG_PmoveBenchRecorded( cg_pmove.ps );
+			cg.predictPmoves++;
+
+			if ( cg_optimizePrediction.integer ) {
+				cg.lastPredictedCommand = cmdNum;
+
+				// keep it for the next frames, as long as the ring has room
+				if ( (stateIndex + 1) % NUM_SAVED_STATES != cg.stateHead ) {
+					cg.savedPmoveStates[stateIndex] = *cg_pmove.ps;
+					stateIndex = (stateIndex + 1) % NUM_SAVED_STATES;
+					cg.stateTail = stateIndex;
+				}
+			}
+		}
 
 		moved = true;
 
@@ -893,3 +1039,15 @@ revertES:
 		}
 	}
 }
+
+// Prints and resets the cg_optimizePrediction counters
+void CG_PredictStats_f( void ) {
+	const int frames = cg.predictIncremental + cg.predictFull;
+
+	trap->Print( "prediction: %i frames, %i incremental (%.1f%%), %i full replays\n", frames, cg.predictIncremental,
+		frames ? cg.predictIncremental * 100.0f / frames : 0.0f, cg.predictFull );
+	trap->Print( "            %i pmoves, %i commands played back\n", cg.predictPmoves, cg.predictPlayedBack );
+
+	cg.predictIncremental = cg.predictFull = 0;
+	cg.predictPmoves = cg.predictPlayedBack = 0;
+}
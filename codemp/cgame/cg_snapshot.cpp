@@ -202,6 +202,7 @@ static void CG_SetNextSnap( snapshot_t *snap ) {
 
 		memcpy(&cent->nextState, es, sizeof(entityState_t));
 		//cent->nextState = *es;
+		cent->snapLerpValid = false;
 
 		// if this frame is a teleport, or the entity wasn't in the
 		// previous frame, don't interpolate
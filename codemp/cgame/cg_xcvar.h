@@ -58,6 +58,7 @@ XCVAR_DEF( cg_crosshairHealth,               "0",                      nullptr,
 XCVAR_DEF( cg_crosshairSize,                 "24",                     nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_crosshairX,                    "0",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_crosshairY,                    "0",                      nullptr,                 CVAR_ARCHIVE )
+XCVAR_DEF( cg_cullLocalEntities,             "1",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_currentSelectedPlayer,         "0",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_debugAnim,                     "0",                      nullptr,                 CVAR_CHEAT )
 XCVAR_DEF( cg_debugEvents,                   "0",                      nullptr,                 CVAR_CHEAT )
@@ -110,11 +111,14 @@ XCVAR_DEF( cg_instantDuck,                   "1",                      nullptr,
 XCVAR_DEF( cg_jumpSounds,                    "0",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_lagometer,                     "0",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_marks,                         "1",                      nullptr,                 CVAR_ARCHIVE )
+XCVAR_DEF( cg_maxLocalEntities,              "2048",                   nullptr,                 CVAR_ARCHIVE | CVAR_LATCH )
+XCVAR_DEF( cg_maxMarkPolys,                  "1024",                   nullptr,                 CVAR_ARCHIVE | CVAR_LATCH )
 XCVAR_DEF( cg_noPlayerAnims,                 "0",                      nullptr,                 CVAR_CHEAT )
 XCVAR_DEF( cg_noPredict,                     "0",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_noProjectileTrail,             "0",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_noTaunt,                       "0",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_oldPainSounds,                 "0",                      nullptr,                 CVAR_ARCHIVE )
+XCVAR_DEF( cg_optimizePrediction,            "1",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_predictItems,                  "1",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_renderToTextureFX,             "1",                      nullptr,                 CVAR_ARCHIVE )
 XCVAR_DEF( cg_repeaterOrb,                   "0",                      nullptr,                 CVAR_ARCHIVE )
@@ -21,6 +21,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 ===========================================================================
 */
 
+#include "client/cl_bench.h"
 #include "client/FxScheduler.h"
 
 //#define __FXCHECKER
@@ -97,7 +98,9 @@ void FX_PlayEntityEffectID( int id, vec3_t org,
 
 void FX_AddScheduledEffects( bool portal )
 {
+	CL_Bench_Start( BENCH_FX );
 	theFxScheduler.AddScheduledEffects(!!portal);
+	CL_Bench_Stop( BENCH_FX );
 }
 
 void FX_Draw2DEffects( float screenXScale, float screenYScale )
@@ -29,6 +29,51 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 extern int		drawnFx;
 
+#define FX_DEFINE_POOL( type, count ) \
+	static CFxPool<type, count> type##Pool; \
+	void *type::operator new( size_t size ) \
+	{ \
+		assert( size == sizeof( type ) ); \
+		return type##Pool.Alloc(); \
+	} \
+	void type::operator delete( void *p ) \
+	{ \
+		type##Pool.Free( p ); \
+	}
+
+FX_DEFINE_POOL( CParticle,			MAX_EFFECTS )
+FX_DEFINE_POOL( COrientedParticle,	MAX_EFFECTS / 2 )
+FX_DEFINE_POOL( CTail,				MAX_EFFECTS / 2 )
+FX_DEFINE_POOL( CLine,				512 )
+FX_DEFINE_POOL( CTrail,				512 )
+FX_DEFINE_POOL( CElectricity,		256 )
+FX_DEFINE_POOL( CCylinder,			256 )
+FX_DEFINE_POOL( CEmitter,			256 )
+FX_DEFINE_POOL( CLight,				256 )
+FX_DEFINE_POOL( CPoly,				256 )
+FX_DEFINE_POOL( CBezier,			256 )
+FX_DEFINE_POOL( CFlash,				64 )
+
+#define FX_POOL_STATS( type ) \
+	theFxHelper.Print( "%-18s %4i/%4i high: %4i overflows: %i\n", #type, \
+		type##Pool.GetInUse(), type##Pool.GetCapacity(), type##Pool.GetHighWatermark(), type##Pool.GetOverflows() )
+
+void FX_PoolStats( void )
+{
+	FX_POOL_STATS( CParticle );
+	FX_POOL_STATS( COrientedParticle );
+	FX_POOL_STATS( CTail );
+	FX_POOL_STATS( CLine );
+	FX_POOL_STATS( CTrail );
+	FX_POOL_STATS( CElectricity );
+	FX_POOL_STATS( CCylinder );
+	FX_POOL_STATS( CEmitter );
+	FX_POOL_STATS( CLight );
+	FX_POOL_STATS( CPoly );
+	FX_POOL_STATS( CBezier );
+	FX_POOL_STATS( CFlash );
+}
+
 // Base Effect Class
 CEffect::CEffect(void) :
 	mFlags(0),
@@ -197,6 +242,38 @@ bool CParticle::Update(void)
 	return true;
 }
 
+// Same as Update for particles that pass CanUpdateAsync, but leaves the Draw to the caller so it can
+//	run on a job thread. Also used by oriented particles, whose non relative update only differs in Cull.
+bool CParticle::UpdateAsync( bool &visible )
+{
+	visible = false;
+
+	// Game pausing can cause dumb time things to happen, so kill the effect in this instance
+	if ( mTimeStart > theFxHelper.mTime )
+	{
+		return false;
+	}
+
+	if (( mTimeStart < theFxHelper.mTime ) && UpdateOrigin() == false )
+	{
+		// we are marked for death
+		return false;
+	}
+
+	if ( !Cull() )
+	{
+		// Only update these if the thing is visible.
+		UpdateSize();
+		UpdateRGB();
+		UpdateAlpha();
+		UpdateRotation();
+
+		visible = true;
+	}
+
+	return true;
+}
+
 // Update Origin
 bool CParticle::UpdateOrigin(void)
 {
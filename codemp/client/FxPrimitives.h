@@ -115,6 +115,10 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 											//	this flag needs to be set
 #define FX_DEATH_RUNS_FX	0x20000000		// Normal death triggers effect, but not kill_on_impact
 #define FX_KILL_ON_IMPACT	0x40000000		// works just like it says, but only when physics are on.
+
+// particles with any of these set reach the RNG, the collision world or the scheduler while updating,
+//	so they are left out of the threaded pre-pass in FX_Add
+#define FX_ASYNC_UNSAFE		(FX_RELATIVE|FX_EXPENSIVE_PHYSICS|FX_PLAYER_VIEW|FX_SIZE_RAND|FX_RGB_RAND|FX_ALPHA_RAND)
 #define FX_IMPACT_RUNS_FX	0x80000000		// an effect can call another effect when it hits something.
 
 // Lightning flags, duplicates of existing flags, but lightning doesn't use those flags in that context...and nothing will ever use these in this context..so we are safe.
@@ -140,6 +144,86 @@ enum EMatImpactEffect_e
 // CLASS
 // ======================================================================
 
+// Fixed storage for one primitive type, so spawning an effect never goes through the heap and
+//	primitives of the same type stay packed together. If a pool runs dry we fall back to the heap.
+template<class T, int N>
+class CFxPool
+{
+	union SSlot
+	{
+		SSlot	*mNextFree;
+		alignas(T) unsigned char mStorage[sizeof(T)];
+	};
+
+	SSlot	mSlots[N];
+	SSlot	*mFreeList;
+	int		mInUse;
+	int		mHighWatermark;
+	int		mOverflows;
+
+public:
+
+	CFxPool() :
+		mInUse(0),
+		mHighWatermark(0),
+		mOverflows(0)
+	{
+		for ( int i = 0; i < N - 1; i++ )
+		{
+			mSlots[i].mNextFree = &mSlots[i + 1];
+		}
+		mSlots[N - 1].mNextFree = nullptr;
+		mFreeList = &mSlots[0];
+	}
+
+	void *Alloc( void )
+	{
+		if ( !mFreeList )
+		{
+			mOverflows++;
+			return ::operator new( sizeof( T ) );
+		}
+
+		SSlot *slot = mFreeList;
+		mFreeList = slot->mNextFree;
+
+		if ( ++mInUse > mHighWatermark )
+		{
+			mHighWatermark = mInUse;
+		}
+		return slot->mStorage;
+	}
+
+	void Free( void *p )
+	{
+		SSlot *slot = (SSlot *)p;
+
+		if ( slot < &mSlots[0] || slot >= &mSlots[N] )
+		{
+			::operator delete( p );
+			return;
+		}
+
+		slot->mNextFree = mFreeList;
+		mFreeList = slot;
+		mInUse--;
+	}
+
+	inline int GetInUse( void ) const			{ return mInUse;			}
+	inline int GetCapacity( void ) const		{ return N;					}
+	inline int GetHighWatermark( void ) const	{ return mHighWatermark;	}
+	inline int GetOverflows( void ) const		{ return mOverflows;		}
+};
+
+// Routes new/delete of a primitive class to its pool, see FX_DEFINE_POOL in FxPrimitives.cpp
+#define FX_DECLARE_POOL \
+	public: \
+	static void *operator new( size_t size ); \
+	static void operator delete( void *p ); \
+	private:
+
+void FX_PoolStats( void );
+
 class CEffect
 {
 protected:
@@ -176,6 +260,11 @@ public:
 	virtual bool Update()	{ return true;		}
 	virtual	void Draw(void) {}
 
+	// Effects that can step without touching shared state may be updated off the main thread,
+	//	Draw is still called from the main thread afterwards when visible comes back true
+	virtual bool CanUpdateAsync(void) const	{ return false;	}
+	virtual bool UpdateAsync( bool &visible )	{ visible = false; return true;	}
+
 	inline	miniRefEntity_t	&GetRefEnt(void) { return mRefEnt; }
 
 	inline void		SetNext(CEffect *Next) { mNext = Next; }
@@ -205,6 +294,8 @@ public:
 // For now it exists only for allowing an easy way to get the saber slash trails rendered.
 class CTrail : public CEffect
 {
+	FX_DECLARE_POOL
+
 // This is such a specific case thing, just grant public access to the goods.
 protected:
 
@@ -243,6 +334,8 @@ public:
 
 class CLight : public CEffect
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	float		mSizeStart;
@@ -292,6 +385,8 @@ public:
 
 class CParticle : public CEffect
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	vec3_t		mOrgOffset;
@@ -346,6 +441,9 @@ public:
 	virtual bool Cull(void);
 	virtual void Draw(void);
 
+	virtual bool CanUpdateAsync(void) const	{ return !( mFlags & FX_ASYNC_UNSAFE );	}
+	virtual bool UpdateAsync( bool &visible );
+
 	inline void SetShader( qhandle_t sh )	{ mRefEnt.customShader = sh;		}
 
 	inline void SetOrgOffset( const vec3_t o )	{ if(o){VectorCopy(o,mOrgOffset);}else{VectorClear(mOrgOffset);}}
@@ -371,6 +469,8 @@ public:
 
 class CFlash : public CParticle
 {
+	FX_DECLARE_POOL
+
 public:
 
 	CFlash():
@@ -382,6 +482,7 @@ public:
 	virtual ~CFlash() {}
 
 	virtual bool Update();
+	virtual bool CanUpdateAsync(void) const	{ return false;	}
 	virtual void Draw(void);
 	virtual bool Cull(void) { return false; }
 
@@ -396,6 +497,8 @@ protected:
 
 class CLine : public CParticle
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	vec3_t	mOrigin2;
@@ -409,12 +512,15 @@ public:
 	virtual void Die() {}
 
 	virtual bool Update();
+	virtual bool CanUpdateAsync(void) const	{ return false;	}
 
 	inline void SetOrigin2( vec3_t org2 )	{ VectorCopy( org2, mOrigin2 ); }
 };
 
 class CBezier : public CLine
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	vec3_t	mControl1;
@@ -443,6 +549,8 @@ public:
 
 class CElectricity : public CLine
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	float	mChaos;
@@ -465,6 +573,8 @@ public:
 // Oriented quad
 class COrientedParticle : public CParticle
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	vec3_t	mNormal;
@@ -483,6 +593,8 @@ public:
 
 class CTail : public CParticle
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	vec3_t	mOldOrigin;
@@ -503,6 +615,7 @@ public:
 	virtual ~CTail() {}
 
 	virtual bool Update();
+	virtual bool CanUpdateAsync(void) const	{ return false;	}
 
 	inline void SetLengthStart( float len )	{ mLengthStart = len;	}
 	inline void SetLengthEnd( float len )	{ mLengthEnd = len;	}
@@ -511,6 +624,8 @@ public:
 
 class CCylinder : public CTail
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	float		mSize2Start;
@@ -542,6 +657,8 @@ public:
 //	current alpha, rgb, etc..
 class CEmitter : public CParticle
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	vec3_t		mOldOrigin;		// we use these to do some nice
@@ -567,6 +684,7 @@ public:
 
 	virtual bool Cull(void) {return false;}
 	virtual bool Update();
+	virtual bool CanUpdateAsync(void) const	{ return false;	}
 
 	inline void SetModel( qhandle_t model )	{ mRefEnt.hModel = model;	}
 	inline void SetAngles( vec3_t ang )		{ if(ang){VectorCopy(ang,mAngles);}else{VectorClear(mAngles);}				}
@@ -581,6 +699,8 @@ public:
 
 class CPoly : public CParticle
 {
+	FX_DECLARE_POOL
+
 protected:
 
 	int		mCount;
@@ -599,6 +719,7 @@ public:
 	virtual ~CPoly() {}
 
 	virtual bool Update();
+	virtual bool CanUpdateAsync(void) const	{ return false;	}
 	virtual bool Cull(void);
 	virtual void Draw(void);
 
@@ -31,7 +31,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/q_math.h"
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
+#include <list>
 #include <string>
 
 // The choosen one
@@ -53,6 +55,7 @@ CFxScheduler::CFxScheduler()
 	mNextFree2DEffect = 0;
 	memset( &mEffectTemplates, 0, sizeof( mEffectTemplates ));
 	memset( &mLoopedEffectArray, 0, sizeof( mLoopedEffectArray ));
+	mNextLoopedTime = INT_MAX;
 }
 
 int CFxScheduler::ScheduleLoopedEffect( int id, int boltInfo, CGhoul2Info_v *ghoul2, bool isPortal, int iLoopTime, bool isRelative  )
@@ -100,6 +103,7 @@ int CFxScheduler::ScheduleLoopedEffect( int id, int boltInfo, CGhoul2Info_v *gho
 	mLoopedEffectArray[i].mIsRelative = isRelative;
 	mLoopedEffectArray[i].mNextTime = theFxHelper.mTime + mEffectTemplates[id].mRepeatDelay ;
 	mLoopedEffectArray[i].mLoopStopTime = (iLoopTime==1) ? 0 : theFxHelper.mTime + iLoopTime;
+	mNextLoopedTime = Q_min( mNextLoopedTime, mLoopedEffectArray[i].mNextTime );
 	return i;
 }
 
@@ -139,6 +143,12 @@ void CFxScheduler::AddLoopedEffects()
 {
 	int i;
 
+	if ( theFxHelper.mTime <= mNextLoopedTime )
+	{	// nothing is due yet
+		return;
+	}
+
+	mNextLoopedTime = INT_MAX;
 	for (i=0;i<MAX_LOOPED_FX;i++)
 	{
 		if (mLoopedEffectArray[i].mId && mLoopedEffectArray[i].mNextTime < theFxHelper.mTime )
@@ -157,6 +167,11 @@ void CFxScheduler::AddLoopedEffects()
 				memset( &mLoopedEffectArray[i], 0, sizeof(mLoopedEffectArray[i]) );
 			}
 		}
+
+		if ( mLoopedEffectArray[i].mId )
+		{
+			mNextLoopedTime = Q_min( mNextLoopedTime, mLoopedEffectArray[i].mNextTime );
+		}
 	}
 
 }
@@ -184,20 +199,15 @@ SEffectTemplate &SEffectTemplate::operator=(const SEffectTemplate &that)
 void CFxScheduler::Clean(bool bRemoveTemplates /*= true*/, int idToPreserve /*= 0*/)
 {
 	int								i, j;
-	TScheduledEffect::iterator		itr, next;
 
 	// Ditch any scheduled effects
-	itr = mFxSchedule.begin();
-
-	while ( itr != mFxSchedule.end() )
+	for ( i = 0; i < 2; i++ )
 	{
-		next = itr;
-		++next;
-
-		mScheduledEffectsPool.Free (*itr);
-		mFxSchedule.erase(itr);
-
-		itr = next;
+		for ( SScheduledEffect *effect : mFxSchedule[i] )
+		{
+			mScheduledEffectsPool.Free( effect );
+		}
+		mFxSchedule[i].clear();
 	}
 
 	if (bRemoveTemplates)
@@ -874,7 +884,10 @@ void CFxScheduler::PlayEffect( int id, vec3_t origin, matrix3_t axis, const int
 					sfx->mStartTime++;
 				}
 
-				mFxSchedule.push_front( sfx );
+				TScheduledEffect &schedule = mFxSchedule[sfx->mPortalEffect];
+
+				schedule.push_back( sfx );
+				std::push_heap( schedule.begin(), schedule.end(), SScheduledEffectLater() );
 			}
 		}
 	}
@@ -918,7 +931,7 @@ bool gEffectsInPortal = false; //this is just because I don't want to have to ad
 // If it should it handles converting the template effect into a real one.
 void CFxScheduler::AddScheduledEffects( bool portal )
 {
-	TScheduledEffect::iterator	itr, next;
+	TScheduledEffect			&schedule = mFxSchedule[portal];
 	vec3_t						origin;
 	matrix3_t					axis;
 	int							oldEntNum = -1, oldBoltIndex = -1, oldModelNum = -1;
@@ -933,72 +946,72 @@ void CFxScheduler::AddScheduledEffects( bool portal )
 		AddLoopedEffects();
 	}
 
-	for ( itr = mFxSchedule.begin(); itr != mFxSchedule.end(); /* do nothing */ )
+	// Pull everything that is due off the heap first, anything the created effects schedule waits for the next frame
+	mDueEffects.clear();
+	while ( !schedule.empty() && schedule.front()->mStartTime <= theFxHelper.mTime )
 	{
-		SScheduledEffect *effect = *itr;
+		std::pop_heap( schedule.begin(), schedule.end(), SScheduledEffectLater() );
+		mDueEffects.push_back( schedule.back() );
+		schedule.pop_back();
+	}
 
-		if (portal == effect->mPortalEffect && effect->mStartTime <= theFxHelper.mTime )
-		{ //only render portal fx on the skyportal pass and vice versa
-			if (effect->mBoltNum == -1)
-			{// ok, are we spawning a bolt on effect or a normal one?
-				if ( effect->mEntNum != ENTITYNUM_NONE )
-				{
-					// Find out where the entity currently is
-					TCGVectorData	*data = (TCGVectorData*)cl.mSharedMemory;
+	for ( SScheduledEffect *effect : mDueEffects )
+	{
+		if (effect->mBoltNum == -1)
+		{// ok, are we spawning a bolt on effect or a normal one?
+			if ( effect->mEntNum != ENTITYNUM_NONE )
+			{
+				// Find out where the entity currently is
+				TCGVectorData	*data = (TCGVectorData*)cl.mSharedMemory;
+
+				data->mEntityNum = effect->mEntNum;
+				CGVM_GetLerpOrigin();
+				CreateEffect( effect->mpTemplate,
+							data->mPoint, effect->mAxis,
+							theFxHelper.mTime - effect->mStartTime );
+			}
+			else
+			{
+				CreateEffect( effect->mpTemplate,
+							effect->mOrigin, effect->mAxis,
+							theFxHelper.mTime - effect->mStartTime );
+			}
+		}
+		else
+		{	//bolted on effect
+			// do we need to go and re-get the bolt matrix again? Since it takes time lets try to do it only once
+			if ((effect->mModelNum != oldModelNum) ||
+				(effect->mEntNum != oldEntNum) ||
+				(effect->mBoltNum != oldBoltIndex))
+			{
+				oldModelNum = effect->mModelNum;
+				oldEntNum = effect->mEntNum;
+				oldBoltIndex = effect->mBoltNum;
 
-					data->mEntityNum = effect->mEntNum;
-					CGVM_GetLerpOrigin();
+				doesBoltExist = theFxHelper.GetOriginAxisFromBolt(effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum, origin, axis);
+			}
+
+			// only do this if we found the bolt
+			if (doesBoltExist)
+			{
+				if (effect->mIsRelative )
+				{
 					CreateEffect( effect->mpTemplate,
-								data->mPoint, effect->mAxis,
-								theFxHelper.mTime - effect->mStartTime );
+								origin, axis, 0, -1,
+								effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum );
 				}
 				else
 				{
 					CreateEffect( effect->mpTemplate,
-								effect->mOrigin, effect->mAxis,
+								origin, axis,
 								theFxHelper.mTime - effect->mStartTime );
 				}
 			}
-			else
-			{	//bolted on effect
-				// do we need to go and re-get the bolt matrix again? Since it takes time lets try to do it only once
-				if ((effect->mModelNum != oldModelNum) ||
-					(effect->mEntNum != oldEntNum) ||
-					(effect->mBoltNum != oldBoltIndex))
-				{
-					oldModelNum = effect->mModelNum;
-					oldEntNum = effect->mEntNum;
-					oldBoltIndex = effect->mBoltNum;
-
-					doesBoltExist = theFxHelper.GetOriginAxisFromBolt(effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum, origin, axis);
-				}
-
-				// only do this if we found the bolt
-				if (doesBoltExist)
-				{
-					if (effect->mIsRelative )
-					{
-						CreateEffect( effect->mpTemplate,
-									origin, axis, 0, -1,
-									effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum );
-					}
-					else
-					{
-						CreateEffect( effect->mpTemplate,
-									origin, axis,
-									theFxHelper.mTime - effect->mStartTime );
-					}
-				}
-			}
-
-			mScheduledEffectsPool.Free (effect);
-			itr = mFxSchedule.erase(itr);
-		}
-		else
-		{
-			++itr;
 		}
+
+		mScheduledEffectsPool.Free (effect);
 	}
+	mDueEffects.clear();
 
 	// Add all active effects into the scene
 	FX_Add( !!portal );
@@ -1532,3 +1545,93 @@ void CFxScheduler::CreateEffect( CPrimitiveTemplate *fx, SScheduledEffect *sched
 
 	PlayEffect( fx->mPlayFxHandles.GetHandle(), scheduledFx->mOrigin, scheduledFx->mAxis, boltInfo );
 }
+
+/*
+FX_SchedulerBench_f
+
+Compares the old list walk against the start time heap under a synthetic steady load: every effect gets a random
+delay, and each effect that comes due is replaced by a new one, so the number of scheduled effects stays constant.
+*/
+void FX_SchedulerBench_f( void )
+{
+	struct SBenchEffect
+	{
+		int	mStartTime;
+	};
+	struct SBenchEffectLater
+	{
+		bool operator()( const SBenchEffect *a, const SBenchEffect *b ) const { return a->mStartTime > b->mStartTime; }
+	};
+
+	const int	numEffects = (Cmd_Argc() > 1) ? Q_max( 1, atoi( Cmd_Argv( 1 ) ) ) : 5000;
+	const int	numFrames = 2000;
+	const int	frameMsec = 8;
+	const int	maxDelay = 2000;
+	std::vector<SBenchEffect>	effects( numEffects );
+	int			seed, time, start, i;
+	int			listMsec, heapMsec, listVisits = 0, heapVisits = 0, listDue = 0, heapDue = 0;
+
+	// list: walk everything every frame, like the old scheduler
+	std::list<SBenchEffect *> list;
+
+	seed = 0x5eed;
+	for ( i = 0; i < numEffects; i++ )
+	{
+		effects[i].mStartTime = Q_rand( &seed ) % maxDelay;
+		list.push_front( &effects[i] );
+	}
+
+	start = Sys_Milliseconds();
+	for ( time = 0; time < numFrames * frameMsec; time += frameMsec )
+	{
+		for ( auto itr = list.begin(); itr != list.end(); /* do nothing */ )
+		{
+			SBenchEffect *effect = *itr;
+
+			listVisits++;
+			if ( effect->mStartTime <= time )
+			{
+				listDue++;
+				itr = list.erase( itr );
+				effect->mStartTime = time + 1 + Q_rand( &seed ) % maxDelay;
+				list.push_front( effect );
+			}
+			else
+			{
+				++itr;
+			}
+		}
+	}
+	listMsec = Sys_Milliseconds() - start;
+
+	// heap: only pop what is due
+	std::vector<SBenchEffect *> heap;
+
+	seed = 0x5eed;
+	for ( i = 0; i < numEffects; i++ )
+	{
+		effects[i].mStartTime = Q_rand( &seed ) % maxDelay;
+		heap.push_back( &effects[i] );
+		std::push_heap( heap.begin(), heap.end(), SBenchEffectLater() );
+	}
+
+	start = Sys_Milliseconds();
+	for ( time = 0; time < numFrames * frameMsec; time += frameMsec )
+	{
+		while ( heap.front()->mStartTime <= time )
+		{
+			std::pop_heap( heap.begin(), heap.end(), SBenchEffectLater() );
+			SBenchEffect *effect = heap.back();
+
+			heapVisits++;
+			heapDue++;
+			effect->mStartTime = time + 1 + Q_rand( &seed ) % maxDelay;
+			std::push_heap( heap.begin(), heap.end(), SBenchEffectLater() );
+		}
+	}
+	heapMsec = Sys_Milliseconds() - start;
+
+	Com_Printf( "fx scheduler bench: %i effects over %i frames\n", numEffects, numFrames );
+	Com_Printf( "  list: %5i msec, %10i visits, %8i due\n", listMsec, listVisits, listDue );
+	Com_Printf( "  heap: %5i msec, %10i visits, %8i due\n", heapMsec, heapVisits, heapDue );
+}
@@ -31,7 +31,6 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/GenericParser2.h"
 
 #include <algorithm>
-#include <list>
 #include <map>
 #include <string>
 #include <vector>
@@ -357,13 +356,14 @@ class PoolAllocator
 public:
 	PoolAllocator()
 		: pool (new T[N])
-		, freeAndAllocated (new int[N])
+		, freeIndexes (new int[N])
 		, numFree (N)
 		, highWatermark (0)
 	{
+		// hand out the low slots first
 		for ( int i = 0; i < N; i++ )
 		{
-			freeAndAllocated[i] = i;
+			freeIndexes[i] = N - 1 - i;
 		}
 	}
 
@@ -374,10 +374,7 @@ public:
 			return nullptr;
 		}
 
-		T *ptr = new (&pool[freeAndAllocated[0]]) T;
-
-		std::rotate (freeAndAllocated, freeAndAllocated + 1, freeAndAllocated + N);
-		numFree--;
+		T *ptr = new (&pool[freeIndexes[--numFree]]) T;
 
 		highWatermark = Q_max(highWatermark, N - numFree);
 
@@ -386,14 +383,17 @@ public:
 
 	void TransferTo ( PoolAllocator<T, N>& allocator )
 	{
-		allocator.freeAndAllocated = freeAndAllocated;
+		delete [] allocator.freeIndexes;
+		delete [] allocator.pool;
+
+		allocator.freeIndexes = freeIndexes;
 		allocator.highWatermark = highWatermark;
 		allocator.numFree = numFree;
 		allocator.pool = pool;
 
 		highWatermark = 0;
 		numFree = N;
-		freeAndAllocated = nullptr;
+		freeIndexes = nullptr;
 		pool = nullptr;
 	}
 
@@ -404,37 +404,18 @@ public:
 
 	void Free ( T *ptr )
 	{
-		for ( int i = numFree; i < N; i++ )
-		{
-			T *p = &pool[freeAndAllocated[i]];
-
-			if ( p == ptr )
-			{
-				if ( i > numFree )
-				{
-					std::rotate (freeAndAllocated + numFree, freeAndAllocated + i, freeAndAllocated + i + 1);
-				}
-
-				p->~T();
-				numFree++;
+		assert( OwnsPtr( ptr ) );
+		assert( numFree < N );
 
-				break;
-			}
-		}
+		ptr->~T();
+		freeIndexes[numFree++] = (int)(ptr - pool);
 	}
 
 	int GetHighWatermark() const { return highWatermark; }
 
 	~PoolAllocator()
 	{
-		for ( int i = numFree; i < N; i++ )
-		{
-			T *p = &pool[freeAndAllocated[i]];
-
-			p->~T();
-		}
-
-		delete [] freeAndAllocated;
+		delete [] freeIndexes;
 		delete [] pool;
 	}
 
@@ -444,9 +425,8 @@ private:
 
 	T *pool;
 
-	// The first 'numFree' elements are the indexes of the free slots.
-	// The remaining elements are the indexes of the allocated slots.
-	int *freeAndAllocated;
+	// The first 'numFree' elements are the indexes of the free slots, used as a stack.
+	int *freeIndexes;
 	int numFree;
 
 	int highWatermark;
@@ -562,6 +542,7 @@ private:
 	};
 
 	SLoopedEffect	mLoopedEffectArray[MAX_LOOPED_FX];
+	int				mNextLoopedTime;	// earliest mNextTime of any looped effect, so idle frames can skip the scan
 
 	int		ScheduleLoopedEffect( int id, int boltInfo, CGhoul2Info_v *ghoul2, bool isPortal, int iLoopTime, bool isRelative );
 	void	AddLoopedEffects( );
@@ -589,7 +570,12 @@ private:
 	// this makes looking up the index based on the string name much easier
 	typedef std::map<std::string, int>				TEffectID;
 
-	typedef std::list<SScheduledEffect*>			TScheduledEffect;
+	// Scheduled effects are kept in a min-heap on start time, so a frame only touches the effects that are due
+	struct SScheduledEffectLater
+	{
+		bool operator()( const SScheduledEffect *a, const SScheduledEffect *b ) const { return a->mStartTime > b->mStartTime; }
+	};
+	typedef std::vector<SScheduledEffect*>			TScheduledEffect;
 
 	// Effects
 	SEffectTemplate		mEffectTemplates[FX_MAX_EFFECTS];
@@ -599,8 +585,9 @@ private:
 	CScheduled2DEffect	m2DEffects[FX_MAX_2DEFFECTS];
 	int					mNextFree2DEffect;
 
-	// List of scheduled effects that will need to be created at the correct time.
-	TScheduledEffect	mFxSchedule;
+	// Heaps of scheduled effects that will need to be created at the correct time, one for the normal view and one for the sky portal.
+	TScheduledEffect	mFxSchedule[2];
+	TScheduledEffect	mDueEffects;
 
 	PagedPoolAllocator<SScheduledEffect, 1024> mScheduledEffectsPool;
 
@@ -639,7 +626,7 @@ public:
 	void	Draw2DEffects(float screenXScale, float screenYScale);
 
 	int		GetHighWatermark() const { return mScheduledEffectsPool.GetHighWatermark(); }
-	int		NumScheduledFx()	{ return (int)mFxSchedule.size();	}
+	int		NumScheduledFx()	{ return (int)(mFxSchedule[0].size() + mFxSchedule[1].size());	}
 	void	Clean(bool bRemoveTemplates = true, int idToPreserve = 0);	// clean out the system
 
 	// FX Override functions
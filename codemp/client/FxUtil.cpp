@@ -24,41 +24,63 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "client/cl_local.h"
 #include "client/FxScheduler.h"
 #include "qcommon/com_cvars.h"
+#include "qcommon/jobs.h"
 
 vec3_t	WHITE = {1.0f, 1.0f, 1.0f};
 
-struct SEffectList
-{
-	CEffect *mEffect;
-	int		mKillTime;
-	bool	mPortal;
-};
-
 #define PI		3.14159f
 
-SEffectList		effectList[MAX_EFFECTS];
-SEffectList		*nextValidEffect;
+// Active effects live in parallel arrays indexed by slot, so the per frame expiry test in FX_Add only
+//	touches the kill times. Free slots are kept on a stack so spawning an effect never has to search.
+static CEffect	*effectPtrs[MAX_EFFECTS];
+static int		effectKillTimes[MAX_EFFECTS];
+static bool		effectPortals[MAX_EFFECTS];
+static int		freeEffectSlots[MAX_EFFECTS];
+static int		numFreeEffectSlots;
+
+// Results of the threaded pre-pass in FX_Add, indexed by slot. Zero means the effect was not
+//	pre-updated and still has to go through the normal Update call.
+#define FX_ASYNC_MIN_EFFECTS	128		// below this the job dispatch costs more than it saves
+#define FX_ASYNC_BATCH			64
+#define FX_ASYNC_DEAD			1
+#define FX_ASYNC_HIDDEN			2
+#define FX_ASYNC_VISIBLE		3
+
+static byte		effectAsyncResults[MAX_EFFECTS];
+static int		asyncSlots[MAX_EFFECTS];
+static int		numAsyncSlots;
 SFxHelper		theFxHelper;
 
 int				activeFx = 0;
 int				drawnFx;
 bool		fxInitialized = false;
 
+static void FX_ResetSlots( void )
+{
+	// pushed in reverse so the low slots get handed out first
+	for ( int i = 0; i < MAX_EFFECTS; i++ )
+	{
+		freeEffectSlots[i] = MAX_EFFECTS - 1 - i;
+	}
+	numFreeEffectSlots = MAX_EFFECTS;
+}
+
 // Frees all FX
 // ditches all active effects;
 bool FX_Free( bool templates )
 {
 	for ( int i = 0; i < MAX_EFFECTS; i++ )
 	{
-		if ( effectList[i].mEffect )
+		if ( effectPtrs[i] )
 		{
-			delete effectList[i].mEffect;
+			delete effectPtrs[i];
 		}
 
-		effectList[i].mEffect = 0;
+		effectPtrs[i] = 0;
 	}
 
 	activeFx = 0;
+	FX_ResetSlots();
 
 	theFxScheduler.Clean( templates );
 	return true;
@@ -70,15 +92,16 @@ void FX_Stop( void )
 {
 	for ( int i = 0; i < MAX_EFFECTS; i++ )
 	{
-		if ( effectList[i].mEffect )
+		if ( effectPtrs[i] )
 		{
-			delete effectList[i].mEffect;
+			delete effectPtrs[i];
 		}
 
-		effectList[i].mEffect = 0;
+		effectPtrs[i] = 0;
 	}
 
 	activeFx = 0;
+	FX_ResetSlots();
 
 	theFxScheduler.Clean(false);
 }
@@ -94,10 +117,10 @@ int	FX_Init( refdef_t* refdef )
 
 		for ( int i = 0; i < MAX_EFFECTS; i++ )
 		{
-			effectList[i].mEffect = 0;
+			effectPtrs[i] = 0;
 		}
+		FX_ResetSlots();
 	}
-	nextValidEffect = &effectList[0];
 
 	theFxHelper.ReInit(refdef);
 
@@ -110,94 +133,163 @@ void FX_SetRefDef(refdef_t *refdef)
 	theFxHelper.refdef = refdef;
 }
 
-static void FX_FreeMember( SEffectList *obj )
+static void FX_FreeMember( int slot, bool runDeath = true )
 {
-	obj->mEffect->Die();
-	delete obj->mEffect;
-	obj->mEffect = 0;
+	if ( runDeath )
+	{
+		effectPtrs[slot]->Die();
+	}
+	delete effectPtrs[slot];
+	effectPtrs[slot] = 0;
+	effectAsyncResults[slot] = 0;
 
 	// May as well mark this to be used next
-	nextValidEffect = obj;
+	freeEffectSlots[numFreeEffectSlots++] = slot;
 
 	activeFx--;
 }
 
 // Finds an unused effect slot
-// Note - in the editor, this function may return nullptr, indicating that all effects are being stopped.
-static SEffectList *FX_GetValidEffect()
+static int FX_GetValidEffect()
 {
-	if ( nextValidEffect->mEffect == 0 )
+	if ( numFreeEffectSlots > 0 )
 	{
-		return nextValidEffect;
+		return freeEffectSlots[--numFreeEffectSlots];
 	}
 
-	int			i;
-	SEffectList	*ef;
+	// report the error.
+#ifndef FINAL_BUILD
+	theFxHelper.Print( "FX system out of effects\n" );
+#endif
+
+	// Hmmm.. just trashing the first effect in the list is a poor approach. Its death effect would come straight
+	//	back in here for a slot while the list is still full, so it goes without one
+	FX_FreeMember( 0, false );
+
+	return freeEffectSlots[--numFreeEffectSlots];
+}
 
-	// Blah..plow through the list till we find something that is currently untainted
-	for ( i = 0, ef = effectList; i < MAX_EFFECTS; i++, ef++ )
+static void FX_UpdateAsyncJob( void *data, int start, int end )
+{
+	for ( int i = start; i < end; i++ )
 	{
-		if ( ef->mEffect == 0 )
+		const int	slot = asyncSlots[i];
+		bool		visible;
+
+		if ( effectPtrs[slot]->UpdateAsync( visible ) == false )
 		{
-			return ef;
+			effectAsyncResults[slot] = FX_ASYNC_DEAD;
+		}
+		else
+		{
+			effectAsyncResults[slot] = visible ? FX_ASYNC_VISIBLE : FX_ASYNC_HIDDEN;
 		}
 	}
+}
 
-	// report the error.
-#ifndef FINAL_BUILD
-	theFxHelper.Print( "FX system out of effects\n" );
-#endif
+// Steps every live effect that opted in to CanUpdateAsync across the job threads. Only the effect's
+//	own state is written, so the results do not depend on how the work was split up.
+static void FX_UpdateAsync( bool portal )
+{
+	int numFx = activeFx;
+
+	numAsyncSlots = 0;
+	for ( int i = 0; i < MAX_EFFECTS && numFx; i++ )
+	{
+		if ( effectPtrs[i] != 0 )
+		{
+			--numFx;
+			if ( portal == effectPortals[i] && theFxHelper.mTime <= effectKillTimes[i] && effectPtrs[i]->CanUpdateAsync() )
+			{
+				asyncSlots[numAsyncSlots++] = i;
+			}
+		}
+	}
 
-	// Hmmm.. just trashing the first effect in the list is a poor approach
-	FX_FreeMember( &effectList[0] );
+	if ( numAsyncSlots < FX_ASYNC_MIN_EFFECTS )
+	{
+		// not worth it, let the main loop handle them
+		numAsyncSlots = 0;
+		return;
+	}
 
-	// Recursive call
-	return nextValidEffect;
+	Job_ParallelFor( FX_UpdateAsyncJob, nullptr, numAsyncSlots, FX_ASYNC_BATCH );
 }
 
 // Adds all fx to the view
 void FX_Add( bool portal )
 {
 	int			i;
-	SEffectList	*ef;
 
 	drawnFx = 0;
 
+	if ( fx_jobs->integer && Job_NumWorkers() )
+	{
+		FX_UpdateAsync( portal );
+	}
+
+	// Everything that has to happen in order (death and impact effects, scene submission) stays here,
+	//	walking the slots in the same order whether or not the pre-pass ran
 	int numFx = activeFx;	//but stop when there can't be any more left!
-	for ( i = 0, ef = effectList; i < MAX_EFFECTS && numFx; i++, ef++ )
+	for ( i = 0; i < MAX_EFFECTS && numFx; i++ )
 	{
-		if ( ef->mEffect != 0)
+		if ( effectPtrs[i] != 0)
 		{
 			--numFx;
-			if (portal != ef->mPortal)
+			if (portal != effectPortals[i])
 			{
 				continue;	//this one does not render in this scene
 			}
 			// Effect is active
-			if ( theFxHelper.mTime > ef->mKillTime )
+			if ( theFxHelper.mTime > effectKillTimes[i] )
 			{
 				// Clean up old effects, calling any death effects as needed
 				// this flag just has to be cleared otherwise death effects might not happen correctly
-				ef->mEffect->ClearFlags( FX_KILL_ON_IMPACT );
-				FX_FreeMember( ef );
+				effectPtrs[i]->ClearFlags( FX_KILL_ON_IMPACT );
+				FX_FreeMember( i );
+			}
+			else if ( effectAsyncResults[i] )
+			{
+				const byte result = effectAsyncResults[i];
+
+				effectAsyncResults[i] = 0;
+				if ( result == FX_ASYNC_DEAD )
+				{
+					FX_FreeMember( i );
+				}
+				else if ( result == FX_ASYNC_VISIBLE )
+				{
+					effectPtrs[i]->Draw();
+				}
 			}
 			else
 			{
-				if ( ef->mEffect->Update() == false )
+				if ( effectPtrs[i]->Update() == false )
 				{
 					// We've been marked for death
-					FX_FreeMember( ef );
+					FX_FreeMember( i );
 					continue;
 				}
 			}
 		}
 	}
 
+	// effects spawned during the walk can make it stop early, don't let a stale result leak into the next frame
+	for ( i = 0; i < numAsyncSlots; i++ )
+	{
+		effectAsyncResults[asyncSlots[i]] = 0;
+	}
+	numAsyncSlots = 0;
+
 	if ( fx_debug->integer && !portal)
 	{
 		theFxHelper.Print( "Active    FX: %i\n", activeFx );
 		theFxHelper.Print( "Drawn     FX: %i\n", drawnFx );
 		theFxHelper.Print( "Scheduled FX: %i High: %i\n", theFxScheduler.NumScheduledFx(), theFxScheduler.GetHighWatermark() );
+		if ( fx_debug->integer > 1 )
+		{
+			FX_PoolStats();
+		}
 	}
 }
 
@@ -205,11 +297,11 @@ void FX_Add( bool portal )
 extern bool gEffectsInPortal;	//from FXScheduler.cpp so i don't have to pass it in on EVERY FX_ADD*
 void FX_AddPrimitive( CEffect **pEffect, int killTime )
 {
-	SEffectList *item = FX_GetValidEffect();
+	const int slot = FX_GetValidEffect();
 
-	item->mEffect = *pEffect;
-	item->mKillTime = theFxHelper.mTime + killTime;
-	item->mPortal = gEffectsInPortal;	//global set in AddScheduledEffects
+	effectPtrs[slot] = *pEffect;
+	effectKillTimes[slot] = theFxHelper.mTime + killTime;
+	effectPortals[slot] = gEffectsInPortal;	//global set in AddScheduledEffects
 
 	activeFx++;
 
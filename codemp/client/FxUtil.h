@@ -38,6 +38,7 @@ int		FX_Init( refdef_t* refdef );
 void	FX_Add( bool portal );
 void	FX_SetRefDef(refdef_t *refdef);
 void	FX_Stop( void );
+void	FX_SchedulerBench_f( void );
 
 CParticle *FX_AddParticle( vec3_t org, vec3_t vel, vec3_t accel,
 							float size1, float size2, float sizeParm,
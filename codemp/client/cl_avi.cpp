@@ -22,8 +22,15 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "client/cl_local.h"
 #include "client/snd_public.h"
+#include "qcommon/com_cvar.h"
 #include "qcommon/com_cvars.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #define INDEX_FILE_EXTENSION ".index.dat"
 
 #define MAX_RIFF_CHUNKS 16
@@ -62,12 +69,57 @@ struct aviFileData_t {
 
   int           chunkStack[ MAX_RIFF_CHUNKS ];
   int           chunkStackTop;
-
-  byte          *cBuffer, *eBuffer;
 };
 
 static aviFileData_t afd;
 
+// Frames are read back into one of these slots and converted or JPEG compressed and written out on the AVI thread,
+// so the client frame never waits on the encoder or the disk. With every slot still queued the frame is dropped.
+#define AVI_CAPTURE_SLOTS 4
+
+enum aviPacketType_e {
+  AVI_PACKET_VIDEO,
+  AVI_PACKET_REPEAT,  // dropped frame, written as an empty chunk which players show as a repeat of the last one
+  AVI_PACKET_AUDIO,
+};
+
+enum aviWriteResult_e {
+  AVI_WRITE_OK,
+  AVI_WRITE_SPLIT,    // doesn't fit under the 2GB limit, has to go in the next file
+  AVI_WRITE_FAILED,
+};
+
+struct aviPacket_t {
+  aviPacketType_e   type;
+  int               slot;
+  const byte        *pixels;  // somewhere inside slots[ slot ], aligned for glReadPixels
+  int               size;
+  std::vector<byte> pcm;
+};
+
+struct aviQueue_t {
+  std::thread             *thread;
+  std::mutex              mutex;
+  std::condition_variable wake;   // packet queued, split done or quit
+  std::condition_variable idle;   // packet written or split needed
+  std::deque<aviPacket_t> packets;
+  bool                    quit;
+  bool                    busy;
+  bool                    splitPending;
+  bool                    writeFailed;
+  bool                    encodeFailed; // a compressed frame didn't fit in eBuffer, raised as an error by the main thread
+
+  byte                    *slots[ AVI_CAPTURE_SLOTS ];
+  bool                    slotQueued[ AVI_CAPTURE_SLOTS ];
+  int                     captureSlot;  // handed to the renderer, not queued yet
+  bool                    firstFrame;
+  int                     droppedFrames;
+  int                     jpegQuality;
+  byte                    *eBuffer;     // AVI thread only
+};
+
+static aviQueue_t aviQueue;
+
 #define MAX_AVI_BUFFER 2048
 
 static byte buffer[ MAX_AVI_BUFFER ];
@@ -283,109 +335,115 @@ void CL_WriteAVIHeader( void )
   }
 }
 
-// Creates an AVI file and gets it into a state where writing the actual data can begin
-bool CL_OpenAVIForWriting( const char *fileName )
+// Opens the next file of a recording and reserves room for the header
+static bool CL_OpenAVIFile( const char *fileName )
 {
-  if( afd.fileOpen )
-    return false;
-
-  Com_Memset( &afd, 0, sizeof( aviFileData_t ) );
-
-  // Don't start if a framerate has not been chosen
-  if( cl_aviFrameRate->integer <= 0 )
+  if( ( afd.f = FS_FOpenFileWrite( fileName ) ) <= 0 )
   {
-    Com_Printf( S_COLOR_RED "cl_aviFrameRate must be >= 1\n" );
+    afd.f = 0;
     return false;
   }
 
-  if( ( afd.f = FS_FOpenFileWrite( fileName ) ) <= 0 )
-    return false;
-
   if( ( afd.idxF = FS_FOpenFileWrite(
           va( "%s" INDEX_FILE_EXTENSION, fileName ) ) ) <= 0 )
   {
     FS_FCloseFile( afd.f );
+    afd.f = 0;
     return false;
   }
 
   Q_strncpyz( afd.fileName, fileName, MAX_QPATH );
 
-  afd.frameRate = cl_aviFrameRate->integer;
-  afd.framePeriod = (int)( 1000000.0f / afd.frameRate );
-  afd.width = cls.glconfig.vidWidth;
-  afd.height = cls.glconfig.vidHeight;
+  afd.fileSize = 0;
+  afd.moviSize = 0;
+  afd.numIndices = 0;
+  afd.numVideoFrames = 0;
+  afd.numAudioFrames = 0;
+  afd.maxRecordSize = 0;
+  afd.a.totalBytes = 0;
 
-  if( cl_aviMotionJpeg->integer )
-    afd.motionJpeg = true;
-  else
-    afd.motionJpeg = false;
+  // This doesn't write a real header, but allocates the
+  // correct amount of space at the beginning of the file
+  CL_WriteAVIHeader( );
 
-  // Buffers only need to store RGB pixels.
-  // Allocate a bit more space for the capture buffer to account for possible
-  // padding at the end of pixel lines, and padding for alignment
-  #define MAX_PACK_LEN 16
-  afd.cBuffer = (byte *)Z_Malloc((afd.width * 3 + MAX_PACK_LEN - 1) * afd.height + MAX_PACK_LEN - 1, TAG_AVI, true);
-  // raw avi files have pixel lines start on 4-byte boundaries
-  afd.eBuffer = (byte *)Z_Malloc(PAD(afd.width * 3, AVI_LINE_PADDING) * afd.height, TAG_AVI, true);
+  SafeFS_Write( buffer, bufIndex, afd.f );
+  afd.fileSize = bufIndex;
 
-  afd.a.rate = dma.speed;
-  afd.a.format = WAV_FORMAT_PCM;
-  afd.a.channels = dma.channels;
-  afd.a.bits = dma.samplebits;
-  afd.a.sampleSize = ( afd.a.bits / 8 ) * afd.a.channels;
+  bufIndex = 0;
+  START_CHUNK( "idx1" );
+  SafeFS_Write( buffer, bufIndex, afd.idxF );
 
-  if( afd.a.rate % afd.frameRate )
-  {
-    int suggestRate = afd.frameRate;
+  afd.moviSize = 4; // For the "movi"
 
-    while( ( afd.a.rate % suggestRate ) && suggestRate >= 1 )
-      suggestRate--;
+  return true;
+}
 
-    Com_Printf( S_COLOR_YELLOW "WARNING: cl_aviFrameRate is not a divisor "
-        "of the audio rate, suggest %d\n", suggestRate );
-  }
+// Writes the index chunk and the real header, then closes the current file of a recording
+static bool CL_CloseAVIFile( void )
+{
+  int indexRemainder;
+  int indexSize = afd.numIndices * 16;
+  const char *idxFileName = va( "%s" INDEX_FILE_EXTENSION, afd.fileName );
 
-  if( !s_initsound->integer )
-  {
-    afd.audio = false;
-  }
-  #ifdef USE_OPENAL
-  else if( s_useOpenAL->integer == 0 )
+  if( !afd.f )
+    return false;
+
+  FS_Seek( afd.idxF, 4, FS_SEEK_SET );
+  bufIndex = 0;
+  WRITE_4BYTES( indexSize );
+  SafeFS_Write( buffer, bufIndex, afd.idxF );
+  FS_FCloseFile( afd.idxF );
+
+  // Write index
+
+  // Open the temp index file
+  if( ( indexSize = FS_FOpenFileRead( idxFileName,
+          &afd.idxF, true ) ) <= 0 )
   {
-    if( afd.a.bits != 16 || afd.a.channels != 2 )
-    {
-      Com_Printf( S_COLOR_YELLOW "WARNING: Audio format of %d bit/%d channels not supported",
-          afd.a.bits, afd.a.channels );
-      afd.audio = false;
-    }
-    else
-      afd.audio = true;
+    FS_FCloseFile( afd.f );
+    afd.f = 0;
+    return false;
   }
-  #endif
-  else
+
+  indexRemainder = indexSize;
+
+  // Append index to end of avi file
+  while( indexRemainder > MAX_AVI_BUFFER )
   {
-    afd.audio = false;
-    Com_Printf( S_COLOR_YELLOW "WARNING: Audio capture is not supported "
-        "with OpenAL. Set s_useOpenAL to 0 for audio capture\n" );
+    FS_Read( buffer, MAX_AVI_BUFFER, afd.idxF );
+    SafeFS_Write( buffer, MAX_AVI_BUFFER, afd.f );
+    afd.fileSize += MAX_AVI_BUFFER;
+    indexRemainder -= MAX_AVI_BUFFER;
   }
+  FS_Read( buffer, indexRemainder, afd.idxF );
+  SafeFS_Write( buffer, indexRemainder, afd.f );
+  afd.fileSize += indexRemainder;
+  FS_FCloseFile( afd.idxF );
 
-  // This doesn't write a real header, but allocates the
-  // correct amount of space at the beginning of the file
+  // Remove temp index file
+  FS_HomeRemove( idxFileName );
+
+  // Write the real header
+  FS_Seek( afd.f, 0, FS_SEEK_SET );
   CL_WriteAVIHeader( );
 
+  bufIndex = 4;
+  WRITE_4BYTES( afd.fileSize - 8 ); // "RIFF" size
+
+  bufIndex = afd.moviOffset + 4;    // Skip "LIST"
+  WRITE_4BYTES( afd.moviSize );
+
   SafeFS_Write( buffer, bufIndex, afd.f );
-  afd.fileSize = bufIndex;
 
-  bufIndex = 0;
-  START_CHUNK( "idx1" );
-  SafeFS_Write( buffer, bufIndex, afd.idxF );
+  FS_FCloseFile( afd.f );
+  afd.f = 0;
 
-  afd.moviSize = 4; // For the "movi"
-  afd.fileOpen = true;
+  Com_Printf( "Wrote %d:%d frames to %s\n", afd.numVideoFrames, afd.numAudioFrames, afd.fileName );
 
   return true;
 }
 
+// True when adding this many bytes would take the file past the 2GB limit
 static bool CL_CheckFileSize( int bytesToAdd )
 {
   unsigned int newFileSize;
@@ -402,12 +460,6 @@ static bool CL_CheckFileSize( int bytesToAdd )
     // we target can handle a 2Gb file
     if ( newFileSize > INT_MAX )
     {
-      // Close the current file...
-      CL_CloseAVI();
-
-      // ...And open a new one
-      CL_OpenAVIForWriting( va( "%s_", afd.fileName ) );
-
       return true;
     }
   }
@@ -415,44 +467,326 @@ static bool CL_CheckFileSize( int bytesToAdd )
   return false;
 }
 
-void CL_WriteAVIVideoFrame( const byte *imageBuffer, int size )
+// Everything below the main thread hands over is converted and written on the AVI thread, which owns afd's counters
+// and the file handles until it is parked (split) or joined (close)
+
+static QINLINE bool CL_AVIWrite( const void *buffer, int len, fileHandle_t f )
+{
+  return FS_Write( buffer, len, f ) >= len;
+}
+
+// Turns a captured frame into the AVI's video format in aviQueue.eBuffer and returns its size
+static int CL_EncodeAVIVideoFrame( const aviPacket_t &packet )
+{
+  const int linelen = afd.width * 3;
+  const int padlen = packet.size / afd.height - linelen;
+
+  if( afd.motionJpeg )
+  {
+    return (int)re->SaveJPGToBuffer( aviQueue.eBuffer, linelen * afd.height,
+        aviQueue.jpegQuality, afd.width, afd.height, (byte *)packet.pixels, padlen );
+  }
+
+  // AVI line padding
+  const int avipadwidth = PAD( linelen, AVI_LINE_PADDING );
+  const int avipadlen = avipadwidth - linelen;
+  const byte *srcptr = packet.pixels;
+  byte *destptr = aviQueue.eBuffer;
+
+  // swap R and B and remove line paddings
+  for( int y = 0; y < afd.height; y++ )
+  {
+    const byte *lineend = srcptr + linelen;
+
+    while( srcptr < lineend )
+    {
+      *destptr++ = srcptr[2];
+      *destptr++ = srcptr[1];
+      *destptr++ = srcptr[0];
+      srcptr += 3;
+    }
+
+    Com_Memset( destptr, '\0', avipadlen );
+    destptr += avipadlen;
+
+    srcptr += padlen;
+  }
+
+  return avipadwidth * afd.height;
+}
+
+static aviWriteResult_e CL_WriteAVIPacket( const aviPacket_t &packet )
 {
+  const char  *chunkId = "00dc";
+  const byte  *data = nullptr;
+  int         size = 0;
+  byte        padding[ 4 ] = { 0 };
+
+  switch( packet.type )
+  {
+    case AVI_PACKET_VIDEO:
+      data = aviQueue.eBuffer;
+      size = CL_EncodeAVIVideoFrame( packet );
+      if( !size )
+      {
+        std::lock_guard<std::mutex> lock( aviQueue.mutex );
+        aviQueue.encodeFailed = true;
+        return AVI_WRITE_FAILED;
+      }
+      break;
+
+    case AVI_PACKET_REPEAT:
+      break;
+
+    case AVI_PACKET_AUDIO:
+      chunkId = "01wb";
+      data = packet.pcm.data( );
+      size = (int)packet.pcm.size( );
+      break;
+  }
+
   int   chunkOffset = afd.fileSize - afd.moviOffset - 8;
   int   chunkSize = 8 + size;
   int   paddingSize = PADLEN(size, 2);
-  byte  padding[ 4 ] = { 0 };
-
-  if( !afd.fileOpen )
-    return;
 
   // Chunk header + contents + padding
   if( CL_CheckFileSize( 8 + size + 2 ) )
-    return;
+    return AVI_WRITE_SPLIT;
 
   bufIndex = 0;
-  WRITE_STRING( "00dc" );
+  WRITE_STRING( chunkId );
   WRITE_4BYTES( size );
 
-  SafeFS_Write( buffer, 8, afd.f );
-  SafeFS_Write( imageBuffer, size, afd.f );
-  SafeFS_Write( padding, paddingSize, afd.f );
-  afd.fileSize += ( chunkSize + paddingSize );
+  if( !CL_AVIWrite( buffer, 8, afd.f ) ||
+      ( size && !CL_AVIWrite( data, size, afd.f ) ) ||
+      ( paddingSize && !CL_AVIWrite( padding, paddingSize, afd.f ) ) )
+    return AVI_WRITE_FAILED;
 
-  afd.numVideoFrames++;
+  afd.fileSize += ( chunkSize + paddingSize );
   afd.moviSize += ( chunkSize + paddingSize );
 
-  if( size > afd.maxRecordSize )
-    afd.maxRecordSize = size;
+  if( packet.type == AVI_PACKET_AUDIO )
+  {
+    afd.numAudioFrames++;
+    afd.a.totalBytes += size;
+  }
+  else
+  {
+    afd.numVideoFrames++;
+
+    if( size > afd.maxRecordSize )
+      afd.maxRecordSize = size;
+  }
 
   // Index
   bufIndex = 0;
-  WRITE_STRING( "00dc" );           //dwIdentifier
-  WRITE_4BYTES( 0x00000010 );       //dwFlags (all frames are KeyFrames)
+  WRITE_STRING( chunkId );          //dwIdentifier
+  if( packet.type == AVI_PACKET_AUDIO )
+    WRITE_4BYTES( 0 );              //dwFlags
+  else
+    WRITE_4BYTES( 0x00000010 );     //dwFlags (all frames are KeyFrames)
   WRITE_4BYTES( chunkOffset );      //dwOffset
   WRITE_4BYTES( size );             //dwLength
-  SafeFS_Write( buffer, 16, afd.idxF );
+  if( !CL_AVIWrite( buffer, 16, afd.idxF ) )
+    return AVI_WRITE_FAILED;
 
   afd.numIndices++;
+
+  return AVI_WRITE_OK;
+}
+
+static void CL_AVIThread( void )
+{
+  std::unique_lock<std::mutex> lock( aviQueue.mutex );
+
+  for( ;; )
+  {
+    aviQueue.wake.wait( lock, [] {
+      return aviQueue.quit || ( !aviQueue.splitPending && !aviQueue.packets.empty( ) );
+    } );
+
+    // only reachable once told to quit
+    if( aviQueue.splitPending || aviQueue.packets.empty( ) )
+      break;
+
+    aviPacket_t packet = std::move( aviQueue.packets.front( ) );
+    aviQueue.packets.pop_front( );
+    aviQueue.busy = true;
+
+    // after a failed write everything left is thrown away
+    const bool discard = aviQueue.writeFailed;
+
+    lock.unlock( );
+    const aviWriteResult_e result = discard ? AVI_WRITE_OK : CL_WriteAVIPacket( packet );
+    lock.lock( );
+
+    aviQueue.busy = false;
+    if( result == AVI_WRITE_SPLIT )
+    {
+      // park on it until the main thread has opened the next file
+      aviQueue.packets.push_front( std::move( packet ) );
+      aviQueue.splitPending = true;
+    }
+    else
+    {
+      if( result == AVI_WRITE_FAILED )
+        aviQueue.writeFailed = true;
+
+      if( packet.type == AVI_PACKET_VIDEO )
+        aviQueue.slotQueued[ packet.slot ] = false;
+    }
+
+    aviQueue.idle.notify_all( );
+  }
+}
+
+static void CL_QueueAVIPacket( aviPacket_t &packet )
+{
+  {
+    std::lock_guard<std::mutex> lock( aviQueue.mutex );
+    aviQueue.packets.push_back( std::move( packet ) );
+  }
+  aviQueue.wake.notify_one( );
+}
+
+// Starts the next file once the AVI thread has parked on a packet that doesn't fit in the current one
+static void CL_SplitAVI( void )
+{
+  char fileName[ MAX_QPATH ];
+  bool opened;
+
+  {
+    std::lock_guard<std::mutex> lock( aviQueue.mutex );
+    if( !aviQueue.splitPending )
+      return;
+  }
+
+  // the thread doesn't touch afd again until splitPending is cleared
+  Q_strncpyz( fileName, va( "%s_", afd.fileName ), sizeof( fileName ) );
+  CL_CloseAVIFile( );
+  opened = CL_OpenAVIFile( fileName );
+
+  {
+    std::lock_guard<std::mutex> lock( aviQueue.mutex );
+    aviQueue.splitPending = false;
+    if( !opened )
+      aviQueue.writeFailed = true;
+  }
+  aviQueue.wake.notify_one( );
+}
+
+// Creates an AVI file and gets it into a state where writing the actual data can begin
+bool CL_OpenAVIForWriting( const char *fileName )
+{
+  if( afd.fileOpen )
+    return false;
+
+  Com_Memset( &afd, 0, sizeof( aviFileData_t ) );
+
+  // Don't start if a framerate has not been chosen
+  if( cl_aviFrameRate->integer <= 0 )
+  {
+    Com_Printf( S_COLOR_RED "cl_aviFrameRate must be >= 1\n" );
+    return false;
+  }
+
+  afd.frameRate = cl_aviFrameRate->integer;
+  afd.framePeriod = (int)( 1000000.0f / afd.frameRate );
+  afd.width = cls.glconfig.vidWidth;
+  afd.height = cls.glconfig.vidHeight;
+
+  if( cl_aviMotionJpeg->integer )
+    afd.motionJpeg = true;
+  else
+    afd.motionJpeg = false;
+
+  afd.a.rate = dma.speed;
+  afd.a.format = WAV_FORMAT_PCM;
+  afd.a.channels = dma.channels;
+  afd.a.bits = dma.samplebits;
+  afd.a.sampleSize = ( afd.a.bits / 8 ) * afd.a.channels;
+
+  if( afd.a.rate % afd.frameRate )
+  {
+    int suggestRate = afd.frameRate;
+
+    while( ( afd.a.rate % suggestRate ) && suggestRate >= 1 )
+      suggestRate--;
+
+    Com_Printf( S_COLOR_YELLOW "WARNING: cl_aviFrameRate is not a divisor "
+        "of the audio rate, suggest %d\n", suggestRate );
+  }
+
+  if( !s_initsound->integer )
+  {
+    afd.audio = false;
+  }
+  #ifdef USE_OPENAL
+  else if( s_useOpenAL->integer == 0 )
+  {
+    if( afd.a.bits != 16 || afd.a.channels != 2 )
+    {
+      Com_Printf( S_COLOR_YELLOW "WARNING: Audio format of %d bit/%d channels not supported",
+          afd.a.bits, afd.a.channels );
+      afd.audio = false;
+    }
+    else
+      afd.audio = true;
+  }
+  #endif
+  else
+  {
+    afd.audio = false;
+    Com_Printf( S_COLOR_YELLOW "WARNING: Audio capture is not supported "
+        "with OpenAL. Set s_useOpenAL to 0 for audio capture\n" );
+  }
+
+  // the header written here has to know about the audio stream already
+  if( !CL_OpenAVIFile( fileName ) )
+    return false;
+
+  // Capture buffers only need to store RGB pixels.
+  // Allocate a bit more space for them to account for possible
+  // padding at the end of pixel lines, and padding for alignment
+  #define MAX_PACK_LEN 16
+  for( int i = 0; i < AVI_CAPTURE_SLOTS; i++ )
+  {
+    aviQueue.slots[ i ] = (byte *)Z_Malloc((afd.width * 3 + MAX_PACK_LEN - 1) * afd.height + MAX_PACK_LEN - 1, TAG_AVI, true);
+    aviQueue.slotQueued[ i ] = false;
+  }
+  // raw avi files have pixel lines start on 4-byte boundaries
+  aviQueue.eBuffer = (byte *)Z_Malloc(PAD(afd.width * 3, AVI_LINE_PADDING) * afd.height, TAG_AVI, true);
+
+  aviQueue.captureSlot = -1;
+  aviQueue.firstFrame = true;
+  aviQueue.droppedFrames = 0;
+  aviQueue.jpegQuality = Cvar_VariableIntegerValue( "r_aviMotionJpegQuality" );
+  aviQueue.quit = false;
+  aviQueue.busy = false;
+  aviQueue.splitPending = false;
+  aviQueue.writeFailed = false;
+  aviQueue.encodeFailed = false;
+  aviQueue.thread = new std::thread( CL_AVIThread );
+
+  afd.fileOpen = true;
+
+  return true;
+}
+
+void CL_QueueAVIVideoFrame( const byte *imageBuffer, int size )
+{
+  aviPacket_t packet = {};
+
+  if( !afd.fileOpen || aviQueue.captureSlot < 0 )
+    return;
+
+  packet.type = AVI_PACKET_VIDEO;
+  packet.slot = aviQueue.captureSlot;
+  packet.pixels = imageBuffer;
+  packet.size = size;
+  aviQueue.captureSlot = -1;
+
+  CL_QueueAVIPacket( packet );
 }
 
 #define PCM_BUFFER_SIZE 44100
@@ -468,10 +802,6 @@ void CL_WriteAVIAudioFrame( const byte *pcmBuffer, int size )
   if( !afd.fileOpen )
     return;
 
-  // Chunk header + contents + padding
-  if( CL_CheckFileSize( 8 + bytesInBuffer + size + 2 ) )
-    return;
-
   if( bytesInBuffer + size > PCM_BUFFER_SIZE )
   {
     Com_Printf( S_COLOR_YELLOW
@@ -486,114 +816,168 @@ void CL_WriteAVIAudioFrame( const byte *pcmBuffer, int size )
   if( bytesInBuffer >= (int)ceil( (float)afd.a.rate / (float)afd.frameRate ) *
         afd.a.sampleSize )
   {
-    int   chunkOffset = afd.fileSize - afd.moviOffset - 8;
-    int   chunkSize = 8 + bytesInBuffer;
-    int   paddingSize = PADLEN(bytesInBuffer, 2);
-    byte  padding[ 4 ] = { 0 };
+    aviPacket_t packet = {};
 
-    bufIndex = 0;
-    WRITE_STRING( "01wb" );
-    WRITE_4BYTES( bytesInBuffer );
+    packet.type = AVI_PACKET_AUDIO;
+    packet.pcm.assign( pcmCaptureBuffer, pcmCaptureBuffer + bytesInBuffer );
+    CL_QueueAVIPacket( packet );
 
-    SafeFS_Write( buffer, 8, afd.f );
-    SafeFS_Write( pcmCaptureBuffer, bytesInBuffer, afd.f );
-    SafeFS_Write( padding, paddingSize, afd.f );
-    afd.fileSize += ( chunkSize + paddingSize );
+    bytesInBuffer = 0;
+  }
+}
 
-    afd.numAudioFrames++;
-    afd.moviSize += ( chunkSize + paddingSize );
-    afd.a.totalBytes += bytesInBuffer;
+// Picks a free capture slot for the renderer to read the next frame into. When the AVI thread still has all of them
+// the frame is dropped and written as an empty chunk so the video keeps its timing
+static bool CL_ReserveAVICaptureSlot( void )
+{
+  std::unique_lock<std::mutex> lock( aviQueue.mutex );
 
-    // Index
-    bufIndex = 0;
-    WRITE_STRING( "01wb" );           //dwIdentifier
-    WRITE_4BYTES( 0 );                //dwFlags
-    WRITE_4BYTES( chunkOffset );      //dwOffset
-    WRITE_4BYTES( bytesInBuffer );    //dwLength
-    SafeFS_Write( buffer, 16, afd.idxF );
+  for( int i = 0; i < AVI_CAPTURE_SLOTS; i++ )
+  {
+    if( !aviQueue.slotQueued[ i ] )
+    {
+      aviQueue.slotQueued[ i ] = true;
+      aviQueue.captureSlot = i;
+      return true;
+    }
+  }
 
-    afd.numIndices++;
+  lock.unlock( );
 
-    bytesInBuffer = 0;
+  aviPacket_t packet = {};
+  packet.type = AVI_PACKET_REPEAT;
+  CL_QueueAVIPacket( packet );
+
+  if( !aviQueue.droppedFrames++ )
+    Com_Printf( S_COLOR_YELLOW "WARNING: AVI encoder is falling behind, dropping frames\n" );
+
+  return false;
+}
+
+// Picks a capture slot for a frame that can't be dropped, waiting for the AVI thread to hand one back if needed
+static void CL_WaitAVICaptureSlot( void )
+{
+  std::unique_lock<std::mutex> lock( aviQueue.mutex );
+
+  for( ;; )
+  {
+    for( int i = 0; i < AVI_CAPTURE_SLOTS; i++ )
+    {
+      if( !aviQueue.slotQueued[ i ] )
+      {
+        aviQueue.slotQueued[ i ] = true;
+        aviQueue.captureSlot = i;
+        return;
+      }
+    }
+
+    // the AVI thread won't hand anything back while it's parked on a split
+    if( aviQueue.splitPending )
+    {
+      lock.unlock( );
+      CL_SplitAVI( );
+      lock.lock( );
+      continue;
+    }
+
+    aviQueue.idle.wait( lock );
   }
 }
 
 void CL_TakeVideoFrame( void )
 {
+  bool writeFailed, encodeFailed;
+
   // AVI file isn't open
   if( !afd.fileOpen )
     return;
 
+  CL_SplitAVI( );
+
+  {
+    std::lock_guard<std::mutex> lock( aviQueue.mutex );
+    writeFailed = aviQueue.writeFailed;
+    encodeFailed = aviQueue.encodeFailed;
+  }
+
+  if( writeFailed )
+  {
+    CL_CloseAVI( );
+    if( encodeFailed )
+      Com_Error( ERR_DROP, "Encoded avi video frame didn't fit, lower r_aviMotionJpegQuality" );
+    Com_Error( ERR_DROP, "Failed to write avi file" );
+  }
+
+  // a slot is kept while the renderer's readback ring is still filling up
+  if( aviQueue.captureSlot < 0 && !CL_ReserveAVICaptureSlot( ) )
+    return;
+
   re->TakeVideoFrame( afd.width, afd.height,
-      afd.cBuffer, afd.eBuffer, afd.motionJpeg );
+      aviQueue.slots[ aviQueue.captureSlot ], aviQueue.firstFrame );
+  aviQueue.firstFrame = false;
 }
 
-// Closes the AVI file and writes an index chunk
+// Waits for the AVI thread to write out everything queued, then closes the AVI file and writes an index chunk
 bool CL_CloseAVI( void )
 {
-  int indexRemainder;
-  int indexSize = afd.numIndices * 16;
-  const char *idxFileName = va( "%s" INDEX_FILE_EXTENSION, afd.fileName );
-
   // AVI file isn't open
   if( !afd.fileOpen )
     return false;
 
-  afd.fileOpen = false;
-
-  FS_Seek( afd.idxF, 4, FS_SEEK_SET );
-  bufIndex = 0;
-  WRITE_4BYTES( indexSize );
-  SafeFS_Write( buffer, bufIndex, afd.idxF );
-  FS_FCloseFile( afd.idxF );
-
-  // Write index
-
-  // Open the temp index file
-  if( ( indexSize = FS_FOpenFileRead( idxFileName,
-          &afd.idxF, true ) ) <= 0 )
+  // the last frames are still in the renderer's readback ring
+  if( cls.rendererStarted )
   {
-    FS_FCloseFile( afd.f );
-    return false;
+    do
+    {
+      if( aviQueue.captureSlot < 0 )
+        CL_WaitAVICaptureSlot( );
+    } while( re->FlushVideoFrame( afd.width, afd.height, aviQueue.slots[ aviQueue.captureSlot ] ) );
   }
 
-  indexRemainder = indexSize;
+  afd.fileOpen = false;
 
-  // Append index to end of avi file
-  while( indexRemainder > MAX_AVI_BUFFER )
   {
-    FS_Read( buffer, MAX_AVI_BUFFER, afd.idxF );
-    SafeFS_Write( buffer, MAX_AVI_BUFFER, afd.f );
-    afd.fileSize += MAX_AVI_BUFFER;
-    indexRemainder -= MAX_AVI_BUFFER;
-  }
-  FS_Read( buffer, indexRemainder, afd.idxF );
-  SafeFS_Write( buffer, indexRemainder, afd.f );
-  afd.fileSize += indexRemainder;
-  FS_FCloseFile( afd.idxF );
+    std::unique_lock<std::mutex> lock( aviQueue.mutex );
 
-  // Remove temp index file
-  FS_HomeRemove( idxFileName );
+    for( ;; )
+    {
+      aviQueue.idle.wait( lock, [] {
+        return aviQueue.splitPending || ( aviQueue.packets.empty( ) && !aviQueue.busy );
+      } );
 
-  // Write the real header
-  FS_Seek( afd.f, 0, FS_SEEK_SET );
-  CL_WriteAVIHeader( );
+      if( !aviQueue.splitPending )
+        break;
 
-  bufIndex = 4;
-  WRITE_4BYTES( afd.fileSize - 8 ); // "RIFF" size
+      lock.unlock( );
+      CL_SplitAVI( );
+      lock.lock( );
+    }
 
-  bufIndex = afd.moviOffset + 4;    // Skip "LIST"
-  WRITE_4BYTES( afd.moviSize );
+    aviQueue.quit = true;
+  }
+  aviQueue.wake.notify_one( );
 
-  SafeFS_Write( buffer, bufIndex, afd.f );
+  aviQueue.thread->join( );
+  delete aviQueue.thread;
+  aviQueue.thread = nullptr;
 
-  Z_Free( afd.cBuffer );
-  Z_Free( afd.eBuffer );
-  FS_FCloseFile( afd.f );
+  const bool closed = CL_CloseAVIFile( );
 
-  Com_Printf( "Wrote %d:%d frames to %s\n", afd.numVideoFrames, afd.numAudioFrames, afd.fileName );
+  for( int i = 0; i < AVI_CAPTURE_SLOTS; i++ )
+  {
+    Z_Free( aviQueue.slots[ i ] );
+    aviQueue.slots[ i ] = nullptr;
+  }
+  Z_Free( aviQueue.eBuffer );
+  aviQueue.eBuffer = nullptr;
 
-  return true;
+  if( aviQueue.droppedFrames )
+  {
+    Com_Printf( S_COLOR_YELLOW "WARNING: %d video frames were dropped while the AVI encoder was behind\n",
+        aviQueue.droppedFrames );
+  }
+
+  return closed;
 }
 
 bool CL_VideoRecording( void )
@@ -0,0 +1,315 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// cl_bench.cpp -- timedemo benchmark with per-section frame times
+
+#include "client/cl_local.h"
+#include "client/cl_bench.h"
+#include "qcommon/com_cvar.h"
+#include "qcommon/com_cvars.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+struct benchFrame_t {
+	int		usec[BENCH_NUM_SECTIONS];
+};
+
+static const char *benchSectionNames[BENCH_NUM_SECTIONS] = {
+	"frame",
+	"cgame",
+	"fx",
+	"sound",
+	"scene",
+	"endframe",
+};
+
+static bool							benchActive;
+static bool							benchNoRender;
+static bool							benchQuit;
+static char							benchDemo[MAX_QPATH];
+static char							benchOldSkipBackEnd[MAX_CVAR_VALUE_STRING];
+static char							benchOldTimedemo[MAX_CVAR_VALUE_STRING];
+static benchFrame_t					benchCurrent;
+static int64_t						benchStartTime[BENCH_NUM_SECTIONS];
+static std::vector<benchFrame_t>	benchFrames;
+
+static int64_t CL_Bench_Now( void )
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void CL_Bench_Start( benchSection_e section )
+{
+	if ( !benchActive )
+	{
+		return;
+	}
+
+	benchStartTime[section] = CL_Bench_Now();
+}
+
+void CL_Bench_Stop( benchSection_e section )
+{
+	if ( !benchActive )
+	{
+		return;
+	}
+
+	// sections can run more than once a frame (portal views), so accumulate
+	benchCurrent.usec[section] += (int)( CL_Bench_Now() - benchStartTime[section] );
+}
+
+// keeps the frame just gone if it was a real timedemo frame, then starts a new one
+void CL_Bench_EndFrame( void )
+{
+	if ( !benchActive )
+	{
+		return;
+	}
+
+	if ( clc.demoplaying && cls.state == CA_ACTIVE && clc.timeDemoStart )
+	{
+		benchFrames.push_back( benchCurrent );
+
+		// it's a cheat cvar, so the gamestate of a demo recorded without sv_cheats will have reset it
+		if ( benchNoRender && !Cvar_VariableIntegerValue( "r_skipBackEnd" ) )
+		{
+			Cvar_Set( "r_skipBackEnd", "1" );
+		}
+	}
+
+	memset( &benchCurrent, 0, sizeof( benchCurrent ) );
+}
+
+// p is 0..100, nearest rank on an already sorted array
+static int CL_Bench_Percentile( const std::vector<int> &sorted, float p )
+{
+	const int rank = (int)ceilf( p / 100.0f * sorted.size() ) - 1;
+
+	return sorted[Com_Clampi( 0, (int)sorted.size() - 1, rank )];
+}
+
+static void CL_Bench_WriteFiles( const std::vector<int> (&sorted)[BENCH_NUM_SECTIONS], const double (&avg)[BENCH_NUM_SECTIONS] )
+{
+	char			baseName[MAX_QPATH];
+	fileHandle_t	f;
+
+	COM_StripExtension( COM_SkipPath( benchDemo ), baseName, sizeof( baseName ) );
+
+	f = FS_FOpenFileWrite( va( "benchmarks/%s.csv", baseName ) );
+	if ( f )
+	{
+		FS_Printf( f, "frame" );
+		for ( int s = 0; s < BENCH_NUM_SECTIONS; s++ )
+		{
+			FS_Printf( f, ",%s_usec", benchSectionNames[s] );
+		}
+		FS_Printf( f, "\n" );
+
+		for ( size_t i = 0; i < benchFrames.size(); i++ )
+		{
+			FS_Printf( f, "%i", (int)i );
+			for ( int s = 0; s < BENCH_NUM_SECTIONS; s++ )
+			{
+				FS_Printf( f, ",%i", benchFrames[i].usec[s] );
+			}
+			FS_Printf( f, "\n" );
+		}
+		FS_FCloseFile( f );
+	}
+
+	f = FS_FOpenFileWrite( va( "benchmarks/%s.json", baseName ) );
+	if ( f )
+	{
+		FS_Printf( f, "{\n\t\"demo\": \"%s\",\n\t\"frames\": %i,\n\t\"norender\": %s,\n\t\"sections\": {\n",
+			benchDemo, (int)benchFrames.size(), benchNoRender ? "true" : "false" );
+
+		for ( int s = 0; s < BENCH_NUM_SECTIONS; s++ )
+		{
+			FS_Printf( f, "\t\t\"%s\": { \"min\": %i, \"avg\": %.1f, \"p1\": %i, \"p99\": %i, \"max\": %i }%s\n",
+				benchSectionNames[s], sorted[s].front(), avg[s], CL_Bench_Percentile( sorted[s], 1.0f ),
+				CL_Bench_Percentile( sorted[s], 99.0f ), sorted[s].back(), ( s < BENCH_NUM_SECTIONS - 1 ) ? "," : "" );
+		}
+
+		FS_Printf( f, "\t}\n}\n" );
+		FS_FCloseFile( f );
+	}
+
+	Com_Printf( "Wrote benchmarks/%s.csv and benchmarks/%s.json\n", baseName, baseName );
+}
+
+static void CL_Bench_End( void )
+{
+	benchActive = false;
+	Cvar_Set( "timedemo", benchOldTimedemo );
+	if ( benchNoRender )
+	{
+		Cvar_Set( "r_skipBackEnd", benchOldSkipBackEnd );
+	}
+}
+
+// called on disconnects and errors, the demo didn't run to the end so there is nothing to report
+void CL_Bench_Abort( void )
+{
+	if ( !benchActive )
+	{
+		return;
+	}
+
+	CL_Bench_End();
+	benchFrames.clear();
+	benchFrames.shrink_to_fit();
+
+	Com_Printf( "benchmark: %s was stopped before the end, no results written\n", benchDemo );
+
+	if ( benchQuit )
+	{
+		Cbuf_AddText( "quit\n" );
+	}
+}
+
+// called when the demo runs out, prints the report and writes the csv/json
+void CL_Bench_Finish( void )
+{
+	std::vector<int>	sorted[BENCH_NUM_SECTIONS];
+	double				avg[BENCH_NUM_SECTIONS];
+
+	if ( !benchActive )
+	{
+		return;
+	}
+
+	CL_Bench_End();
+
+	if ( benchFrames.empty() )
+	{
+		Com_Printf( "benchmark: no frames recorded from %s\n", benchDemo );
+	}
+	else
+	{
+		for ( int s = 0; s < BENCH_NUM_SECTIONS; s++ )
+		{
+			double total = 0.0;
+
+			sorted[s].reserve( benchFrames.size() );
+			for ( size_t i = 0; i < benchFrames.size(); i++ )
+			{
+				sorted[s].push_back( benchFrames[i].usec[s] );
+				total += benchFrames[i].usec[s];
+			}
+			std::sort( sorted[s].begin(), sorted[s].end() );
+			avg[s] = total / benchFrames.size();
+		}
+
+		Com_Printf( "benchmark %s: %i frames%s (times in usec)\n", benchDemo, (int)benchFrames.size(), benchNoRender ? ", no render" : "" );
+		Com_Printf( "%-10s %8s %10s %8s %8s %8s\n", "section", "min", "avg", "p1", "p99", "max" );
+		for ( int s = 0; s < BENCH_NUM_SECTIONS; s++ )
+		{
+			Com_Printf( "%-10s %8i %10.1f %8i %8i %8i\n", benchSectionNames[s], sorted[s].front(), avg[s],
+				CL_Bench_Percentile( sorted[s], 1.0f ), CL_Bench_Percentile( sorted[s], 99.0f ), sorted[s].back() );
+		}
+
+		CL_Bench_WriteFiles( sorted, avg );
+	}
+
+	benchFrames.clear();
+	benchFrames.shrink_to_fit();
+
+	if ( benchQuit )
+	{
+		Cbuf_AddText( "quit\n" );
+	}
+}
+
+/*
+benchmark <demoname> [norender] [quit]
+
+Plays the demo as a timedemo and records how long the client spent in each benchmark section every frame.
+norender sets r_skipBackEnd for the run, so the renderer frontend still culls and sorts but nothing reaches the
+GPU, which keeps the numbers down to client, cgame and fx cost. quit exits once the results are written, or once
+the run failed so unattended runs never hang.
+*/
+void CL_Bench_f( void )
+{
+	if ( Cmd_Argc() < 2 )
+	{
+		Com_Printf( "benchmark <demoname> [norender] [quit]\n" );
+		return;
+	}
+
+	char	demo[MAX_QPATH];
+	bool	noRender = false;
+	bool	quit = false;
+
+	Q_strncpyz( demo, Cmd_Argv( 1 ), sizeof( demo ) );
+	for ( int i = 2; i < Cmd_Argc(); i++ )
+	{
+		if ( !Q_stricmp( Cmd_Argv( i ), "norender" ) )
+		{
+			noRender = true;
+		}
+		else if ( !Q_stricmp( Cmd_Argv( i ), "quit" ) )
+		{
+			quit = true;
+		}
+	}
+
+	// start the demo right away, so a demo that can't be opened never gets the cvars changed. Starting it also
+	//	disconnects, which aborts a benchmark that is still running.
+	try
+	{
+		Cmd_ExecuteString( va( "demo \"%s\"", demo ) );
+	}
+	catch ( int )
+	{
+		if ( quit )
+		{
+			Cbuf_AddText( "quit\n" );
+		}
+		throw;
+	}
+
+	if ( !clc.demoplaying )
+	{
+		if ( quit )
+		{
+			Cbuf_AddText( "quit\n" );
+		}
+		return;
+	}
+
+	Q_strncpyz( benchDemo, demo, sizeof( benchDemo ) );
+	benchNoRender = noRender;
+	benchQuit = quit;
+	Q_strncpyz( benchOldTimedemo, timedemo->string, sizeof( benchOldTimedemo ) );
+	Q_strncpyz( benchOldSkipBackEnd, Cvar_VariableString( "r_skipBackEnd" ), sizeof( benchOldSkipBackEnd ) );
+
+	Cvar_Set( "timedemo", "1" );
+
+	benchFrames.clear();
+	memset( &benchCurrent, 0, sizeof( benchCurrent ) );
+	benchActive = true;
+}
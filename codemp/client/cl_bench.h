@@ -0,0 +1,51 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#pragma once
+
+// ======================================================================
+// ENUM
+// ======================================================================
+
+// sections are inclusive, so cgame also counts the fx and scene submission it drives
+typedef enum {
+	BENCH_FRAME,		// all of CL_Frame
+	BENCH_CGAME,		// CG_DrawActiveFrame
+	BENCH_FX,			// FX_AddScheduledEffects
+	BENCH_SOUND,		// S_Update
+	BENCH_SCENE,		// RenderScene, the renderer frontend culling and sorting a scene
+	BENCH_ENDFRAME,		// EndFrame, the renderer backend drawing the queued commands and the buffer swap
+	BENCH_NUM_SECTIONS
+} benchSection_e;
+
+// ======================================================================
+// FUNCTION
+// ======================================================================
+
+void CL_Bench_Abort( void );
+void CL_Bench_EndFrame( void );
+void CL_Bench_Finish( void );
+void CL_Bench_f( void );
+void CL_Bench_Start( benchSection_e section );
+void CL_Bench_Stop( benchSection_e section );
@@ -24,6 +24,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 // cl_cgame.c  -- client system interaction with client game
 #include "botlib/botlib.h"
+#include "client/cl_bench.h"
 #include "client/cl_cgameapi.h"
 #include "client/cl_local.h"
 #include "client/FXExport.h"
@@ -528,7 +529,9 @@ void CL_CGameRendering( stereoFrame_e stereo ) {
 	re->G2API_SetTime(cl.serverTime, 1);
 	//rww - RAGDOLL_END
 
+	CL_Bench_Start( BENCH_CGAME );
 	CGVM_DrawActiveFrame( cl.serverTime, stereo, clc.demoplaying );
+	CL_Bench_Stop( BENCH_CGAME );
 }
 
 #define	RESET_TIME	500
@@ -22,6 +22,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 // cl_cgameapi.cpp  -- client system interaction with client game
 #include "botlib/botlib.h"
 #include "cgame/cg_public.h"
+#include "client/cl_bench.h"
 #include "client/cl_keys.h"
 #include "client/cl_local.h"
 #include "client/cl_uiapi.h"
@@ -314,6 +315,12 @@ static int CL_PrecisionTimerEnd( void *p ) {
 
 static void CL_RMG_Init( int /* terrainID */, const char * /* terrainInfo */ ) { }
 
+static void CL_R_RenderScene( const refdef_t *fd ) {
+	CL_Bench_Start( BENCH_SCENE );
+	re->RenderScene( fd );
+	CL_Bench_Stop( BENCH_SCENE );
+}
+
 static bool CGFX_PlayBoltedEffectID( int id, vec3_t org, void *ghoul2, const int boltNum, const int entNum, const int modelNum, int iLooptime, bool isRelative ) {
 	if ( !ghoul2 ) return false;
 
@@ -813,7 +820,7 @@ void CL_BindCGame( void ) {
 	cgi.R_RegisterShaderNoMip				= re->RegisterShaderNoMip;
 	cgi.R_RegisterSkin						= re->RegisterSkin;
 	cgi.R_RemapShader						= re->RemapShader;
-	cgi.R_RenderScene						= re->RenderScene;
+	cgi.R_RenderScene						= CL_R_RenderScene;
 	cgi.R_SetColor							= re->SetColor;
 	cgi.R_SetLightStyle						= re->SetLightStyle;
 	cgi.R_SetRangedFog						= re->SetRangedFog;
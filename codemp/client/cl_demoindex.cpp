@@ -0,0 +1,491 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// cl_demoindex.cpp -- keyframe sidecar for demo playback, and seeking with it
+
+#include "client/cl_local.h"
+#include "client/cl_demoindex.h"
+#include "qcommon/com_cvar.h"
+#include "qcommon/com_cvars.h"
+
+#include <vector>
+
+#define	DEMO_INDEX_IDENT		(('X'<<24)+('D'<<16)+('I'<<8)+'D')
+#define	DEMO_INDEX_VERSION		1
+#define	DEMO_INDEX_MAX_DELTA	8		// snapshots a keyframe is willing to carry for later messages to delta from
+
+// the sidecar is only a cache for this build, the struct sizes throw away one written by a different one
+struct demoIndexHeader_t {
+	int		ident;
+	int		version;
+	int		demoLength;
+	int		snapshotSize;
+	int		entitySize;
+	int		gameStateSize;
+	int		numKeyframes;
+};
+
+// Everything CL_ParseServerMessage needs to carry on reading from fileOffset. The data holds the gameState, the
+//	server commands the cgame hadn't executed yet, and every snapshot a later message may delta from with its entities
+struct demoKeyframe_t {
+	int		gamestateNum;			// gamestate of the demo this belongs to, the baselines differ between them
+	int		serverTime;
+	int		fileOffset;				// start of the next message
+	int		serverMessageSequence;
+	int		serverCommandSequence;
+	int		lastExecutedServerCommand;
+	int		numSnapshots;
+	int		numEntities;
+	int		dataSize;
+};
+
+struct demoIndexKeyframe_t {
+	demoKeyframe_t		info;
+	std::vector<byte>	data;
+};
+
+static struct {
+	bool								active;
+	bool								dirty;
+	char								path[MAX_QPATH];
+	int									demoLength;
+	int									gamestateNum;		// counts the gamestates parsed, -1 before the first
+	std::vector<demoIndexKeyframe_t>	keyframes;			// sorted on gamestateNum, then serverTime
+} demoIndex;
+
+// Checks that everything CL_DemoIndex_Restore reads from the keyframe stays inside its data and the client's arrays,
+//	the sidecar is read back from disk and may be corrupt or left over from another build of the demo
+static bool CL_DemoIndex_ValidKeyframe( const demoKeyframe_t *info, const byte *data, int demoLength ) {
+	const int numCommands = info->serverCommandSequence - info->lastExecutedServerCommand;
+
+	if ( info->gamestateNum < 0 || info->fileOffset < 0 || info->fileOffset > demoLength ) {
+		return false;
+	}
+	if ( numCommands < 0 || numCommands > MAX_RELIABLE_COMMANDS ) {
+		return false;
+	}
+	if ( info->numSnapshots < 0 || info->numSnapshots > PACKET_BACKUP
+		|| info->numEntities < 0 || info->numEntities > MAX_PARSE_ENTITIES ) {
+		return false;
+	}
+
+	const int64_t expectedSize = (int64_t)sizeof( gameState_t ) + (int64_t)numCommands * MAX_STRING_CHARS
+		+ (int64_t)info->numSnapshots * sizeof( clSnapshot_t ) + (int64_t)info->numEntities * sizeof( entityState_t );
+	if ( info->dataSize != expectedSize ) {
+		return false;
+	}
+
+	gameState_t gameState;
+	Com_Memcpy( &gameState, data, sizeof( gameState ) );
+	if ( gameState.dataCount < 1 || gameState.dataCount > MAX_GAMESTATE_CHARS
+		|| gameState.stringData[gameState.dataCount - 1] != '\0' ) {
+		return false;
+	}
+	for ( int i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		if ( gameState.stringOffsets[i] < 0 || gameState.stringOffsets[i] >= gameState.dataCount ) {
+			return false;
+		}
+	}
+
+	const byte *p = data + sizeof( gameState_t ) + numCommands * MAX_STRING_CHARS;
+	for ( int i = 0 ; i < info->numSnapshots ; i++, p += sizeof( clSnapshot_t ) ) {
+		clSnapshot_t snap;
+
+		Com_Memcpy( &snap, p, sizeof( snap ) );
+		if ( snap.numEntities < 0 || snap.numEntities > MAX_SNAPSHOT_ENTITIES || snap.parseEntitiesNum < 0
+			|| snap.parseEntitiesNum > info->numEntities - snap.numEntities ) {
+			return false;
+		}
+		if ( snap.ps.clientNum < 0 || snap.ps.clientNum >= MAX_CLIENTS ) {
+			return false;
+		}
+	}
+
+	for ( int i = 0 ; i < info->numEntities ; i++, p += sizeof( entityState_t ) ) {
+		entityState_t ent;
+
+		Com_Memcpy( &ent, p, sizeof( ent ) );
+		if ( ent.number < 0 || ent.number >= MAX_GENTITIES ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void CL_DemoIndex_Load( void ) {
+	byte				*buffer;
+	demoIndexHeader_t	header;
+	long				len;
+	long				offset;
+	bool				valid;
+
+	len = FS_ReadFile( demoIndex.path, (void **)&buffer );
+	if ( !buffer ) {
+		return;
+	}
+
+	if ( len < (long)sizeof( header ) ) {
+		FS_FreeFile( buffer );
+		return;
+	}
+
+	Com_Memcpy( &header, buffer, sizeof( header ) );
+	if ( header.ident != DEMO_INDEX_IDENT || header.version != DEMO_INDEX_VERSION
+		|| header.demoLength != demoIndex.demoLength || header.snapshotSize != (int)sizeof( clSnapshot_t )
+		|| header.entitySize != (int)sizeof( entityState_t ) || header.gameStateSize != (int)sizeof( gameState_t ) ) {
+		Com_DPrintf( "Ignoring stale demo index %s\n", demoIndex.path );
+		FS_FreeFile( buffer );
+		return;
+	}
+
+	valid = ( header.numKeyframes >= 0 );
+	offset = sizeof( header );
+	for ( int i = 0 ; valid && i < header.numKeyframes ; i++ ) {
+		demoIndexKeyframe_t	keyframe;
+
+		if ( offset + (long)sizeof( keyframe.info ) > len ) {
+			valid = false;
+			break;
+		}
+		Com_Memcpy( &keyframe.info, buffer + offset, sizeof( keyframe.info ) );
+		offset += sizeof( keyframe.info );
+
+		if ( keyframe.info.dataSize < 0 || offset + keyframe.info.dataSize > len
+			|| !CL_DemoIndex_ValidKeyframe( &keyframe.info, buffer + offset, demoIndex.demoLength ) ) {
+			valid = false;
+			break;
+		}
+
+		// CL_DemoIndex_UpperBound relies on the order they were written in
+		if ( !demoIndex.keyframes.empty() ) {
+			const demoKeyframe_t &last = demoIndex.keyframes.back().info;
+
+			if ( keyframe.info.gamestateNum < last.gamestateNum
+				|| ( keyframe.info.gamestateNum == last.gamestateNum && keyframe.info.serverTime <= last.serverTime ) ) {
+				valid = false;
+				break;
+			}
+		}
+
+		keyframe.data.assign( buffer + offset, buffer + offset + keyframe.info.dataSize );
+		offset += keyframe.info.dataSize;
+
+		demoIndex.keyframes.push_back( std::move( keyframe ) );
+	}
+
+	FS_FreeFile( buffer );
+
+	// playback rebuilds the keyframes and writes a good index over this one
+	if ( !valid || offset != len ) {
+		Com_Printf( S_COLOR_YELLOW "WARNING: ignoring corrupt demo index %s\n", demoIndex.path );
+		std::vector<demoIndexKeyframe_t>().swap( demoIndex.keyframes );
+		return;
+	}
+
+	Com_DPrintf( "Loaded %i demo keyframes from %s\n", (int)demoIndex.keyframes.size(), demoIndex.path );
+}
+
+static void CL_DemoIndex_Write( void ) {
+	demoIndexHeader_t	header;
+	fileHandle_t		f;
+
+	f = FS_FOpenFileWrite( demoIndex.path );
+	if ( !f ) {
+		Com_Printf( S_COLOR_YELLOW "WARNING: couldn't write demo index %s\n", demoIndex.path );
+		return;
+	}
+
+	header.ident = DEMO_INDEX_IDENT;
+	header.version = DEMO_INDEX_VERSION;
+	header.demoLength = demoIndex.demoLength;
+	header.snapshotSize = sizeof( clSnapshot_t );
+	header.entitySize = sizeof( entityState_t );
+	header.gameStateSize = sizeof( gameState_t );
+	header.numKeyframes = (int)demoIndex.keyframes.size();
+	FS_Write( &header, sizeof( header ), f );
+
+	for ( const demoIndexKeyframe_t &keyframe : demoIndex.keyframes ) {
+		FS_Write( &keyframe.info, sizeof( keyframe.info ), f );
+		FS_Write( keyframe.data.data(), keyframe.info.dataSize, f );
+	}
+
+	FS_FCloseFile( f );
+}
+
+// Called when the demo file is opened, before its gamestate is parsed
+void CL_DemoIndex_Open( const char *demoName, int demoLength ) {
+	CL_DemoIndex_Close();
+
+	if ( !cl_demoIndex->integer ) {
+		return;
+	}
+
+	Com_sprintf( demoIndex.path, sizeof( demoIndex.path ), "%s.idx", demoName );
+	demoIndex.demoLength = demoLength;
+	demoIndex.gamestateNum = -1;
+	demoIndex.active = true;
+
+	CL_DemoIndex_Load();
+}
+
+// Called when the demo file is closed, the index is written out if playback got further than it covered
+void CL_DemoIndex_Close( void ) {
+	if ( demoIndex.active && demoIndex.dirty ) {
+		CL_DemoIndex_Write();
+	}
+
+	demoIndex.active = false;
+	demoIndex.dirty = false;
+	std::vector<demoIndexKeyframe_t>().swap( demoIndex.keyframes );
+}
+
+void CL_DemoIndex_Gamestate( void ) {
+	if ( demoIndex.active ) {
+		demoIndex.gamestateNum++;
+	}
+}
+
+// the first keyframe of the current gamestate past the ones at or before serverTime
+static std::vector<demoIndexKeyframe_t>::iterator CL_DemoIndex_UpperBound( int serverTime ) {
+	auto it = demoIndex.keyframes.begin();
+
+	while ( it != demoIndex.keyframes.end() && ( it->info.gamestateNum < demoIndex.gamestateNum
+		|| ( it->info.gamestateNum == demoIndex.gamestateNum && it->info.serverTime <= serverTime ) ) ) {
+		++it;
+	}
+
+	return it;
+}
+
+static void CL_DemoIndex_Append( std::vector<byte> &data, const void *p, size_t size ) {
+	data.insert( data.end(), (const byte *)p, (const byte *)p + size );
+}
+
+// Called after every demo message, keeps a keyframe every cl_demoIndexInterval seconds past what the index covers
+void CL_DemoIndex_Update( void ) {
+	demoIndexKeyframe_t	keyframe;
+	int					firstMessage, firstCommand;
+	const int			interval = (int)( Q_max( 1.0f, cl_demoIndexInterval->value ) * 1000 );
+
+	if ( !demoIndex.active || !cl.snap.valid || cl.snap.messageNum != clc.serverMessageSequence ) {
+		return;
+	}
+
+	// only keep going past the last keyframe of this gamestate
+	auto next = CL_DemoIndex_UpperBound( cl.snap.serverTime );
+	if ( next != demoIndex.keyframes.end() && next->info.gamestateNum == demoIndex.gamestateNum ) {
+		return;
+	}
+	if ( next != demoIndex.keyframes.begin() ) {
+		const demoIndexKeyframe_t &last = *( next - 1 );
+
+		if ( last.info.gamestateNum == demoIndex.gamestateNum && cl.snap.serverTime < last.info.serverTime + interval ) {
+			return;
+		}
+	}
+
+	// the server deltas from the last snapshot we acknowledged, which never goes backwards, so messages after this one
+	//	only need the snapshots from this one's delta onwards
+	firstMessage = ( cl.snap.deltaNum > 0 ) ? cl.snap.deltaNum : cl.snap.messageNum;
+	if ( cl.snap.messageNum - firstMessage >= DEMO_INDEX_MAX_DELTA ) {
+		return;
+	}
+
+	firstCommand = Q_max( clc.lastExecutedServerCommand, clc.serverCommandSequence - MAX_RELIABLE_COMMANDS );
+
+	keyframe.info.gamestateNum = demoIndex.gamestateNum;
+	keyframe.info.serverTime = cl.snap.serverTime;
+	keyframe.info.fileOffset = FS_FTell( clc.demofile );
+	keyframe.info.serverMessageSequence = clc.serverMessageSequence;
+	keyframe.info.serverCommandSequence = clc.serverCommandSequence;
+	keyframe.info.lastExecutedServerCommand = firstCommand;
+	keyframe.info.numSnapshots = 0;
+	keyframe.info.numEntities = 0;
+
+	CL_DemoIndex_Append( keyframe.data, &cl.gameState, sizeof( cl.gameState ) );
+
+	for ( int i = firstCommand + 1 ; i <= clc.serverCommandSequence ; i++ ) {
+		CL_DemoIndex_Append( keyframe.data, clc.serverCommands[i & ( MAX_RELIABLE_COMMANDS - 1 )], MAX_STRING_CHARS );
+	}
+
+	// snapshots point into the entities stored after them
+	for ( int i = firstMessage ; i <= cl.snap.messageNum ; i++ ) {
+		clSnapshot_t snap = cl.snapshots[i & PACKET_MASK];
+
+		if ( !snap.valid || snap.messageNum != i ) {
+			continue;
+		}
+		snap.parseEntitiesNum = keyframe.info.numEntities;
+		CL_DemoIndex_Append( keyframe.data, &snap, sizeof( snap ) );
+		keyframe.info.numSnapshots++;
+		keyframe.info.numEntities += snap.numEntities;
+	}
+
+	for ( int i = firstMessage ; i <= cl.snap.messageNum ; i++ ) {
+		const clSnapshot_t *snap = &cl.snapshots[i & PACKET_MASK];
+
+		if ( !snap->valid || snap->messageNum != i ) {
+			continue;
+		}
+		for ( int j = 0 ; j < snap->numEntities ; j++ ) {
+			CL_DemoIndex_Append( keyframe.data, &cl.parseEntities[( snap->parseEntitiesNum + j ) & ( MAX_PARSE_ENTITIES - 1 )], sizeof( entityState_t ) );
+		}
+	}
+
+	keyframe.info.dataSize = (int)keyframe.data.size();
+
+	demoIndex.keyframes.insert( next, std::move( keyframe ) );
+	demoIndex.dirty = true;
+}
+
+// Puts the client state back to where it was when the keyframe was taken, the next demo message read follows it
+static void CL_DemoIndex_Restore( const demoIndexKeyframe_t &keyframe ) {
+	const byte			*p = keyframe.data.data();
+	const clSnapshot_t	*snapshots;
+	const entityState_t	*entities;
+
+	FS_Seek( clc.demofile, keyframe.info.fileOffset, FS_SEEK_SET );
+
+	Com_Memcpy( &cl.gameState, p, sizeof( cl.gameState ) );
+	p += sizeof( cl.gameState );
+
+	for ( int i = keyframe.info.lastExecutedServerCommand + 1 ; i <= keyframe.info.serverCommandSequence ; i++ ) {
+		Q_strncpyz( clc.serverCommands[i & ( MAX_RELIABLE_COMMANDS - 1 )], (const char *)p, MAX_STRING_CHARS );
+		p += MAX_STRING_CHARS;
+	}
+	clc.serverCommandSequence = keyframe.info.serverCommandSequence;
+	clc.lastExecutedServerCommand = keyframe.info.lastExecutedServerCommand;
+	clc.serverMessageSequence = keyframe.info.serverMessageSequence;
+
+	snapshots = (const clSnapshot_t *)p;
+	entities = (const entityState_t *)( snapshots + keyframe.info.numSnapshots );
+
+	Com_Memset( cl.snapshots, 0, sizeof( cl.snapshots ) );
+	cl.parseEntitiesNum = 0;
+	for ( int i = 0 ; i < keyframe.info.numSnapshots ; i++ ) {
+		clSnapshot_t snap = snapshots[i];
+
+		for ( int j = 0 ; j < snap.numEntities ; j++ ) {
+			cl.parseEntities[( cl.parseEntitiesNum + j ) & ( MAX_PARSE_ENTITIES - 1 )] = entities[snap.parseEntitiesNum + j];
+		}
+		snap.parseEntitiesNum = cl.parseEntitiesNum;
+		cl.parseEntitiesNum += snap.numEntities;
+
+		cl.snapshots[snap.messageNum & PACKET_MASK] = snap;
+		cl.snap = snap;
+	}
+	cl.newSnapshots = false;
+}
+
+// does what the cgame would have done with the commands that came in while skipping, so cl.gameState is current
+static void CL_DemoIndex_ExecuteCommands( void ) {
+	int i = Q_max( clc.lastExecutedServerCommand, clc.serverCommandSequence - MAX_RELIABLE_COMMANDS ) + 1;
+
+	for ( ; i <= clc.serverCommandSequence ; i++ ) {
+		CL_GetServerCommand( i );
+	}
+	clc.lastExecutedServerCommand = clc.serverCommandSequence;
+}
+
+/*
+demoseek <seconds | mm:ss | +seconds | -seconds>
+
+Jumps to a time from the start of the current map in the demo, or relative to now with a sign. Goes back to the
+nearest keyframe at or before the time and reads the demo up to it without running the cgame, then restarts the cgame
+there like a level load.
+*/
+void CL_DemoSeek_f( void ) {
+	const char	*arg, *colon;
+	int			target;
+	const int	gamestateNum = demoIndex.gamestateNum;
+
+	if ( Cmd_Argc() != 2 ) {
+		Com_Printf( "demoseek <seconds | mm:ss | +seconds | -seconds>\n" );
+		return;
+	}
+
+	if ( !clc.demoplaying || cls.state != CA_ACTIVE ) {
+		Com_Printf( "Not playing a demo.\n" );
+		return;
+	}
+	if ( !demoIndex.active ) {
+		Com_Printf( "Demo seeking needs cl_demoIndex 1 when the demo is started.\n" );
+		return;
+	}
+	if ( timedemo->integer ) {
+		Com_Printf( "Can't seek in a timedemo.\n" );
+		return;
+	}
+	if ( CL_VideoRecording() ) {
+		Com_Printf( "Can't seek while recording video.\n" );
+		return;
+	}
+
+	// the first snapshot of every gamestate is always a keyframe
+	auto first = CL_DemoIndex_UpperBound( INT_MIN );
+	if ( first == demoIndex.keyframes.end() || first->info.gamestateNum != gamestateNum ) {
+		Com_Printf( "Demo index has no keyframes for this map.\n" );
+		return;
+	}
+
+	arg = Cmd_Argv( 1 );
+	colon = strchr( arg, ':' );
+	if ( arg[0] == '+' || arg[0] == '-' ) {
+		target = cl.serverTime + (int)( atof( arg ) * 1000 );
+	} else if ( colon ) {
+		target = first->info.serverTime + ( atoi( arg ) * 60 + atoi( colon + 1 ) ) * 1000;
+	} else {
+		target = first->info.serverTime + (int)( atof( arg ) * 1000 );
+	}
+	target = Q_max( target, first->info.serverTime );
+
+	auto keyframe = CL_DemoIndex_UpperBound( target ) - 1;
+	if ( target < cl.snap.serverTime || keyframe->info.serverTime > cl.snap.serverTime ) {
+		CL_DemoIndex_Restore( *keyframe );
+	}
+
+	// read up to the target, nothing is rendered for the messages in between
+	while ( cl.snap.serverTime < target ) {
+		CL_ReadDemoMessage();
+
+		// the end of the demo or a new map take their usual paths
+		if ( !clc.demoplaying || cls.state != CA_ACTIVE || demoIndex.gamestateNum != gamestateNum ) {
+			return;
+		}
+
+		CL_DemoIndex_ExecuteCommands();
+	}
+	CL_DemoIndex_ExecuteCommands();
+
+	// time may have gone backwards
+	cl.serverTime = cl.oldServerTime = cl.oldFrameServerTime = cl.snap.serverTime;
+
+	// restart the cgame at the new snapshot, as after a gamestate
+	cls.state = CA_LOADING;
+	CL_FlushMemory();
+	cls.cgameStarted = true;
+	CL_InitCGame();
+	clc.firstDemoFrameSkipped = false;
+}
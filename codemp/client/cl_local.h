@@ -152,6 +152,7 @@ void CL_ReadDemoMessage(void);
 void CL_SendCmd(void);
 void CL_ServerInfoPacket(netadr_t from, msg_t* msg);
 void CL_SetCGameTime(void);
+void CL_QueueAVIVideoFrame(const byte* imageBuffer, int size);
 void CL_SetUserCmdValue(int userCmdValue, float sensitivityScale, float mPitchOverride, float mYawOverride, float mSensitivityOverride, int fpSel, int invenSel);
 void CL_ShutdownInput(void);
 void CL_Snd_Restart_f(void);
@@ -159,7 +160,6 @@ void CL_StartHunkUsers(void);
 void CL_SystemInfoChanged(void);
 void CL_TakeVideoFrame(void);
 void CL_Vid_Restart_f(void);
-void CL_WriteAVIVideoFrame(const byte* imageBuffer, int size);
 void CL_WritePacket(void);
 void Con_Bottom(void);
 void Con_CheckResize(void);
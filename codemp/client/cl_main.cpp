@@ -25,11 +25,14 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 // cl_main.c  -- client main loop
 
+#include "client/cl_bench.h"
 #include "client/cl_cgameapi.h"
+#include "client/cl_demoindex.h"
 #include "client/cl_keys.h"
 #include "client/cl_lan.h"
 #include "client/cl_local.h"
 #include "client/cl_uiapi.h"
+#include "client/FxUtil.h"
 #include "client/snd_public.h"
 #include "ghoul2/G2.h"
 #include "qcommon/cm_public.h"
@@ -286,6 +289,8 @@ void CL_DemoCompleted( void ) {
 		}
 	}
 
+	CL_Bench_Finish();
+
 /*	CL_Disconnect( true );
 	CL_NextDemo();
 	*/
@@ -346,6 +351,8 @@ void CL_ReadDemoMessage( void ) {
 	clc.lastPacketTime = cls.realtime;
 	buf.readcount = 0;
 	CL_ParseServerMessage( &buf );
+
+	CL_DemoIndex_Update();
 }
 
 static void CL_CompleteDemoName( char *args, int argNum )
@@ -363,6 +370,7 @@ static void CL_CompleteDemoName( char *args, int argNum )
 void CL_PlayDemo_f( void ) {
 	char		name[MAX_OSPATH], extension[32];
 	char		*arg;
+	long		len;
 
 	if (Cmd_Argc() != 2) {
 		Com_Printf ("demo <demoname>\n");
@@ -385,7 +393,7 @@ void CL_PlayDemo_f( void ) {
 		Com_sprintf (name, sizeof(name), "demos/%s.dm_%d", arg, PROTOCOL_VERSION);
 	}
 
-	FS_FOpenFileRead( name, &clc.demofile, true );
+	len = FS_FOpenFileRead( name, &clc.demofile, true );
 	if (!clc.demofile) {
 		if (!Q_stricmp(arg, "(null)"))
 		{
@@ -399,6 +407,8 @@ void CL_PlayDemo_f( void ) {
 	}
 	Q_strncpyz( clc.demoName, Cmd_Argv(1), sizeof( clc.demoName ) );
 
+	CL_DemoIndex_Open( name, (int)len );
+
 	Con_Close();
 
 	cls.state = CA_CONNECTED;
@@ -628,6 +638,9 @@ void CL_Disconnect( bool showMainMenu ) {
 		return;
 	}
 
+	// a benchmark can only report on a demo that played to the end
+	CL_Bench_Abort();
+
 	// shutting down the client so enter full screen ui mode
 	Cvar_Set("r_uiFullScreen", "1");
 
@@ -643,6 +656,7 @@ void CL_Disconnect( bool showMainMenu ) {
 	Cvar_Set( "cl_downloadName", "" );
 
 	if ( clc.demofile ) {
+		CL_DemoIndex_Close();
 		FS_FCloseFile( clc.demofile );
 		clc.demofile = 0;
 	}
@@ -1799,6 +1813,8 @@ void CL_Frame ( int msec ) {
 		return;
 	}
 
+	CL_Bench_Start( BENCH_FRAME );
+
 	SE_CheckForLanguageUpdates();	// will take zero time to execute unless language changes, then will reload strings.
 									//	of course this still doesn't work for menus...
 
@@ -1866,7 +1882,9 @@ void CL_Frame ( int msec ) {
 	SCR_UpdateScreen();
 
 	// update audio
+	CL_Bench_Start( BENCH_SOUND );
 	S_Update();
+	CL_Bench_Stop( BENCH_SOUND );
 
 	// advance local effects for next frame
 	SCR_RunCinematic();
@@ -1885,6 +1903,9 @@ void CL_Frame ( int msec ) {
 		// save the current screen
 		CL_TakeVideoFrame( );
 	}
+
+	CL_Bench_Stop( BENCH_FRAME );
+	CL_Bench_EndFrame();
 }
 
 // DLL glue
@@ -2072,7 +2093,7 @@ void CL_InitRef( void ) {
 	ri.CIN_RunCinematic = CIN_RunCinematic;
 	ri.CIN_PlayCinematic = CIN_PlayCinematic;
 	ri.CIN_UploadCinematic = CIN_UploadCinematic;
-	ri.CL_WriteAVIVideoFrame = CL_WriteAVIVideoFrame;
+	ri.CL_QueueAVIVideoFrame = CL_QueueAVIVideoFrame;
 
 	// g2 data access
 	ri.GetSharedMemory = GetSharedMemory;
@@ -2326,6 +2347,7 @@ void CL_Init( void ) {
 	Cmd_AddCommand ("record", CL_Record_f, "Record a demo" );
 	Cmd_AddCommand ("demo", CL_PlayDemo_f, "Playback a demo" );
 	Cmd_SetCommandCompletionFunc( "demo", CL_CompleteDemoName );
+	Cmd_AddCommand ("demoseek", CL_DemoSeek_f, "Jump to a time in the demo being played" );
 	Cmd_AddCommand ("stoprecord", CL_StopRecord_f, "Stop recording a demo" );
 	Cmd_AddCommand ("configstrings", CL_Configstrings_f, "Prints the configstrings list" );
 	Cmd_AddCommand ("clientinfo", CL_Clientinfo_f, "Prints the userinfo variables" );
@@ -2347,6 +2369,8 @@ void CL_Init( void ) {
 	Cmd_AddCommand ("forcepowers", CL_SetForcePowers_f );
 	Cmd_AddCommand ("video", CL_Video_f, "Record demo to avi" );
 	Cmd_AddCommand ("stopvideo", CL_StopVideo_f, "Stop avi recording" );
+	Cmd_AddCommand ("fx_schedulerBench", FX_SchedulerBench_f, "Benchmark the effect scheduler queue" );
+	Cmd_AddCommand ("benchmark", CL_Bench_f, "Play a timedemo and record per-frame client, cgame, fx, sound and renderer times" );
 
 	CL_InitRef();
 
@@ -2397,6 +2421,7 @@ void CL_Shutdown( void ) {
 	Cmd_RemoveCommand ("disconnect");
 	Cmd_RemoveCommand ("record");
 	Cmd_RemoveCommand ("demo");
+	Cmd_RemoveCommand ("demoseek");
 	Cmd_RemoveCommand ("cinematic");
 	Cmd_RemoveCommand ("stoprecord");
 	Cmd_RemoveCommand ("connect");
@@ -2414,6 +2439,8 @@ void CL_Shutdown( void ) {
 	Cmd_RemoveCommand ("forcepowers");
 	Cmd_RemoveCommand ("video");
 	Cmd_RemoveCommand ("stopvideo");
+	Cmd_RemoveCommand ("fx_schedulerBench");
+	Cmd_RemoveCommand ("benchmark");
 
 	CL_ShutdownInput();
 	Con_Shutdown();
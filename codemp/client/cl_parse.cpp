@@ -27,6 +27,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "client/cl_local.h"
 #include "client/cl_cgameapi.h"
+#include "client/cl_demoindex.h"
 #include "qcommon/stringed_ingame.h"
 #include "qcommon/com_cvar.h"
 
@@ -451,6 +452,9 @@ void CL_ParseGamestate( msg_t *msg ) {
 	// wipe local client state
 	CL_ClearState();
 
+	// a new map in a demo starts a new set of keyframes
+	CL_DemoIndex_Gamestate();
+
 	// a gamestate always marks a server command sequence
 	clc.serverCommandSequence = MSG_ReadLong( msg );
 
@@ -25,6 +25,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 // cl_scrn.c -- master for refresh, status bar, console, chat, notify, etc
 
+#include "client/cl_bench.h"
 #include "client/cl_local.h"
 #include "client/cl_uiapi.h"
 #include "client/snd_public.h"
@@ -398,11 +399,13 @@ void SCR_UpdateScreen( void ) {
 			SCR_DrawScreenField( STEREO_CENTER );
 		}
 
+		CL_Bench_Start( BENCH_ENDFRAME );
 		if ( com_speeds->integer ) {
 			re->EndFrame( &time_frontend, &time_backend );
 		} else {
 			re->EndFrame( nullptr, nullptr );
 		}
+		CL_Bench_Stop( BENCH_ENDFRAME );
 	}
 
 	recursive = 0;
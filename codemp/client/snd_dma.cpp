@@ -383,6 +383,7 @@ void S_Init( void ) {
 	Cmd_AddCommand("soundstop", S_StopAllSounds, "Stops all sounds including music" );
 	Cmd_AddCommand("mp3_calcvols", S_MP3_CalcVols_f);
 	Cmd_AddCommand("s_dynamic", S_SetDynamicMusic_f, "Change dynamic music state" );
+	Cmd_AddCommand("s_mixBench", S_MixBench_f, "Checks the sound mixer against the reference and times it" );
 
 #ifdef USE_OPENAL
 
@@ -528,6 +529,11 @@ void S_Init( void ) {
 	}
 #endif
 
+	if ( s_soundStarted ) {
+		MP3Stream_InitAsync();
+		S_InitSoundLoader();
+	}
+
 	Com_Printf("------------------------------------\n");
 
 	Com_Printf("\n--- ambient sound initialization ---\n");
@@ -559,6 +565,8 @@ void S_Shutdown( void )
 		return;
 	}
 
+	MP3Stream_ShutdownAsync();
+	S_ShutdownSoundLoader();
 	S_FreeAllSFXMem();
 	S_UnCacheDynamicMusic();
 
@@ -622,6 +630,7 @@ void S_Shutdown( void )
 	Cmd_RemoveCommand("soundstop");
 	Cmd_RemoveCommand("mp3_calcvols");
 	Cmd_RemoveCommand("s_dynamic");
+	Cmd_RemoveCommand("s_mixBench");
 	AS_Free();
 }
 
@@ -889,7 +898,12 @@ sfxHandle_t	S_RegisterSound( const char *name)
 
 	sfx->bInMemory = false;
 
-	S_memoryLoad(sfx);
+	// the decode carries on in the background, anything wanting to play it first waits in S_memoryLoad()
+	if ( !S_LoadSound( sfx, true ) )
+	{
+		sfx->bDefaultSound = true;
+	}
+	sfx->bInMemory = !sfx->pLoadJob;
 
 	if ( sfx->bDefaultSound ) {
 #ifndef FINAL_BUILD
@@ -906,6 +920,12 @@ sfxHandle_t	S_RegisterSound( const char *name)
 
 void S_memoryLoad(sfx_t	*sfx)
 {
+	if ( sfx->pLoadJob )
+	{
+		S_FinishSoundLoad( sfx );
+		return;
+	}
+
 	// load the sound file...
 	if ( !S_LoadSound( sfx ) )
 	{
@@ -2449,7 +2469,13 @@ void S_Update( void ) {
 	int			total;
 	channel_t	*ch;
 
-	if ( !s_soundStarted || s_soundMuted ) {
+	if ( !s_soundStarted ) {
+		return;
+	}
+
+	S_UpdateSoundLoads( false );
+
+	if ( s_soundMuted ) {
 		return;
 	}
 
@@ -2664,7 +2690,9 @@ void S_Update_(void) {
 
 					for (j = 0; j < (STREAMING_BUFFER_SIZE / 1152); j++)
 					{
+						MP3_LockDecoder();
 						nBytesDecoded = C_MP3Stream_Decode(&ch->MP3StreamHeader, 0);	// added ,0 ?
+						MP3_UnlockDecoder();
 						memcpy(ch->buffers[i].Data + nTotalBytesDecoded, ch->MP3StreamHeader.bDecodeBuffer, nBytesDecoded);
 						if (ch->entchannel == CHAN_VOICE || ch->entchannel == CHAN_VOICE_ATTEN || ch->entchannel == CHAN_VOICE_GLOBAL )
 						{
@@ -2901,7 +2929,9 @@ void UpdateSingleShotSounds()
 
 							for (k = 0; k < (STREAMING_BUFFER_SIZE / 1152); k++)
 							{
+								MP3_LockDecoder();
 								nBytesDecoded = C_MP3Stream_Decode(&ch->MP3StreamHeader, 0); // added ,0
+								MP3_UnlockDecoder();
 
 								if (nBytesDecoded > 0)
 								{
@@ -3738,6 +3768,7 @@ static void FreeMusic( MusicInfo_t *pMusicInfo )
 {
 	if (pMusicInfo->pLoadedData)
 	{
+		MP3Stream_FlushAsync( pMusicInfo->pLoadedData );
 		Z_Free(pMusicInfo->pLoadedData);
 		pMusicInfo->pLoadedData		= nullptr;		// these two MUST be kept as valid/invalid together
 		pMusicInfo->sLoadedDataName[0]= '\0';	//
@@ -3831,11 +3862,13 @@ static bool S_StartBackgroundTrack_Actual( MusicInfo_t *pMusicInfo, bool qbDynam
 		{
 			// init stream struct...
 			memset(&pMusicInfo->streamMP3_Bgrnd,0,sizeof(pMusicInfo->streamMP3_Bgrnd));
+			MP3_LockDecoder();
 			char *psError = C_MP3Stream_DecodeInit( &pMusicInfo->streamMP3_Bgrnd, pbMP3DataSegment, pMusicInfo->iLoadedDataLen,
 													dma.speed,
 													16,		// sfx->width * 8,
 													true	// bStereoDesired
 													);
+			MP3_UnlockDecoder();
 
 			if (psError == nullptr)
 			{
@@ -4393,7 +4426,7 @@ static bool S_UpdateBackgroundTrack_Actual( MusicInfo_t *pMusicInfo, bool bFirst
 
 				pMusicInfo->chMP3_Bgrnd.MP3StreamHeader.pbSourceData = pbScrolledStreamData - pMusicInfo->chMP3_Bgrnd.MP3StreamHeader.iSourceReadIndex;
 
-				qbForceFinish = (MP3Stream_GetSamples( &pMusicInfo->chMP3_Bgrnd, iStartingSampleNum, fileBytes/2, (short*) raw, true ))?false:true;
+				qbForceFinish = (MP3Stream_GetSamples( &pMusicInfo->chMP3_Bgrnd, iStartingSampleNum, fileBytes/2, (short*) raw, true, false ))?false:true;
 			}
 		}
 		else
@@ -4692,6 +4725,8 @@ static int SND_FreeSFXMem(sfx_t *sfx)
 {
 	int iBytesFreed = 0;
 
+	S_FinishSoundLoad(sfx);
+
 #ifdef USE_OPENAL
 	if (s_useOpenAL->integer)
 	{
@@ -4718,6 +4753,9 @@ static int SND_FreeSFXMem(sfx_t *sfx)
 #endif
 
 	if (						sfx->pSoundData) {
+		if (sfx->pMP3StreamHeader) {
+			MP3Stream_FlushAsync( sfx->pSoundData );
+		}
 		iBytesFreed +=	Z_Size(	sfx->pSoundData);
 						Z_Free(	sfx->pSoundData );
 								sfx->pSoundData = nullptr;
@@ -4847,6 +4885,10 @@ bool SND_RegisterAudio_LevelLoadEnd(bool bDeleteEverythingNotUsedThisLevel /* 99
 	}
 	else
 	{
+		// finishing a load frees and allocates, which mustn't happen under a failing S_LoadSound allocation. Sounds
+		//	still loading aren't bInMemory, so the loop below leaves them alone either way
+		S_UpdateSoundLoads( true );
+
 		int iLoadedAudioBytes	 = Z_MemSize ( TAG_SND_RAWDATA ) + Z_MemSize( TAG_SND_MP3STREAMHDR );
 		const int iMaxAudioBytes = s_soundpoolmegs->integer * 1024 * 1024;
 
@@ -66,6 +66,8 @@ struct portable_samplepair_t {
 	int			right;
 };
 
+struct sndLoadJob_t;
+
 struct sfx_t {
 	short			*pSoundData;
 	bool			bDefaultSound;			// couldn't be loaded, so use buzz
@@ -77,6 +79,7 @@ struct sfx_t {
 	int				iLastTimeUsed;
 	float			fVolRange;				// used to set the highest volume this sample has at load time - used for lipsynching
 	int				iLastLevelUsedOn;		// used for cacheing purposes
+	sndLoadJob_t	*pLoadJob;				// non-null while the background loader is still decoding this (bInMemory stays false)
 
 	// Open AL
 #ifdef USE_OPENAL
@@ -154,20 +157,25 @@ float S_GetSampleLengthInMilliSeconds(sfxHandle_t sfxHandle);
 int SND_FreeOldestSound(sfx_t *pButNotThisOne = nullptr);
 portable_samplepair_t *S_GetRawSamplePointer();
 bool S_FileExists( const char *psFilename );
-bool S_LoadSound( sfx_t *sfx );
+bool S_LoadSound( sfx_t *sfx, bool bAsync = false );
 sfx_t* S_FindName(const char* name);
 void AS_Free(void);
 void AS_Init(void);
 void S_AddAmbientLoopingSound(const vec3_t origin, unsigned char volume, sfxHandle_t sfxHandle);
 void S_DisplayFreeMemory(void);
+void S_FinishSoundLoad(sfx_t *sfx);
 void S_FreeAllSFXMem(void);
+void S_InitSoundLoader(void);
 void S_memoryLoad(sfx_t *sfx);
 void S_MP3_CalcVols_f(void);
+void S_MixBench_f(void);
 void S_PaintChannels(int endtime);
 void S_StartAmbientSound(const vec3_t origin, int entityNum, unsigned char volume, sfxHandle_t sfxHandle);
 void S_StartLocalLoopingSound(sfxHandle_t sfx);
+void S_ShutdownSoundLoader(void);
 void S_StopSounds(void);
 void S_UnCacheDynamicMusic(void);
+void S_UpdateSoundLoads(bool bWait);
 void S_Update_(void);
 void SND_setup();
 void SND_TouchSFX(sfx_t *sfx);
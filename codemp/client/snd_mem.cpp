@@ -30,7 +30,10 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "qcommon/com_cvars.h"
 
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 
 // WAV loading
 
@@ -178,30 +181,21 @@ wavinfo_t GetWavinfo (const char *name, byte *wav, int wavlength)
 	return info;
 }
 
-// resample / decimate to the current source rate
-void ResampleSfx (sfx_t *sfx, int iInRate, int iInWidth, byte *pData)
+// the resampling loop itself, touches nothing but its args so the background loader can run it
+// returns the max vol (for lip-synching)
+static float ResampleSfx_Work (short *pOut, int iOutCount, float fStepScale, int iInWidth, const byte *pData)
 {
-	int		iOutCount;
 	int		iSrcSample;
-	float	fStepScale;
 	int		i;
 	int		iSample;
+	float	fVolRange;
 	unsigned int uiSampleFrac, uiFracStep;	// uiSampleFrac MUST be unsigned, or large samples (eg music tracks) crash
 
-	fStepScale = (float)iInRate / dma.speed;	// this is usually 0.5, 1, or 2
-
-	// When stepscale is > 1 (we're downsampling), we really ought to run a low pass filter on the samples
-
-	iOutCount = (int)(sfx->iSoundLengthInSamples / fStepScale);
-	sfx->iSoundLengthInSamples = iOutCount;
-
-	sfx->pSoundData = (short *) SND_malloc( sfx->iSoundLengthInSamples*2 ,sfx );
-
-	sfx->fVolRange	= 0;
+	fVolRange		= 0;
 	uiSampleFrac	= 0;
 	uiFracStep		= (int)(fStepScale*256);
 
-	for (i=0 ; i<sfx->iSoundLengthInSamples ; i++)
+	for (i=0 ; i<iOutCount ; i++)
 	{
 		iSrcSample = uiSampleFrac >> 8;
 		uiSampleFrac += uiFracStep;
@@ -211,16 +205,36 @@ void ResampleSfx (sfx_t *sfx, int iInRate, int iInWidth, byte *pData)
 			iSample = (int)( (unsigned char)(pData[iSrcSample]) - 128) << 8;
 		}
 
-		sfx->pSoundData[i] = (short)iSample;
+		pOut[i] = (short)iSample;
 
 		// work out max vol for this sample...
 		if (iSample < 0)
 			iSample = -iSample;
-		if (sfx->fVolRange < (iSample >> 8) )
+		if (fVolRange < (iSample >> 8) )
 		{
-			sfx->fVolRange =  iSample >> 8;
+			fVolRange =  iSample >> 8;
 		}
 	}
+
+	return fVolRange;
+}
+
+// resample / decimate to the current source rate
+void ResampleSfx (sfx_t *sfx, int iInRate, int iInWidth, byte *pData)
+{
+	int		iOutCount;
+	float	fStepScale;
+
+	fStepScale = (float)iInRate / dma.speed;	// this is usually 0.5, 1, or 2
+
+	// When stepscale is > 1 (we're downsampling), we really ought to run a low pass filter on the samples
+
+	iOutCount = (int)(sfx->iSoundLengthInSamples / fStepScale);
+	sfx->iSoundLengthInSamples = iOutCount;
+
+	sfx->pSoundData = (short *) SND_malloc( sfx->iSoundLengthInSamples*2 ,sfx );
+
+	sfx->fVolRange = ResampleSfx_Work( sfx->pSoundData, iOutCount, fStepScale, iInWidth, pData );
 }
 
 void S_LoadSound_Finalize(wavinfo_t	*info, sfx_t *sfx, byte *data)
@@ -648,9 +662,354 @@ static bool S_LoadSound_DirIsAllowedToKeepMP3s(const char *psFilename)
 	return false;
 }
 
+#ifdef USE_OPENAL
+// lip-sync precalc, then hand the samples over to an AL buffer
+static void S_LoadSound_UploadAL( sfx_t *sfx )
+{
+	if (s_useOpenAL->integer)
+	{
+		if ((strstr(sfx->sSoundName, "chars")) || (strstr(sfx->sSoundName, "CHARS")))
+		{
+			sfx->lipSyncData = (char *)Z_Malloc((sfx->iSoundLengthInSamples / 1000) + 1, TAG_SND_RAWDATA, false);
+			S_PreProcessLipSync(sfx);
+		}
+		else
+			sfx->lipSyncData = nullptr;
+
+		// Clear Open AL Error State
+		alGetError();
+
+		// Generate AL Buffer
+		ALuint Buffer;
+		alGenBuffers(1, &Buffer);
+		if (alGetError() == AL_NO_ERROR)
+		{
+			// Copy audio data to AL Buffer
+			alBufferData(Buffer, AL_FORMAT_MONO16, sfx->pSoundData, sfx->iSoundLengthInSamples*2, 22050);
+			if (alGetError() == AL_NO_ERROR)
+			{
+				// Store AL Buffer in sfx struct, and release sample data
+				sfx->Buffer = Buffer;
+				Z_Free(sfx->pSoundData);
+				sfx->pSoundData = nullptr;
+			}
+		}
+	}
+}
+#endif
+
+// ======================================================================
+// background loader
+//
+// S_RegisterSound() only reads and parses the file, then queues the resample (and for small MP3s the unpack) here so
+//	the level load carries on with models and shaders while the loader threads chew through the sounds. The file
+//	system and zone aren't thread safe, so every alloc and free stays on the main thread and the workers only write
+//	into buffers handed to them. A queued sfx_t keeps bInMemory false until it's finished, which sends anything
+//	wanting to play it through S_memoryLoad() to wait for it.
+// ======================================================================
+
+#define MAX_SND_LOAD_THREADS	2
+
+enum {
+	SND_LOAD_QUEUED,
+	SND_LOAD_RUNNING,
+	SND_LOAD_DECODED
+};
+
+struct sndLoadJob_t {
+	sfx_t			*sfx;
+	char			sLoadName[MAX_QPATH];	// for error reporting only
+	byte			*pbFileData;			// from FS_ReadFile
+	int				iFileSize;
+	wavinfo_t		info;
+	float			fStepScale;
+
+	byte			*pbUnpackBuffer;		// MP3s being unpacked to WAV, else nullptr
+	int				iUnpackSize;			// expected, as measured by MP3_GetUnpackedSize()
+	int				iUnpackedBytes;			// actual
+	char			sError[256];
+
+	float			fVolRange;
+	int				state;					// only read/written with sndLoadMutex held
+
+	sndLoadJob_t	*nextQueued;			// sndLoadQueue, waiting for a worker
+	sndLoadJob_t	*nextActive;			// sndLoadActive, everything not yet finished (main thread only)
+};
+
+static std::thread				*sndLoadThreads[MAX_SND_LOAD_THREADS];
+static int						numSndLoadThreads;
+static std::mutex				sndLoadMutex;
+static std::condition_variable	sndLoadWake;
+static std::condition_variable	sndLoadDone;
+static bool						sndLoadQuit;
+static sndLoadJob_t				*sndLoadQueue;
+static sndLoadJob_t				*sndLoadActive;
+
+static void S_LoadSound_Work( sndLoadJob_t *job )
+{
+	const byte *pbPCM;
+
+	if (job->pbUnpackBuffer)
+	{
+		MP3_LockDecoder();
+		const char *psError = C_MP3_UnpackRawPCM( job->pbFileData, job->iFileSize, &job->iUnpackedBytes, job->pbUnpackBuffer, false );
+		if (psError)
+		{
+			Q_strncpyz( job->sError, psError, sizeof(job->sError) );
+			job->iUnpackedBytes = 0;
+		}
+		MP3_UnlockDecoder();
+
+		// a short unpack plays out as silence rather than whatever the zone left there
+		if (job->iUnpackedBytes < job->iUnpackSize)
+		{
+			memset( job->pbUnpackBuffer + job->iUnpackedBytes, 0, job->iUnpackSize - job->iUnpackedBytes );
+		}
+		pbPCM = job->pbUnpackBuffer;
+	}
+	else
+	{
+		pbPCM = job->pbFileData + job->info.dataofs;
+	}
+
+	job->fVolRange = ResampleSfx_Work( job->sfx->pSoundData, job->sfx->iSoundLengthInSamples, job->fStepScale, job->info.width, pbPCM );
+
+#ifdef Q3_BIG_ENDIAN
+	if (job->pbUnpackBuffer)
+	{
+		// see the matching comment in S_LoadSound_Actual()
+		short *pSamples = job->sfx->pSoundData;
+
+		job->fVolRange = 0;
+		for (int i = 0; i < job->sfx->iSoundLengthInSamples; i++)
+		{
+			pSamples[i] = LittleShort(pSamples[i]);
+			if (job->fVolRange < (abs(static_cast<int>(pSamples[i])) >> 8))
+			{
+				job->fVolRange = abs(static_cast<int>(pSamples[i])) >> 8;
+			}
+		}
+	}
+#endif
+}
+
+static void S_LoadSound_WorkerLoop( void )
+{
+	std::unique_lock<std::mutex> lock( sndLoadMutex );
+
+	for ( ;; )
+	{
+		sndLoadWake.wait( lock, [] { return sndLoadQuit || sndLoadQueue; } );
+
+		if ( sndLoadQuit )
+		{
+			return;
+		}
+
+		sndLoadJob_t *job = sndLoadQueue;
+		sndLoadQueue = job->nextQueued;
+		job->state = SND_LOAD_RUNNING;
+
+		lock.unlock();
+		S_LoadSound_Work( job );
+		lock.lock();
+
+		job->state = SND_LOAD_DECODED;
+		sndLoadDone.notify_all();
+	}
+}
+
+// takes ownership of pbFileData, sfx must already have its format fields filled in
+static void S_LoadSound_Queue( sfx_t *sfx, const char *psLoadName, byte *pbFileData, int iFileSize, const wavinfo_t *info, int iUnpackSize )
+{
+	sndLoadJob_t *job = new sndLoadJob_t();
+
+	job->sfx			= sfx;
+	job->pbFileData		= pbFileData;
+	job->iFileSize		= iFileSize;
+	job->info			= *info;
+	job->fStepScale		= (float)info->rate / dma.speed;
+	job->iUnpackSize	= iUnpackSize;
+	Q_strncpyz( job->sLoadName, psLoadName, sizeof(job->sLoadName) );
+
+	if (iUnpackSize)
+	{
+		job->pbUnpackBuffer = (byte *) Z_Malloc( iUnpackSize+10 +2304 /* <g> */, TAG_TEMP_WORKSPACE, false );	// won't return if fails
+	}
+
+	// same sizing as ResampleSfx(), the output buffer has to exist before a worker can fill it...
+	sfx->iSoundLengthInSamples	= (int)(sfx->iSoundLengthInSamples / job->fStepScale);
+	sfx->pSoundData				= (short *) SND_malloc( sfx->iSoundLengthInSamples*2, sfx );
+	sfx->fVolRange				= 0;
+	sfx->pLoadJob				= job;
+
+	job->nextActive	= sndLoadActive;
+	sndLoadActive	= job;
+
+	{
+		std::lock_guard<std::mutex> lock( sndLoadMutex );
+		sndLoadJob_t **ppTail = &sndLoadQueue;
+		while (*ppTail)
+		{
+			ppTail = &(*ppTail)->nextQueued;
+		}
+		*ppTail = job;
+		job->state = SND_LOAD_QUEUED;
+	}
+	sndLoadWake.notify_one();
+}
+
+// main thread half of a decoded job, does everything that needs the zone, file system or AL
+static void S_LoadSound_Finish( sndLoadJob_t *job )
+{
+	sfx_t *sfx = job->sfx;
+
+	if (job->pbUnpackBuffer)
+	{
+		if (job->sError[0])
+		{
+			Com_Printf(S_COLOR_RED"%s\n(File: %s)\n", job->sError, job->sLoadName);
+		}
+		if (job->iUnpackedBytes != job->iUnpackSize)
+		{
+			Com_Printf(S_COLOR_YELLOW"**** MP3 %s final unpack size %d different to previous value %d\n", job->sLoadName, job->iUnpackedBytes, job->iUnpackSize);
+		}
+		Z_Free(job->pbUnpackBuffer);
+	}
+	FS_FreeFile(job->pbFileData);
+
+	sndLoadJob_t **ppActive = &sndLoadActive;
+	while (*ppActive != job)
+	{
+		ppActive = &(*ppActive)->nextActive;
+	}
+	*ppActive = job->nextActive;
+
+	sfx->fVolRange	= job->fVolRange;
+	sfx->pLoadJob	= nullptr;
+	sfx->bInMemory	= true;
+	delete job;
+
+#ifdef USE_OPENAL
+	S_LoadSound_UploadAL(sfx);
+#endif
+}
+
+// blocks until this sfx_t is playable, decoding it right here if no worker has picked it up yet
+void S_FinishSoundLoad( sfx_t *sfx )
+{
+	sndLoadJob_t *job = sfx->pLoadJob;
+
+	if (!job)
+	{
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock( sndLoadMutex );
+
+		if (job->state == SND_LOAD_QUEUED)
+		{
+			sndLoadJob_t **ppQueued = &sndLoadQueue;
+			while (*ppQueued != job)
+			{
+				ppQueued = &(*ppQueued)->nextQueued;
+			}
+			*ppQueued = job->nextQueued;
+			job->state = SND_LOAD_RUNNING;
+
+			lock.unlock();
+			S_LoadSound_Work( job );
+		}
+		else
+		{
+			sndLoadDone.wait( lock, [job] { return job->state == SND_LOAD_DECODED; } );
+		}
+	}
+
+	S_LoadSound_Finish( job );
+}
+
+// finishes whatever the workers have got through, or everything if bWait
+void S_UpdateSoundLoads( bool bWait )
+{
+	while (sndLoadActive)
+	{
+		sndLoadJob_t *job = nullptr;
+
+		if (bWait)
+		{
+			job = sndLoadActive;
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock( sndLoadMutex );
+			for (sndLoadJob_t *test = sndLoadActive; test; test = test->nextActive)
+			{
+				if (test->state == SND_LOAD_DECODED)
+				{
+					job = test;
+					break;
+				}
+			}
+		}
+
+		if (!job)
+		{
+			break;
+		}
+
+		S_FinishSoundLoad( job->sfx );
+	}
+}
+
+void S_InitSoundLoader( void )
+{
+	int count;
+
+	if ( numSndLoadThreads || !s_asyncLoad->integer )
+	{
+		return;
+	}
+
+	// leave a core for the main thread
+	count = Com_Clampi( 0, MAX_SND_LOAD_THREADS, (int)std::thread::hardware_concurrency() - 1 );
+
+	sndLoadQuit = false;
+	for ( int i = 0; i < count; i++ )
+	{
+		sndLoadThreads[i] = new std::thread( S_LoadSound_WorkerLoop );
+	}
+	numSndLoadThreads = count;
+}
+
+void S_ShutdownSoundLoader( void )
+{
+	S_UpdateSoundLoads( true );
+
+	if ( !numSndLoadThreads )
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( sndLoadMutex );
+		sndLoadQuit = true;
+	}
+	sndLoadWake.notify_all();
+
+	for ( int i = 0; i < numSndLoadThreads; i++ )
+	{
+		sndLoadThreads[i]->join();
+		delete sndLoadThreads[i];
+		sndLoadThreads[i] = nullptr;
+	}
+	numSndLoadThreads = 0;
+}
+
 // The filename may be different than sfx->name in the case of a forced fallback of a player specific sound	(or of a wav/mp3 substitution now -Ste)
 bool gbInsideLoadSound = false;
-static bool S_LoadSound_Actual( sfx_t *sfx )
+static bool S_LoadSound_Actual( sfx_t *sfx, bool bAsync )
 {
 	byte	*data;
 	short	*samples;
@@ -719,6 +1078,19 @@ static bool S_LoadSound_Actual( sfx_t *sfx )
 				// small file, not worth keeping as MP3 since it would increase in size (with MP3 header etc)...
 				Com_DPrintf("S_LoadSound: Unpacking MP3 file(%i) \"%s\" to wav(%i).\n",size,sLoadName,iRawPCMDataSize);
 				// unpack and convert into WAV...
+				if (bAsync)
+				{
+					MP3_FakeUpWAVInfo( sLoadName, data, size, iRawPCMDataSize,
+										info.format, info.rate, info.width, info.channels, info.samples, info.dataofs,
+										false
+									);
+
+					sfx->eSoundCompressionMethod = ct_16;
+					sfx->iSoundLengthInSamples	 = info.samples;
+					S_LoadSound_Queue( sfx, sLoadName, data, size, &info, iRawPCMDataSize );
+					return true;
+				}
+				else
 				{
 					byte *pbUnpackBuffer = (byte *) Z_Malloc( iRawPCMDataSize+10 +2304 /* <g> */, TAG_TEMP_WORKSPACE, false );	// won't return if fails
 
@@ -757,36 +1129,8 @@ static bool S_LoadSound_Actual( sfx_t *sfx )
 						}
 #endif
 
-						// Open AL
 #ifdef USE_OPENAL
-						if (s_useOpenAL->integer)
-						{
-							if ((strstr(sfx->sSoundName, "chars")) || (strstr(sfx->sSoundName, "CHARS")))
-							{
-								sfx->lipSyncData = (char *)Z_Malloc((sfx->iSoundLengthInSamples / 1000) + 1, TAG_SND_RAWDATA, false);
-								S_PreProcessLipSync(sfx);
-							}
-							else
-								sfx->lipSyncData = nullptr;
-
-							// Clear Open AL Error state
-							alGetError();
-
-							// Generate AL Buffer
-                            ALuint Buffer;
-							alGenBuffers(1, &Buffer);
-							if (alGetError() == AL_NO_ERROR)
-							{
-								// Copy audio data to AL Buffer
-								alBufferData(Buffer, AL_FORMAT_MONO16, sfx->pSoundData, sfx->iSoundLengthInSamples*2, 22050);
-								if (alGetError() == AL_NO_ERROR)
-								{
-									sfx->Buffer = Buffer;
-									Z_Free(sfx->pSoundData);
-									sfx->pSoundData = nullptr;
-								}
-							}
-						}
+						S_LoadSound_UploadAL(sfx);
 #endif
 
 						Z_Free(pbUnpackBuffer);
@@ -820,6 +1164,14 @@ static bool S_LoadSound_Actual( sfx_t *sfx )
 			Com_Printf(S_COLOR_YELLOW "WARNING: %s is not a 22kHz wav file\n", sLoadName);
 		}
 */
+		if (bAsync)
+		{
+			sfx->eSoundCompressionMethod = ct_16;
+			sfx->iSoundLengthInSamples	 = info.samples;
+			S_LoadSound_Queue( sfx, sLoadName, data, size, &info, 0 );
+			return true;
+		}
+
 		samples = (short *)Z_Malloc(info.samples * sizeof(short) * 2, TAG_TEMP_WORKSPACE, false);
 
 		sfx->eSoundCompressionMethod = ct_16;
@@ -827,37 +1179,8 @@ static bool S_LoadSound_Actual( sfx_t *sfx )
 		sfx->pSoundData = nullptr;
 		ResampleSfx( sfx, info.rate, info.width, data + info.dataofs );
 
-		// Open AL
 #ifdef USE_OPENAL
-		if (s_useOpenAL->integer)
-		{
-			if ((strstr(sfx->sSoundName, "chars")) || (strstr(sfx->sSoundName, "CHARS")))
-			{
-				sfx->lipSyncData = (char *)Z_Malloc((sfx->iSoundLengthInSamples / 1000) + 1, TAG_SND_RAWDATA, false);
-				S_PreProcessLipSync(sfx);
-			}
-			else
-				sfx->lipSyncData = nullptr;
-
-			// Clear Open AL Error State
-			alGetError();
-
-			// Generate AL Buffer
-            ALuint Buffer;
-			alGenBuffers(1, &Buffer);
-			if (alGetError() == AL_NO_ERROR)
-			{
-				// Copy audio data to AL Buffer
-				alBufferData(Buffer, AL_FORMAT_MONO16, sfx->pSoundData, sfx->iSoundLengthInSamples*2, 22050);
-				if (alGetError() == AL_NO_ERROR)
-				{
-					// Store AL Buffer in sfx struct, and release sample data
-					sfx->Buffer = Buffer;
-					Z_Free(sfx->pSoundData);
-					sfx->pSoundData = nullptr;
-				}
-			}
-		}
+		S_LoadSound_UploadAL(sfx);
 #endif
 
 		Z_Free(samples);
@@ -870,11 +1193,12 @@ static bool S_LoadSound_Actual( sfx_t *sfx )
 
 // wrapper function for above so I can guarantee that we don't attempt any audio-dumping during this call because
 //	of a z_malloc() fail recovery...
-bool S_LoadSound( sfx_t *sfx )
+// bAsync lets the decode finish on the loader threads, check sfx->pLoadJob afterwards
+bool S_LoadSound( sfx_t *sfx, bool bAsync /* = false */ )
 {
 	gbInsideLoadSound = true;	// !!!!!!!!!!!!!
 
-		bool bReturn = S_LoadSound_Actual( sfx );
+		bool bReturn = S_LoadSound_Actual( sfx, bAsync && numSndLoadThreads );
 
 	gbInsideLoadSound = false;	// !!!!!!!!!!!!!
 
@@ -28,35 +28,108 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "client/snd_local.h"
 #include "qcommon/com_cvars.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define S_SIMD_MIX
+	#include <emmintrin.h>
+#endif
+
 portable_samplepair_t paintbuffer[PAINTBUFFER_SIZE];
 int 	*snd_p, snd_linear_count, snd_vol;
 short	*snd_out;
 
-// FIXME: proper fix for that ?
-#if !defined(_MSC_VER) || !id386
-void S_WriteLinearBlastStereo16 (void)
+// MIX KERNELS
+
+// Adds count mono 16 bit samples into the paint buffer at the given 8.8 fixed point volumes.
+// This is the reference, the vector versions have to come up with exactly the same sums.
+static void S_MixMono16_C( portable_samplepair_t *dest, const short *src, int count, int leftvol, int rightvol )
 {
-	int		i;
-	int		val;
+	for ( int i = 0; i < count; i++ )
+	{
+		const int data = src[i];
+
+		dest[i].left  += (data * leftvol )>>8;
+		dest[i].right += (data * rightvol)>>8;
+	}
+}
 
-	for (i=0 ; i<snd_linear_count ; i+=2)
+// Drops the 8 fractional bits and saturates count interleaved paint buffer values to 16 bit output
+static void S_ClipStereo16_C( const int *in, short *out, int count )
+{
+	for ( int i = 0; i < count; i++ )
 	{
-		val = snd_p[i]>>8;
-		if (val > 0x7fff)
-			snd_out[i] = 0x7fff;
-		else if (val < (short)0x8000)
-			snd_out[i] = (short)0x8000;
-		else
-			snd_out[i] = val;
+		const int val = in[i]>>8;
 
-		val = snd_p[i+1]>>8;
 		if (val > 0x7fff)
-			snd_out[i+1] = 0x7fff;
+			out[i] = 0x7fff;
 		else if (val < (short)0x8000)
-			snd_out[i+1] = (short)0x8000;
+			out[i] = (short)0x8000;
 		else
-			snd_out[i+1] = val;
+			out[i] = val;
+	}
+}
+
+#ifdef S_SIMD_MIX
+// 32 bit multiply keeping the low half, SSE2 only has the unsigned 32x32->64 one but the low
+//	32 bits of the product are the same either way
+static inline __m128i S_MulLo32( __m128i a, __m128i b )
+{
+	const __m128i even	= _mm_mul_epu32( a, b );
+	const __m128i odd	= _mm_mul_epu32( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( b, 32 ) );
+
+	return _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( odd, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+
+static void S_MixMono16_SSE2( portable_samplepair_t *dest, const short *src, int count, int leftvol, int rightvol )
+{
+	const __m128i	vol = _mm_setr_epi32( leftvol, rightvol, leftvol, rightvol );
+	int				i;
+
+	for ( i = 0; i + 4 <= count; i += 4 )
+	{
+		__m128i	*out = (__m128i *)&dest[i];
+		__m128i	data = _mm_loadl_epi64( (const __m128i *)&src[i] );
+
+		// sign extend the four samples, then double each of them up for the left and right lanes
+		data = _mm_srai_epi32( _mm_unpacklo_epi16( data, data ), 16 );
+
+		const __m128i lo = _mm_srai_epi32( S_MulLo32( _mm_unpacklo_epi32( data, data ), vol ), 8 );
+		const __m128i hi = _mm_srai_epi32( S_MulLo32( _mm_unpackhi_epi32( data, data ), vol ), 8 );
+
+		_mm_storeu_si128( out, _mm_add_epi32( _mm_loadu_si128( out ), lo ) );
+		_mm_storeu_si128( out + 1, _mm_add_epi32( _mm_loadu_si128( out + 1 ), hi ) );
+	}
+
+	S_MixMono16_C( dest + i, src + i, count - i, leftvol, rightvol );
+}
+
+static void S_ClipStereo16_SSE2( const int *in, short *out, int count )
+{
+	int i;
+
+	// packssdw does the same saturation as the scalar clamp
+	for ( i = 0; i + 8 <= count; i += 8 )
+	{
+		const __m128i a = _mm_srai_epi32( _mm_loadu_si128( (const __m128i *)&in[i] ), 8 );
+		const __m128i b = _mm_srai_epi32( _mm_loadu_si128( (const __m128i *)&in[i + 4] ), 8 );
+
+		_mm_storeu_si128( (__m128i *)&out[i], _mm_packs_epi32( a, b ) );
 	}
+
+	S_ClipStereo16_C( in + i, out + i, count - i );
+}
+
+#define S_MixMono16		S_MixMono16_SSE2
+#define S_ClipStereo16	S_ClipStereo16_SSE2
+#else
+#define S_MixMono16		S_MixMono16_C
+#define S_ClipStereo16	S_ClipStereo16_C
+#endif
+
+// FIXME: proper fix for that ?
+#if !defined(_MSC_VER) || !id386
+void S_WriteLinearBlastStereo16 (void)
+{
+	S_ClipStereo16( snd_p, snd_out, snd_linear_count );
 }
 #else
 unsigned int uiMMXAvailable = 0;	// leave as 32 bit
@@ -261,64 +334,30 @@ static void S_PaintChannelFrom16( channel_t *ch, const sfx_t *sfx, int count, in
 
 	pSamplesDest	= &paintbuffer[ bufferOffset ];
 
+	if ( !ch->doppler || ch->dopplerScale <= 1 )
+	{
+		// plain one to one playback, the common case
+		S_MixMono16( pSamplesDest, &sfx->pSoundData[ sampleOffset ], count, iLeftVol, iRightVol );
+		return;
+	}
+
 	for ( int i=0 ; i<count ; i++ )
 	{
 		iData = sfx->pSoundData[ (int)ofst ];
 
 		pSamplesDest[i].left  += (iData * iLeftVol )>>8;
 		pSamplesDest[i].right += (iData * iRightVol)>>8;
-		if (ch->doppler && ch->dopplerScale > 1) {
-			ofst += 1 * ch->dopplerScale;
-		} else {
-			ofst++;
-		}
+		ofst += 1 * ch->dopplerScale;
 	}
 }
 
 void S_PaintChannelFromMP3( channel_t *ch, const sfx_t *sc, int count, int sampleOffset, int bufferOffset )
 {
-	int data;
-	int leftvol, rightvol;
-	signed short *sfx;
-	int	i;
-	portable_samplepair_t	*samp;
 	static short tempMP3Buffer[PAINTBUFFER_SIZE];
 
 	MP3Stream_GetSamples( ch, sampleOffset, count, tempMP3Buffer, false );	// false = not stereo
 
-	leftvol = ch->leftvol*snd_vol;
-	rightvol = ch->rightvol*snd_vol;
-	sfx = tempMP3Buffer;
-
-	samp = &paintbuffer[ bufferOffset ];
-
-	while ( count & 3 ) {
-		data = *sfx;
-		samp->left += (data * leftvol)>>8;
-		samp->right += (data * rightvol)>>8;
-
-		sfx++;
-		samp++;
-		count--;
-	}
-
-	for ( i=0 ; i<count ; i += 4 ) {
-		data = sfx[i];
-		samp[i].left += (data * leftvol)>>8;
-		samp[i].right += (data * rightvol)>>8;
-
-		data = sfx[i+1];
-		samp[i+1].left += (data * leftvol)>>8;
-		samp[i+1].right += (data * rightvol)>>8;
-
-		data = sfx[i+2];
-		samp[i+2].left += (data * leftvol)>>8;
-		samp[i+2].right += (data * rightvol)>>8;
-
-		data = sfx[i+3];
-		samp[i+3].left += (data * leftvol)>>8;
-		samp[i+3].right += (data * rightvol)>>8;
-	}
+	S_MixMono16( &paintbuffer[ bufferOffset ], tempMP3Buffer, count, ch->leftvol*snd_vol, ch->rightvol*snd_vol );
 }
 
 // subroutinised to save code dup (called twice)	-ste
@@ -470,3 +509,112 @@ void S_PaintChannels( int endtime ) {
 		s_paintedtime = end;
 	}
 }
+
+// MIXER BENCHMARK
+
+typedef void (*mixFunc_t)( portable_samplepair_t *dest, const short *src, int count, int leftvol, int rightvol );
+typedef void (*clipFunc_t)( const int *in, short *out, int count );
+
+// paints one buffer worth of looping voices, wrapping the same way S_PaintChannels does
+static void S_MixBenchBlock( mixFunc_t mix, clipFunc_t clip, short **voices, const int *lengths, const int *vols, int time,
+	portable_samplepair_t *paint, short *out )
+{
+	const int end = time + PAINTBUFFER_SIZE;
+
+	memset( paint, 0, PAINTBUFFER_SIZE * sizeof( portable_samplepair_t ) );
+
+	for ( int i = 0; i < MAX_CHANNELS; i++ )
+	{
+		int ltime = time;
+
+		while ( ltime < end )
+		{
+			const int sampleOffset = ltime % lengths[i];
+			const int count = Q_min( end - ltime, lengths[i] - sampleOffset );
+
+			mix( paint + ( ltime - time ), voices[i] + sampleOffset, count, vols[i*2], vols[i*2+1] );
+			ltime += count;
+		}
+	}
+
+	clip( (const int *)paint, out, PAINTBUFFER_SIZE * 2 );
+}
+
+/*
+S_MixBench_f
+
+Mixes MAX_CHANNELS looping ambients of synthetic noise through the scalar reference kernels and through the ones the
+mixer actually uses. Every block is checked for identical paint buffer and output samples before the two are timed.
+*/
+void S_MixBench_f( void )
+{
+	static portable_samplepair_t	refPaint[PAINTBUFFER_SIZE], mixPaint[PAINTBUFFER_SIZE];
+	static short					refOut[PAINTBUFFER_SIZE * 2], mixOut[PAINTBUFFER_SIZE * 2];
+
+	const int	numBlocks = (Cmd_Argc() > 1) ? Q_max( 1, atoi( Cmd_Argv( 1 ) ) ) : 2000;
+	short		*voices[MAX_CHANNELS];
+	int			lengths[MAX_CHANNELS];
+	int			vols[MAX_CHANNELS * 2];
+	int			seed, start, refMsec, mixMsec, mismatches = 0;
+	int			i, j, time;
+
+	// uneven loop lengths so the wrap points land all over the blocks, volumes loud enough to clip
+	seed = 0x5eed;
+	for ( i = 0; i < MAX_CHANNELS; i++ )
+	{
+		lengths[i] = 11025 + ( Q_rand( &seed ) & 0x7fffffff ) % 22050;
+		voices[i] = (short *)Z_Malloc( lengths[i] * sizeof( short ), TAG_TEMP_WORKSPACE, false );
+		for ( j = 0; j < lengths[i]; j++ )
+		{
+			voices[i][j] = (short)( Q_rand( &seed ) >> 16 );
+		}
+		vols[i*2] = ( ( Q_rand( &seed ) >> 16 ) & 255 ) * 256;
+		vols[i*2+1] = ( ( Q_rand( &seed ) >> 16 ) & 255 ) * 256;
+	}
+
+	for ( i = 0, time = 0; i < numBlocks; i++, time += PAINTBUFFER_SIZE )
+	{
+		S_MixBenchBlock( S_MixMono16_C, S_ClipStereo16_C, voices, lengths, vols, time, refPaint, refOut );
+		S_MixBenchBlock( S_MixMono16, S_ClipStereo16, voices, lengths, vols, time, mixPaint, mixOut );
+
+		if ( memcmp( refPaint, mixPaint, sizeof( refPaint ) ) || memcmp( refOut, mixOut, sizeof( refOut ) ) )
+		{
+			mismatches++;
+		}
+	}
+
+	start = Sys_Milliseconds();
+	for ( i = 0, time = 0; i < numBlocks; i++, time += PAINTBUFFER_SIZE )
+	{
+		S_MixBenchBlock( S_MixMono16_C, S_ClipStereo16_C, voices, lengths, vols, time, refPaint, refOut );
+	}
+	refMsec = Sys_Milliseconds() - start;
+
+	start = Sys_Milliseconds();
+	for ( i = 0, time = 0; i < numBlocks; i++, time += PAINTBUFFER_SIZE )
+	{
+		S_MixBenchBlock( S_MixMono16, S_ClipStereo16, voices, lengths, vols, time, mixPaint, mixOut );
+	}
+	mixMsec = Sys_Milliseconds() - start;
+
+	for ( i = 0; i < MAX_CHANNELS; i++ )
+	{
+		Z_Free( voices[i] );
+	}
+
+	Com_Printf( "mixer bench: %i voices, %i blocks of %i samples\n", MAX_CHANNELS, numBlocks, PAINTBUFFER_SIZE );
+	Com_Printf( "  reference: %5i msec\n", refMsec );
+#ifdef S_SIMD_MIX
+	Com_Printf( "  sse2:      %5i msec\n", mixMsec );
+#else
+	Com_Printf( "  scalar:    %5i msec\n", mixMsec );
+#endif
+	if ( mismatches )
+	{
+		Com_Printf( S_COLOR_RED "  %i blocks differ from the reference!\n", mismatches );
+	}
+	else
+	{
+		Com_Printf( "  output matches the reference\n" );
+	}
+}
@@ -31,10 +31,30 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/com_cvar.h"
 #include "qcommon/com_cvars.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static std::recursive_mutex mp3DecoderMutex;
+
+void MP3_LockDecoder( void )
+{
+	mp3DecoderMutex.lock();
+}
+
+void MP3_UnlockDecoder( void )
+{
+	mp3DecoderMutex.unlock();
+}
+
+typedef std::lock_guard<std::recursive_mutex> mp3DecoderLock_t;
+
 // expects data already loaded, filename arg is for error printing only
 // returns success/fail
 bool MP3_IsValid( const char *psLocalFilename, void *pvData, int iDataLen, bool bStereoDesired /* = false */)
 {
+	mp3DecoderLock_t lock( mp3DecoderMutex );
 	char *psError = C_MP3_IsValid(pvData, iDataLen, bStereoDesired);
 
 	if (psError)
@@ -56,6 +76,7 @@ int MP3_GetUnpackedSize( const char *psLocalFilename, void *pvData, int iDataLen
 	// always do this now that we have fast-unpack code for measuring output size... (much safer than relying on tags that may have been edited, or if MP3 has been re-saved with same tag)
 	if (1)//qbIgnoreID3Tag || !MP3_ReadSpecialTagInfo((byte *)pvData, iDataLen, nullptr, &iUnpackedSize))
 	{
+		mp3DecoderLock_t lock( mp3DecoderMutex );
 		char *psError = C_MP3_GetUnpackedSize( pvData, iDataLen, &iUnpackedSize, bStereoDesired);
 
 		if (psError)
@@ -73,6 +94,7 @@ int MP3_GetUnpackedSize( const char *psLocalFilename, void *pvData, int iDataLen
 int MP3_UnpackRawPCM( const char *psLocalFilename, void *pvData, int iDataLen, byte *pbUnpackBuffer, bool bStereoDesired /* = false */)
 {
 	int iUnpackedSize;
+	mp3DecoderLock_t lock( mp3DecoderMutex );
 	char *psError = C_MP3_UnpackRawPCM( pvData, iDataLen, &iUnpackedSize, pbUnpackBuffer, bStereoDesired);
 
 	if (psError)
@@ -91,6 +113,7 @@ bool MP3Stream_InitPlayingTimeFields( LP_MP3STREAM lpMP3Stream, const char *psLo
 
 	int iRate, iWidth, iChannels;
 
+	mp3DecoderLock_t lock( mp3DecoderMutex );
 	char *psError = C_MP3_GetHeaderData(pvData, iDataLen, &iRate, &iWidth, &iChannels, bStereoDesired );
 	if (psError)
 	{
@@ -141,6 +164,7 @@ bool MP3_FakeUpWAVInfo( const char *psLocalFilename, void *pvData, int iDataLen,
 	dataofs= 0;		// will be 0 for me (since there's no header in the unpacked data)
 
 	// some things need to be read...  (though the whole stereo flag thing is crap)
+	mp3DecoderLock_t lock( mp3DecoderMutex );
 	char *psError = C_MP3_GetHeaderData(pvData, iDataLen, &rate, &width, &channels, bStereoDesired );
 	if (psError)
 	{
@@ -252,6 +276,7 @@ bool MP3Stream_InitFromFile( sfx_t* sfx, byte *pbSrcData, int iSrcDatalen, const
 
 		// now init the low-level MP3 stuff...
 		MP3STREAM SFX_MP3Stream = {};	// important to init to all zeroes!
+		mp3DecoderLock_t lock( mp3DecoderMutex );
 		char *psError = C_MP3Stream_DecodeInit( &SFX_MP3Stream, /*sfx->data*/ /*sfx->soundData*/ pbSrcData, iSrcDatalen,
 												dma.speed,//(s_khz->value == 44)?44100:(s_khz->value == 22)?22050:11025,
 												2/*sfx->width*/ * 8,
@@ -286,6 +311,8 @@ bool MP3Stream_InitFromFile( sfx_t* sfx, byte *pbSrcData, int iSrcDatalen, const
 // return is decoded byte count, else 0 for finished
 int MP3Stream_Decode( LP_MP3STREAM lpMP3Stream, bool bDoingMusic )
 {
+	mp3DecoderLock_t lock( mp3DecoderMutex );
+
 	lpMP3Stream->iCopyOffset = 0;
 
 	if (0)//!bDoingMusic)
@@ -370,6 +397,7 @@ bool MP3Stream_SeekTo( channel_t *ch, float fTimeToSeekTo )
 	}
 
 	// now do the seek...
+	mp3DecoderLock_t lock( mp3DecoderMutex );
 	while (1)
 	{
 		float fPlayingTimeElapsed = MP3Stream_GetPlayingTimeInSeconds( &ch->MP3StreamHeader ) - MP3Stream_GetRemainingTimeInSeconds( &ch->MP3StreamHeader );
@@ -411,8 +439,281 @@ bool MP3Stream_Rewind( channel_t *ch )
 
 }
 
+// ======================================================================
+// background decoding
+//
+// Every streamed channel the mixer reads from gets a slot with its own copy of the decoder state and a ring of PCM
+//	that a worker thread keeps topped up ahead of the mix cursor, so MP3Stream_GetSamples() normally only copies bytes.
+//	The mp3code decoder isn't reentrant (see pMP3Stream), so there's one worker and each packet is decoded behind
+//	mp3DecoderMutex; the mixer only takes the lock to (re)start a slot, or to decode inline if the worker fell behind.
+// ======================================================================
+
+#define MP3_ASYNC_STREAMS		(MAX_CHANNELS+2)	// every channel plus both music tracks
+#define MP3_ASYNC_RING_BYTES	65536		// must be a power of two, ~0.7s of 44k mono
+#define MP3_ASYNC_PACKET_BYTES	(2304*2)	// most one decode can produce, see MP3STREAM::bDecodeBuffer
+
+typedef struct mp3AsyncStream_s {
+	// identity of the channel stream this slot is decoding, only written by the mixer with the lock held
+	const channel_t	*owner;
+	const sfx_t		*sfx;
+	const byte		*pbSourceData;
+	int				iSourceReadIndex;
+	int				iSourceBytesRemaining;
+	bool			bStereo;
+	int				iConsumed;		// total bytes handed to the owner's sliding window, matches window+write pos
+	int				iLastUsed;
+
+	MP3STREAM		stream;			// decoder state, only touched with the lock held
+
+	// single reader (mixer), writes are serialised by the lock
+	std::atomic<unsigned int>	writePos;
+	std::atomic<unsigned int>	readPos;
+	std::atomic<bool>			bFinished;
+	byte			ring[MP3_ASYNC_RING_BYTES];
+} mp3AsyncStream_t;
+
+static mp3AsyncStream_t				mp3AsyncStreams[MP3_ASYNC_STREAMS];
+static std::thread					*mp3AsyncWorker;
+static std::condition_variable_any	mp3AsyncWake;
+static bool							mp3AsyncQuit;
+static int							mp3AsyncClock;
+
+// call with the lock held
+static void MP3Stream_AsyncPush( mp3AsyncStream_t *slot, const byte *pbSrc, int iBytes )
+{
+	const unsigned int uiWrite	= slot->writePos.load( std::memory_order_relaxed );
+	const int iOffset			= uiWrite & (MP3_ASYNC_RING_BYTES-1);
+	const int iFirst			= Q_min( iBytes, MP3_ASYNC_RING_BYTES - iOffset );
+
+	memcpy( slot->ring + iOffset, pbSrc, iFirst );
+	memcpy( slot->ring, pbSrc + iFirst, iBytes - iFirst );
+	slot->writePos.store( uiWrite + iBytes, std::memory_order_release );
+}
+
+// decodes one packet onto the end of the ring, call with the lock held
+static bool MP3Stream_AsyncDecodePacket( mp3AsyncStream_t *slot )
+{
+	const int iBytes = MP3Stream_Decode( &slot->stream, slot->bStereo );
+	if ( !iBytes )
+	{
+		slot->bFinished.store( true, std::memory_order_release );
+		return false;
+	}
+
+	MP3Stream_AsyncPush( slot, slot->stream.bDecodeBuffer, iBytes );
+	return true;
+}
+
+// emptiest ring that still has room for a whole packet, call with the lock held
+static mp3AsyncStream_t *MP3Stream_AsyncNeediest( void )
+{
+	mp3AsyncStream_t	*best = nullptr;
+	unsigned int		uiBestFill = MP3_ASYNC_RING_BYTES - MP3_ASYNC_PACKET_BYTES;
+
+	for ( int i = 0; i < MP3_ASYNC_STREAMS; i++ )
+	{
+		mp3AsyncStream_t *slot = &mp3AsyncStreams[i];
+
+		if ( !slot->owner || slot->bFinished.load( std::memory_order_relaxed ) )
+			continue;
+
+		const unsigned int uiFill = slot->writePos.load( std::memory_order_relaxed ) - slot->readPos.load( std::memory_order_acquire );
+		if ( uiFill <= uiBestFill )
+		{
+			best = slot;
+			uiBestFill = uiFill;
+		}
+	}
+
+	return best;
+}
+
+static void MP3Stream_AsyncWorkerLoop( void )
+{
+	std::unique_lock<std::recursive_mutex> lock( mp3DecoderMutex );
+
+	for ( ;; )
+	{
+		mp3AsyncStream_t *slot = nullptr;
+
+		// the timeout covers a wakeup lost to the mixer advancing a read pos without the lock
+		if ( !mp3AsyncWake.wait_for( lock, std::chrono::milliseconds( 10 ), [&slot] { return mp3AsyncQuit || (slot = MP3Stream_AsyncNeediest()) != nullptr; } ) )
+			continue;
+
+		if ( mp3AsyncQuit )
+			return;
+
+		MP3Stream_AsyncDecodePacket( slot );
+
+		// let the mixer in between packets
+		lock.unlock();
+		std::this_thread::yield();
+		lock.lock();
+	}
+}
+
+// finds (or restarts) the slot decoding this channel's stream from where its sliding window has got to
+static mp3AsyncStream_t *MP3Stream_AsyncSlot( channel_t *ch, bool bStereo )
+{
+	mp3AsyncStream_t	*slot = nullptr;
+	mp3AsyncStream_t	*spare = &mp3AsyncStreams[0];
+	const int			iWindowEnd = ch->iMP3SlidingDecodeWindowPos + ch->iMP3SlidingDecodeWritePos;
+
+	mp3AsyncClock++;
+
+	for ( int i = 0; i < MP3_ASYNC_STREAMS; i++ )
+	{
+		mp3AsyncStream_t *test = &mp3AsyncStreams[i];
+
+		if ( test->owner == ch )
+		{
+			slot = test;
+			break;
+		}
+
+		if ( spare->owner && (!test->owner || test->iLastUsed < spare->iLastUsed) )
+		{
+			spare = test;
+		}
+	}
+
+	// the channel's own header doesn't move while a slot decodes for it, so any rewind, seek or new sound shows up here
+	if ( slot
+		&& slot->sfx == ch->thesfx
+		&& slot->pbSourceData == ch->MP3StreamHeader.pbSourceData
+		&& slot->iSourceReadIndex == ch->MP3StreamHeader.iSourceReadIndex
+		&& slot->iSourceBytesRemaining == ch->MP3StreamHeader.iSourceBytesRemaining
+		&& slot->bStereo == bStereo
+		&& slot->iConsumed == iWindowEnd )
+	{
+		slot->iLastUsed = mp3AsyncClock;
+		return slot;
+	}
+
+	if ( !slot )
+	{
+		slot = spare;
+	}
+
+	{
+		mp3DecoderLock_t lock( mp3DecoderMutex );
+
+		slot->owner					= ch;
+		slot->sfx					= ch->thesfx;
+		slot->pbSourceData			= ch->MP3StreamHeader.pbSourceData;
+		slot->iSourceReadIndex		= ch->MP3StreamHeader.iSourceReadIndex;
+		slot->iSourceBytesRemaining	= ch->MP3StreamHeader.iSourceBytesRemaining;
+		slot->bStereo				= bStereo;
+		slot->iConsumed				= iWindowEnd;
+		slot->iLastUsed				= mp3AsyncClock;
+		memcpy( &slot->stream, &ch->MP3StreamHeader, sizeof(slot->stream) );
+		slot->readPos.store( 0, std::memory_order_relaxed );
+		slot->writePos.store( 0, std::memory_order_relaxed );
+		slot->bFinished.store( false, std::memory_order_relaxed );
+
+		// a slot taken away mid-stream (flushed or reused) has to catch up from the channel's untouched header,
+		//	the decode is deterministic so just throw away what the window already has...
+		int iSkip = iWindowEnd;
+		while (iSkip > 0)
+		{
+			const int iBytes = MP3Stream_Decode( &slot->stream, bStereo );
+			if (!iBytes)
+			{
+				slot->bFinished.store( true, std::memory_order_relaxed );
+				break;
+			}
+
+			if (iBytes > iSkip)
+			{
+				MP3Stream_AsyncPush( slot, slot->stream.bDecodeBuffer + iSkip, iBytes - iSkip );
+			}
+			iSkip -= iBytes;
+		}
+	}
+	mp3AsyncWake.notify_one();
+
+	return slot;
+}
+
+// copies up to one packet's worth of decoded bytes out of the ring, returns 0 for finished
+static int MP3Stream_AsyncRead( mp3AsyncStream_t *slot, byte *pbDest )
+{
+	const unsigned int uiRead = slot->readPos.load( std::memory_order_relaxed );
+	unsigned int uiAvail = slot->writePos.load( std::memory_order_acquire ) - uiRead;
+
+	if ( !uiAvail )
+	{
+		// worker hasn't kept up (or this slot was only just started), so decode this one inline...
+		mp3DecoderLock_t lock( mp3DecoderMutex );
+
+		uiAvail = slot->writePos.load( std::memory_order_acquire ) - uiRead;
+		if ( !uiAvail )
+		{
+			if ( slot->bFinished.load( std::memory_order_relaxed ) || !MP3Stream_AsyncDecodePacket( slot ) )
+				return 0;
+
+			uiAvail = slot->writePos.load( std::memory_order_relaxed ) - uiRead;
+		}
+	}
+
+	const int iBytes	= Q_min( (int)uiAvail, MP3_ASYNC_PACKET_BYTES );
+	const int iOffset	= uiRead & (MP3_ASYNC_RING_BYTES-1);
+	const int iFirst	= Q_min( iBytes, MP3_ASYNC_RING_BYTES - iOffset );
+
+	memcpy( pbDest, slot->ring + iOffset, iFirst );
+	memcpy( pbDest + iFirst, slot->ring, iBytes - iFirst );
+	slot->readPos.store( uiRead + iBytes, std::memory_order_release );
+	slot->iConsumed += iBytes;
+
+	mp3AsyncWake.notify_one();
+
+	return iBytes;
+}
+
+// releases every slot decoding from pvSourceData, or all of them for nullptr
+void MP3Stream_FlushAsync( const void *pvSourceData )
+{
+	mp3DecoderLock_t lock( mp3DecoderMutex );
+
+	for ( int i = 0; i < MP3_ASYNC_STREAMS; i++ )
+	{
+		if ( !pvSourceData || mp3AsyncStreams[i].pbSourceData == pvSourceData )
+		{
+			mp3AsyncStreams[i].owner = nullptr;
+		}
+	}
+}
+
+void MP3Stream_InitAsync( void )
+{
+	if ( mp3AsyncWorker || !s_mp3Async->integer )
+		return;
+
+	MP3Stream_FlushAsync( nullptr );
+	mp3AsyncQuit = false;
+	mp3AsyncWorker = new std::thread( MP3Stream_AsyncWorkerLoop );
+}
+
+void MP3Stream_ShutdownAsync( void )
+{
+	if ( !mp3AsyncWorker )
+		return;
+
+	{
+		mp3DecoderLock_t lock( mp3DecoderMutex );
+		mp3AsyncQuit = true;
+	}
+	mp3AsyncWake.notify_all();
+
+	mp3AsyncWorker->join();
+	delete mp3AsyncWorker;
+	mp3AsyncWorker = nullptr;
+
+	MP3Stream_FlushAsync( nullptr );
+}
+
 // returns true while still playing normally, else false for either finished or request-offset-error
-bool MP3Stream_GetSamples( channel_t *ch, int startingSampleNum, int count, short *buf, bool bStereo )
+bool MP3Stream_GetSamples( channel_t *ch, int startingSampleNum, int count, short *buf, bool bStereo, bool bAllowAsync /* = true */ )
 {
 	bool qbStreamStillGoing = true;
 
@@ -438,6 +739,9 @@ bool MP3Stream_GetSamples( channel_t *ch, int startingSampleNum, int count, shor
 
 //	bool _bDecoded = false;
 
+	// disk-streamed music scrolls pbSourceData under the decoder each call, so that has to stay inline
+	mp3AsyncStream_t *slot = (bAllowAsync && mp3AsyncWorker) ? MP3Stream_AsyncSlot( ch, bStereo ) : nullptr;
+
 	while (!
 		(
 			(startingSampleNum			>= ch->iMP3SlidingDecodeWindowPos)
@@ -453,7 +757,17 @@ bool MP3Stream_GetSamples( channel_t *ch, int startingSampleNum, int count, shor
 //		_bDecoded = true;
 //		Com_OPrintf("Scrolling...");
 
-		int _iBytesDecoded = MP3Stream_Decode( (LP_MP3STREAM) &ch->MP3StreamHeader, bStereo );	// stereo only for music, so this is safe
+		int _iBytesDecoded;
+		if (slot)
+		{
+			_iBytesDecoded = MP3Stream_AsyncRead( slot, ch->MP3SlidingDecodeBuffer + ch->iMP3SlidingDecodeWritePos );
+			ch->MP3StreamHeader.iBytesDecodedTotal += _iBytesDecoded;	// keep the time-remaining queries honest
+		}
+		else
+		{
+			_iBytesDecoded = MP3Stream_Decode( (LP_MP3STREAM) &ch->MP3StreamHeader, bStereo );	// stereo only for music, so this is safe
+			memcpy(ch->MP3SlidingDecodeBuffer + ch->iMP3SlidingDecodeWritePos,ch->MP3StreamHeader.bDecodeBuffer,_iBytesDecoded);
+		}
 //		Com_OPrintf("%d bytes decoded\n",_iBytesDecoded);
 		if (_iBytesDecoded == 0)
 		{
@@ -465,8 +779,6 @@ bool MP3Stream_GetSamples( channel_t *ch, int startingSampleNum, int count, shor
 		}
 		else
 		{
-			memcpy(ch->MP3SlidingDecodeBuffer + ch->iMP3SlidingDecodeWritePos,ch->MP3StreamHeader.bDecodeBuffer,_iBytesDecoded);
-
 			ch->iMP3SlidingDecodeWritePos += _iBytesDecoded;
 
 			// if reached 3/4 of buffer pos, backscroll the decode window by one quarter...
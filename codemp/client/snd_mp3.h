@@ -67,13 +67,22 @@ bool	MP3_FakeUpWAVInfo		( const char *psLocalFilename, void *pvData, int iDataLe
                                         int &channels, int &samples, int &dataofs, bool bStereoDesired = false );
 bool	MP3_IsValid				( const char *psLocalFilename, void *pvData, int iDataLen, bool bStereoDesired = false );
 bool	MP3_ReadSpecialTagInfo	( byte *pbLoadedFile, int iLoadedFileLen, id3v1_1** ppTAG = nullptr, int *piUncompressedSize = nullptr, float *pfMaxVol = nullptr);
-bool	MP3Stream_GetSamples	( channel_t *ch, int startingSampleNum, int count, short *buf, bool bStereo );
+bool	MP3Stream_GetSamples	( channel_t *ch, int startingSampleNum, int count, short *buf, bool bStereo, bool bAllowAsync = true );
 bool	MP3Stream_InitFromFile	( sfx_t* sfx, byte *pbSrcData, int iSrcDatalen, const char *psSrcDataFilename, int iMP3UnPackedSize, bool bStereoDesired = false );
 bool	MP3Stream_InitPlayingTimeFields( LP_MP3STREAM lpMP3Stream, const char *psLocalFilename, void *pvData, int iDataLen, bool bStereoDesired = false);
 bool	MP3Stream_Rewind		( channel_t *ch );
 bool	MP3Stream_SeekTo		( channel_t *ch, float fTimeToSeekTo );
 void		MP3_InitCvars			( void );
 
+// the decoder below keeps its working state in globals, so every call into it must hold this lock...
+void		MP3_LockDecoder			( void );
+void		MP3_UnlockDecoder		( void );
+
+// background decoding of streamed channels, see MP3Stream_GetSamples()
+void		MP3Stream_InitAsync		( void );
+void		MP3Stream_ShutdownAsync	( void );
+void		MP3Stream_FlushAsync	( const void *pvSourceData );	// call before freeing any MP3 source data
+
 // the real worker code deep down in the MP3 C code...  (now externalised here so the music streamer can access one)
 #ifdef __cplusplus
 extern "C"
@@ -0,0 +1,310 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// dp_main.cpp -- demoparse command line tool, decodes demos on worker threads and writes one event stream per demo
+
+#include "demoparse/dp_public.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define	DPB_MAGIC		"DPB1"
+
+typedef enum {
+	DPB_GAMESTATE,		// int clientNum, int serverCommandSequence, gameState_t
+	DPB_COMMAND,		// int sequence, command string without the 0
+	DPB_SNAPSHOT,		// int serverTime, messageNum, deltaNum, snapFlags, numEntities, playerState_t
+	DPB_ENTITY,			// int serverTime, entityState_t
+	DPB_REMOVED,		// int serverTime, int number
+} dpbRecord_e;
+
+typedef enum {
+	OUTPUT_JSON,
+	OUTPUT_BINARY,
+} outputFormat_e;
+
+struct demoOutput_t {
+	FILE	*f;
+};
+
+static outputFormat_e		outputFormat = OUTPUT_JSON;
+static std::string			outputDir;
+static std::vector<char *>	demos;
+static std::atomic<int>		nextDemo( 0 );
+static std::atomic<int>		numFailed( 0 );
+
+// ======================================================================
+// binary output, raw structs so the reader must be built with the same headers (the header records their sizes)
+// ======================================================================
+
+static void DPB_Record( demoOutput_t *out, dpbRecord_e type, const void *a, uint32_t aLen, const void *b, uint32_t bLen ) {
+	uint8_t		t = (uint8_t)type;
+	uint32_t	len = aLen + bLen;
+
+	fwrite( &t, sizeof( t ), 1, out->f );
+	fwrite( &len, sizeof( len ), 1, out->f );
+	fwrite( a, aLen, 1, out->f );
+	if ( bLen ) {
+		fwrite( b, bLen, 1, out->f );
+	}
+}
+
+static void DPB_Header( demoOutput_t *out ) {
+	uint32_t sizes[3] = { sizeof( gameState_t ), sizeof( playerState_t ), sizeof( entityState_t ) };
+
+	fwrite( DPB_MAGIC, 4, 1, out->f );
+	fwrite( sizes, sizeof( sizes ), 1, out->f );
+}
+
+static void DPB_Gamestate( void *user, const gameState_t *gameState, int clientNum, int serverCommandSequence ) {
+	int ints[2] = { clientNum, serverCommandSequence };
+	DPB_Record( (demoOutput_t *)user, DPB_GAMESTATE, ints, sizeof( ints ), gameState, sizeof( *gameState ) );
+}
+
+static void DPB_ServerCommand( void *user, int sequence, const char *command ) {
+	DPB_Record( (demoOutput_t *)user, DPB_COMMAND, &sequence, sizeof( sequence ), command, strlen( command ) );
+}
+
+static void DPB_Snapshot( void *user, const demoSnapshot_t *snapshot ) {
+	int ints[5] = { snapshot->serverTime, snapshot->messageNum, snapshot->deltaNum, snapshot->snapFlags, snapshot->numEntities };
+	DPB_Record( (demoOutput_t *)user, DPB_SNAPSHOT, ints, sizeof( ints ), snapshot->ps, sizeof( *snapshot->ps ) );
+}
+
+static void DPB_Entity( void *user, int serverTime, const entityState_t *state ) {
+	DPB_Record( (demoOutput_t *)user, DPB_ENTITY, &serverTime, sizeof( serverTime ), state, sizeof( *state ) );
+}
+
+static void DPB_EntityRemoved( void *user, int serverTime, int number ) {
+	int ints[2] = { serverTime, number };
+	DPB_Record( (demoOutput_t *)user, DPB_REMOVED, ints, sizeof( ints ), nullptr, 0 );
+}
+
+// ======================================================================
+// json output, one object per line with the fields most analysis needs
+// ======================================================================
+
+static void JSON_String( FILE *f, const char *s ) {
+	fputc( '"', f );
+	for ( ; *s ; s++ ) {
+		unsigned char c = (unsigned char)*s;
+
+		if ( c == '"' || c == '\\' ) {
+			fprintf( f, "\\%c", c );
+		} else if ( c < 0x20 || c >= 0x7f ) {
+			// demos carry raw bytes, keep them lossless without claiming they're utf-8
+			fprintf( f, "\\u%04x", c );
+		} else {
+			fputc( c, f );
+		}
+	}
+	fputc( '"', f );
+}
+
+static void JSON_Vec3( FILE *f, const char *name, const vec3_t v ) {
+	fprintf( f, ",\"%s\":[%g,%g,%g]", name, v[0], v[1], v[2] );
+}
+
+static void JSON_Gamestate( void *user, const gameState_t *gameState, int clientNum, int serverCommandSequence ) {
+	FILE *f = ((demoOutput_t *)user)->f;
+
+	fprintf( f, "{\"type\":\"gamestate\",\"clientNum\":%d,\"serverCommandSequence\":%d,\"configstrings\":{",
+		clientNum, serverCommandSequence );
+	for ( int i = 0, first = 1 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		if ( !gameState->stringOffsets[i] ) {
+			continue;
+		}
+		fprintf( f, "%s\"%d\":", first ? "" : ",", i );
+		JSON_String( f, gameState->stringData + gameState->stringOffsets[i] );
+		first = 0;
+	}
+	fputs( "}}\n", f );
+}
+
+static void JSON_ServerCommand( void *user, int sequence, const char *command ) {
+	FILE *f = ((demoOutput_t *)user)->f;
+
+	fprintf( f, "{\"type\":\"command\",\"sequence\":%d,\"command\":", sequence );
+	JSON_String( f, command );
+	fputs( "}\n", f );
+}
+
+static void JSON_Snapshot( void *user, const demoSnapshot_t *snapshot ) {
+	FILE				*f = ((demoOutput_t *)user)->f;
+	const playerState_t	*ps = snapshot->ps;
+
+	fprintf( f, "{\"type\":\"snapshot\",\"serverTime\":%d,\"messageNum\":%d,\"deltaNum\":%d,\"snapFlags\":%d,\"numEntities\":%d",
+		snapshot->serverTime, snapshot->messageNum, snapshot->deltaNum, snapshot->snapFlags, snapshot->numEntities );
+	fprintf( f, ",\"ps\":{\"clientNum\":%d,\"commandTime\":%d,\"pm_type\":%d,\"weapon\":%d",
+		ps->clientNum, ps->commandTime, ps->pm_type, ps->weapon );
+	// stat indices belong to the game module, so leave naming them to the reader
+	fputs( ",\"stats\":[", f );
+	for ( int i = 0 ; i < MAX_STATS ; i++ ) {
+		fprintf( f, "%s%d", i ? "," : "", ps->stats[i] );
+	}
+	fputc( ']', f );
+	JSON_Vec3( f, "origin", ps->origin );
+	JSON_Vec3( f, "velocity", ps->velocity );
+	JSON_Vec3( f, "viewangles", ps->viewangles );
+	fputs( "}}\n", f );
+}
+
+static void JSON_Entity( void *user, int serverTime, const entityState_t *state ) {
+	FILE *f = ((demoOutput_t *)user)->f;
+
+	fprintf( f, "{\"type\":\"entity\",\"serverTime\":%d,\"number\":%d,\"eType\":%d,\"eFlags\":%d,\"modelindex\":%d,\"event\":%d,\"weapon\":%d",
+		serverTime, state->number, state->eType, state->eFlags, state->modelindex, state->event, state->weapon );
+	JSON_Vec3( f, "origin", state->pos.trBase );
+	JSON_Vec3( f, "angles", state->apos.trBase );
+	fputs( "}\n", f );
+}
+
+static void JSON_EntityRemoved( void *user, int serverTime, int number ) {
+	fprintf( ((demoOutput_t *)user)->f, "{\"type\":\"removed\",\"serverTime\":%d,\"number\":%d}\n", serverTime, number );
+}
+
+// ======================================================================
+// driver
+// ======================================================================
+
+static std::string DP_OutputPath( const char *demo ) {
+	std::string	name( demo );
+	size_t		slash = name.find_last_of( "/\\" );
+	size_t		dot;
+
+	if ( !outputDir.empty() && slash != std::string::npos ) {
+		name.erase( 0, slash + 1 );
+	}
+	dot = name.find_last_of( '.' );
+	if ( dot != std::string::npos && name.find_first_of( "/\\", dot ) == std::string::npos ) {
+		name.erase( dot );
+	}
+	if ( !outputDir.empty() ) {
+		name = outputDir + "/" + name;
+	}
+	return name + ( outputFormat == OUTPUT_JSON ? ".jsonl" : ".dpb" );
+}
+
+static void DP_ParseOne( const char *demo ) {
+	std::string			path = DP_OutputPath( demo );
+	demoOutput_t		out;
+	demoParseEvents_t	events;
+	char				error[MAX_STRING_CHARS];
+
+	out.f = fopen( path.c_str(), "wb" );
+	if ( !out.f ) {
+		fprintf( stderr, "%s: couldn't write %s\n", demo, path.c_str() );
+		numFailed++;
+		return;
+	}
+
+	events.user = &out;
+	if ( outputFormat == OUTPUT_JSON ) {
+		events.Gamestate = JSON_Gamestate;
+		events.ServerCommand = JSON_ServerCommand;
+		events.Snapshot = JSON_Snapshot;
+		events.Entity = JSON_Entity;
+		events.EntityRemoved = JSON_EntityRemoved;
+	} else {
+		DPB_Header( &out );
+		events.Gamestate = DPB_Gamestate;
+		events.ServerCommand = DPB_ServerCommand;
+		events.Snapshot = DPB_Snapshot;
+		events.Entity = DPB_Entity;
+		events.EntityRemoved = DPB_EntityRemoved;
+	}
+
+	if ( DP_ParseDemo( demo, &events, error, sizeof( error ) ) ) {
+		fprintf( stderr, "%s -> %s\n", demo, path.c_str() );
+	} else {
+		fprintf( stderr, "%s: %s\n", demo, error );
+		numFailed++;
+	}
+	fclose( out.f );
+}
+
+static void DP_Worker( void ) {
+	for ( int i = nextDemo++ ; i < (int)demos.size() ; i = nextDemo++ ) {
+		DP_ParseOne( demos[i] );
+	}
+}
+
+static void DP_Usage( void ) {
+	fprintf( stderr,
+		"usage: demoparse [-j threads] [-f json|bin] [-o outdir] demo.dm_26 ...\n"
+		"  -j  number of demos decoded at once, defaults to the hardware thread count\n"
+		"  -f  json writes <demo>.jsonl, bin writes raw structs to <demo>.dpb\n"
+		"  -o  directory for the output files, defaults to next to each demo\n" );
+	exit( 1 );
+}
+
+int main( int argc, char **argv ) {
+	int							numThreads = (int)std::thread::hardware_concurrency();
+	std::vector<std::thread>	threads;
+
+	for ( int i = 1 ; i < argc ; i++ ) {
+		if ( !strcmp( argv[i], "-j" ) && i + 1 < argc ) {
+			numThreads = atoi( argv[++i] );
+		} else if ( !strcmp( argv[i], "-f" ) && i + 1 < argc ) {
+			i++;
+			if ( !strcmp( argv[i], "json" ) ) {
+				outputFormat = OUTPUT_JSON;
+			} else if ( !strcmp( argv[i], "bin" ) ) {
+				outputFormat = OUTPUT_BINARY;
+			} else {
+				DP_Usage();
+			}
+		} else if ( !strcmp( argv[i], "-o" ) && i + 1 < argc ) {
+			outputDir = argv[++i];
+		} else if ( argv[i][0] == '-' ) {
+			DP_Usage();
+		} else {
+			demos.push_back( argv[i] );
+		}
+	}
+
+	if ( demos.empty() ) {
+		DP_Usage();
+	}
+	numThreads = Com_Clampi( 1, (int)demos.size(), numThreads );
+
+	DP_Init();
+
+	for ( int i = 0 ; i < numThreads ; i++ ) {
+		threads.emplace_back( DP_Worker );
+	}
+	for ( std::thread &t : threads ) {
+		t.join();
+	}
+
+	if ( numFailed ) {
+		fprintf( stderr, "%d of %d demos failed\n", numFailed.load(), (int)demos.size() );
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,453 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// dp_parse.cpp -- headless demo decoder, mirrors the client's message parsing in cl_parse.cpp
+
+#include "demoparse/dp_local.h"
+#include "qcommon/q_common.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define	DP_MAX_PARSE_ENTITIES	( PACKET_BACKUP * MAX_SNAPSHOT_ENTITIES )
+
+// same as the client's clSnapshot_t, without the fields only a live connection fills in
+struct dpSnapshot_t {
+	bool			valid;
+	int				snapFlags;
+	int				serverTime;
+	int				messageNum;
+	int				deltaNum;
+	byte			areamask[MAX_MAP_AREA_BYTES];
+	playerState_t	ps;
+	int				numEntities;
+	int				parseEntitiesNum;
+};
+
+// the client's cl and clc state for one demo, so every thread decodes its own
+struct demoParser_t {
+	const demoParseEvents_t		*events;
+
+	int							serverMessageSequence;
+	int							serverCommandSequence;
+
+	gameState_t					gameState;
+	dpSnapshot_t				snap;
+	dpSnapshot_t				snapshots[PACKET_BACKUP];
+	entityState_t				entityBaselines[MAX_GENTITIES];
+	entityState_t				parseEntities[DP_MAX_PARSE_ENTITIES];
+	int							parseEntitiesNum;
+
+	// change tracking for the Entity and EntityRemoved events
+	entityState_t				lastEntities[MAX_GENTITIES];
+	bool						lastPresent[MAX_GENTITIES];
+	bool						present[MAX_GENTITIES];
+	std::vector<entityState_t>	snapEntities;
+};
+
+static void DP_DeltaEntity( demoParser_t *dp, msg_t *msg, dpSnapshot_t *frame, int newnum, entityState_t *old, bool unchanged ) {
+	entityState_t	*state;
+
+	// save the parsed entity state into the big circular buffer so
+	// it can be used as the source for a later delta
+	state = &dp->parseEntities[dp->parseEntitiesNum & (DP_MAX_PARSE_ENTITIES-1)];
+
+	if ( unchanged ) {
+		*state = *old;
+	} else {
+		MSG_ReadDeltaEntity( msg, old, state, newnum );
+	}
+
+	if ( state->number == (MAX_GENTITIES-1) ) {
+		return;		// entity was delta removed
+	}
+	dp->parseEntitiesNum++;
+	frame->numEntities++;
+}
+
+static entityState_t *DP_OldEntity( demoParser_t *dp, const dpSnapshot_t *oldframe, int oldindex, int *oldnum ) {
+	entityState_t *oldstate;
+
+	if ( !oldframe || oldindex >= oldframe->numEntities ) {
+		*oldnum = 99999;
+		return nullptr;
+	}
+
+	oldstate = &dp->parseEntities[(oldframe->parseEntitiesNum + oldindex) & (DP_MAX_PARSE_ENTITIES-1)];
+	*oldnum = oldstate->number;
+	return oldstate;
+}
+
+static void DP_ParsePacketEntities( demoParser_t *dp, msg_t *msg, dpSnapshot_t *oldframe, dpSnapshot_t *newframe ) {
+	int				newnum, oldnum;
+	int				oldindex = 0;
+	entityState_t	*oldstate;
+
+	newframe->parseEntitiesNum = dp->parseEntitiesNum;
+	newframe->numEntities = 0;
+
+	// delta from the entities present in oldframe
+	oldstate = DP_OldEntity( dp, oldframe, oldindex, &oldnum );
+
+	while ( 1 ) {
+		// read the entity index number
+		newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
+
+		if ( newnum == (MAX_GENTITIES-1) ) {
+			break;
+		}
+
+		if ( msg->readcount > msg->cursize ) {
+			Com_Error( ERR_DROP, "DP_ParsePacketEntities: end of message" );
+		}
+
+		while ( oldnum < newnum ) {
+			// one or more entities from the old packet are unchanged
+			DP_DeltaEntity( dp, msg, newframe, oldnum, oldstate, true );
+			oldstate = DP_OldEntity( dp, oldframe, ++oldindex, &oldnum );
+		}
+
+		if ( oldnum == newnum ) {
+			// delta from previous state
+			DP_DeltaEntity( dp, msg, newframe, newnum, oldstate, false );
+			oldstate = DP_OldEntity( dp, oldframe, ++oldindex, &oldnum );
+			continue;
+		}
+
+		if ( oldnum > newnum ) {
+			// delta from baseline
+			DP_DeltaEntity( dp, msg, newframe, newnum, &dp->entityBaselines[newnum], false );
+		}
+	}
+
+	// any remaining entities in the old frame are copied over
+	while ( oldnum != 99999 ) {
+		DP_DeltaEntity( dp, msg, newframe, oldnum, oldstate, true );
+		oldstate = DP_OldEntity( dp, oldframe, ++oldindex, &oldnum );
+	}
+}
+
+// hands a new snapshot to the caller, with the entities that changed since the last one
+static void DP_RaiseSnapshot( demoParser_t *dp ) {
+	const demoParseEvents_t	*ev = dp->events;
+	demoSnapshot_t			snapshot;
+
+	dp->snapEntities.resize( dp->snap.numEntities );
+	for ( int i = 0 ; i < dp->snap.numEntities ; i++ ) {
+		dp->snapEntities[i] = dp->parseEntities[(dp->snap.parseEntitiesNum + i) & (DP_MAX_PARSE_ENTITIES-1)];
+	}
+
+	snapshot.serverTime = dp->snap.serverTime;
+	snapshot.messageNum = dp->snap.messageNum;
+	snapshot.deltaNum = dp->snap.deltaNum;
+	snapshot.snapFlags = dp->snap.snapFlags;
+	snapshot.ps = &dp->snap.ps;
+	snapshot.numEntities = dp->snap.numEntities;
+	snapshot.entities = dp->snapEntities.data();
+
+	if ( ev->Snapshot ) {
+		ev->Snapshot( ev->user, &snapshot );
+	}
+
+	memset( dp->present, 0, sizeof( dp->present ) );
+	for ( const entityState_t &es : dp->snapEntities ) {
+		dp->present[es.number] = true;
+
+		if ( dp->lastPresent[es.number] && !memcmp( &dp->lastEntities[es.number], &es, sizeof( es ) ) ) {
+			continue;
+		}
+		dp->lastEntities[es.number] = es;
+		if ( ev->Entity ) {
+			ev->Entity( ev->user, snapshot.serverTime, &es );
+		}
+	}
+
+	for ( int i = 0 ; i < MAX_GENTITIES ; i++ ) {
+		if ( dp->lastPresent[i] && !dp->present[i] && ev->EntityRemoved ) {
+			ev->EntityRemoved( ev->user, snapshot.serverTime, i );
+		}
+	}
+	memcpy( dp->lastPresent, dp->present, sizeof( dp->lastPresent ) );
+}
+
+// see CL_ParseSnapshot
+static void DP_ParseSnapshot( demoParser_t *dp, msg_t *msg ) {
+	int				len, deltaNum, oldMessageNum;
+	dpSnapshot_t	*old;
+	dpSnapshot_t	newSnap;
+
+	memset( &newSnap, 0, sizeof( newSnap ) );
+
+	newSnap.serverTime = MSG_ReadLong( msg );
+	newSnap.messageNum = dp->serverMessageSequence;
+
+	deltaNum = MSG_ReadByte( msg );
+	if ( !deltaNum ) {
+		newSnap.deltaNum = -1;
+	} else {
+		newSnap.deltaNum = newSnap.messageNum - deltaNum;
+	}
+	newSnap.snapFlags = MSG_ReadByte( msg );
+
+	// if the frame is delta compressed from data that we no longer have available, we must suck up the rest of
+	//	the frame, but not use it
+	if ( newSnap.deltaNum <= 0 ) {
+		newSnap.valid = true;		// uncompressed frame
+		old = nullptr;
+	} else {
+		old = &dp->snapshots[newSnap.deltaNum & PACKET_MASK];
+		if ( !old->valid ) {
+			while ( ( newSnap.deltaNum & PACKET_MASK ) != ( newSnap.messageNum & PACKET_MASK ) && !old->valid ) {
+				newSnap.deltaNum++;
+				old = &dp->snapshots[newSnap.deltaNum & PACKET_MASK];
+			}
+		}
+		if ( old->valid && old->messageNum == newSnap.deltaNum
+			&& dp->parseEntitiesNum - old->parseEntitiesNum <= DP_MAX_PARSE_ENTITIES-128 ) {
+			newSnap.valid = true;	// valid delta parse
+		}
+	}
+
+	// read areamask
+	len = MSG_ReadByte( msg );
+	if ( (unsigned)len > sizeof( newSnap.areamask ) ) {
+		Com_Error( ERR_DROP, "DP_ParseSnapshot: Invalid size %d for areamask", len );
+	}
+	MSG_ReadData( msg, &newSnap.areamask, len );
+
+	// read playerinfo
+	MSG_ReadDeltaPlayerstate( msg, old ? &old->ps : nullptr, &newSnap.ps );
+
+	// read packet entities
+	DP_ParsePacketEntities( dp, msg, old, &newSnap );
+
+	// if not valid, dump the entire thing now that it has been properly read
+	if ( !newSnap.valid ) {
+		return;
+	}
+
+	// clear the valid flags of any snapshots between the last received and this one
+	oldMessageNum = dp->snap.messageNum + 1;
+	if ( newSnap.messageNum - oldMessageNum >= PACKET_BACKUP ) {
+		oldMessageNum = newSnap.messageNum - ( PACKET_BACKUP - 1 );
+	}
+	for ( ; oldMessageNum < newSnap.messageNum ; oldMessageNum++ ) {
+		dp->snapshots[oldMessageNum & PACKET_MASK].valid = false;
+	}
+
+	dp->snap = newSnap;
+	dp->snapshots[dp->snap.messageNum & PACKET_MASK] = dp->snap;
+
+	DP_RaiseSnapshot( dp );
+}
+
+// see CL_ParseGamestate
+static void DP_ParseGamestate( demoParser_t *dp, msg_t *msg ) {
+	int				cmd, clientNum;
+	entityState_t	nullstate;
+
+	// wipe the state of the previous gamestate
+	memset( &dp->gameState, 0, sizeof( dp->gameState ) );
+	memset( &dp->snap, 0, sizeof( dp->snap ) );
+	memset( dp->snapshots, 0, sizeof( dp->snapshots ) );
+	memset( dp->entityBaselines, 0, sizeof( dp->entityBaselines ) );
+	memset( dp->lastPresent, 0, sizeof( dp->lastPresent ) );
+	dp->parseEntitiesNum = 0;
+
+	// a gamestate always marks a server command sequence
+	dp->serverCommandSequence = MSG_ReadLong( msg );
+
+	// parse all the configstrings and baselines
+	dp->gameState.dataCount = 1;	// leave a 0 at the beginning for uninitialized configstrings
+	while ( 1 ) {
+		cmd = MSG_ReadByte( msg );
+
+		if ( cmd == svc_EOF ) {
+			break;
+		}
+
+		if ( cmd == svc_configstring ) {
+			int			i, len;
+			const char	*s;
+
+			i = MSG_ReadShort( msg );
+			if ( i < 0 || i >= MAX_CONFIGSTRINGS ) {
+				Com_Error( ERR_DROP, "configstring > MAX_CONFIGSTRINGS" );
+			}
+			s = MSG_ReadBigString( msg );
+			len = strlen( s );
+
+			if ( len + 1 + dp->gameState.dataCount > MAX_GAMESTATE_CHARS ) {
+				Com_Error( ERR_DROP, "MAX_GAMESTATE_CHARS exceeded" );
+			}
+
+			// append it to the gameState string buffer
+			dp->gameState.stringOffsets[i] = dp->gameState.dataCount;
+			memcpy( dp->gameState.stringData + dp->gameState.dataCount, s, len + 1 );
+			dp->gameState.dataCount += len + 1;
+		} else if ( cmd == svc_baseline ) {
+			int newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
+			if ( newnum < 0 || newnum >= MAX_GENTITIES ) {
+				Com_Error( ERR_DROP, "Baseline number out of range: %i", newnum );
+			}
+			memset( &nullstate, 0, sizeof( nullstate ) );
+			MSG_ReadDeltaEntity( msg, &nullstate, &dp->entityBaselines[newnum], newnum );
+		} else {
+			Com_Error( ERR_DROP, "DP_ParseGamestate: bad command byte" );
+		}
+	}
+
+	clientNum = MSG_ReadLong( msg );
+	MSG_ReadLong( msg );	// checksum feed
+	MSG_ReadShort( msg );	// old RMG info
+
+	if ( dp->events->Gamestate ) {
+		dp->events->Gamestate( dp->events->user, &dp->gameState, clientNum, dp->serverCommandSequence );
+	}
+}
+
+// see CL_ParseCommandString
+static void DP_ParseCommandString( demoParser_t *dp, msg_t *msg ) {
+	int			seq;
+	const char	*s;
+
+	seq = MSG_ReadLong( msg );
+	s = MSG_ReadString( msg );
+
+	if ( dp->serverCommandSequence >= seq ) {
+		return;
+	}
+	dp->serverCommandSequence = seq;
+
+	if ( dp->events->ServerCommand ) {
+		dp->events->ServerCommand( dp->events->user, seq, s );
+	}
+}
+
+// see CL_ParseServerMessage
+static void DP_ParseServerMessage( demoParser_t *dp, msg_t *msg ) {
+	int cmd;
+
+	MSG_Bitstream( msg );
+
+	// reliable sequence acknowledge
+	MSG_ReadLong( msg );
+
+	while ( 1 ) {
+		if ( msg->readcount > msg->cursize ) {
+			Com_Error( ERR_DROP, "DP_ParseServerMessage: read past end of server message" );
+		}
+
+		cmd = MSG_ReadByte( msg );
+		if ( cmd == svc_EOF ) {
+			break;
+		}
+
+		switch ( cmd ) {
+		default:
+			Com_Error( ERR_DROP, "DP_ParseServerMessage: Illegible server message" );
+			break;
+		case svc_nop:
+		case svc_mapchange:
+			break;
+		case svc_serverCommand:
+			DP_ParseCommandString( dp, msg );
+			break;
+		case svc_gamestate:
+			DP_ParseGamestate( dp, msg );
+			break;
+		case svc_snapshot:
+			DP_ParseSnapshot( dp, msg );
+			break;
+		case svc_setgame:
+			// fs_game name, up to MAX_QPATH bytes ending in a 0
+			for ( int i = 0 ; i < MAX_QPATH && MSG_ReadByte( msg ) ; i++ ) {
+			}
+			break;
+		case svc_download:
+			Com_Error( ERR_DROP, "DP_ParseServerMessage: download in a demo" );
+			break;
+		}
+	}
+}
+
+void DP_Init( void ) {
+	msg_t	msg;
+	byte	data[1];
+
+	// the first MSG_Init builds the huffman tables, after that decoding only reads them
+	MSG_Init( &msg, data, sizeof( data ) );
+}
+
+bool DP_ParseDemo( const char *path, const demoParseEvents_t *events, char *error, size_t errorSize ) {
+	FILE							*f;
+	bool							ok = true;
+	std::unique_ptr<demoParser_t>	dp( new demoParser_t() );
+	std::vector<byte>				data( MAX_MSGLEN );
+
+	f = fopen( path, "rb" );
+	if ( !f ) {
+		Com_sprintf( error, errorSize, "couldn't open %s", path );
+		return false;
+	}
+
+	dp->events = events;
+
+	try {
+		while ( 1 ) {
+			int		seq, len;
+			msg_t	msg;
+
+			// see CL_ReadDemoMessage
+			if ( fread( &seq, 4, 1, f ) != 1 || fread( &len, 4, 1, f ) != 1 ) {
+				break;
+			}
+			len = LittleLong( len );
+			if ( len == -1 ) {
+				break;
+			}
+			if ( len < 0 || len > MAX_MSGLEN ) {
+				Com_Error( ERR_DROP, "demoMsglen > MAX_MSGLEN" );
+			}
+
+			MSG_Init( &msg, data.data(), (int)data.size() );
+			if ( fread( msg.data, len, 1, f ) != 1 && len ) {
+				Com_Error( ERR_DROP, "Demo file was truncated" );
+			}
+			msg.cursize = len;
+			msg.readcount = 0;
+
+			dp->serverMessageSequence = LittleLong( seq );
+			DP_ParseServerMessage( dp.get(), &msg );
+		}
+	} catch ( const demoParseError_t &e ) {
+		Q_strncpyz( error, e.what(), errorSize );
+		ok = false;
+	}
+
+	fclose( f );
+	return ok;
+}
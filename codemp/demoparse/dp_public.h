@@ -0,0 +1,71 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#pragma once
+
+// ======================================================================
+// INCLUDE
+// ======================================================================
+
+#include "qcommon/q_shared.h"
+
+#include <cstddef>
+
+// ======================================================================
+// STRUCT
+// ======================================================================
+
+// a decoded snapshot, the entities are only valid for the duration of the callback
+struct demoSnapshot_t {
+	int						serverTime;
+	int						messageNum;
+	int						deltaNum;		// -1 for an uncompressed snapshot
+	int						snapFlags;
+	const playerState_t		*ps;
+	int						numEntities;
+	const entityState_t		*entities;		// sorted on number
+};
+
+// Events are raised in demo order. Entity and EntityRemoved only fire for entities that appeared, changed or left
+//	since the previous snapshot, right after the Snapshot they belong to. Any callback may be left null
+struct demoParseEvents_t {
+	void	*user;
+
+	void	(*Gamestate)		( void *user, const gameState_t *gameState, int clientNum, int serverCommandSequence );
+	void	(*ServerCommand)	( void *user, int sequence, const char *command );
+	void	(*Snapshot)			( void *user, const demoSnapshot_t *snapshot );
+	void	(*Entity)			( void *user, int serverTime, const entityState_t *state );
+	void	(*EntityRemoved)	( void *user, int serverTime, int number );
+};
+
+// ======================================================================
+// FUNCTION
+// ======================================================================
+
+// Builds the shared huffman tables, call once before parsing from more than one thread
+void DP_Init( void );
+
+// Decodes a .dm_26 demo without a client, cgame or renderer. Safe to call from several threads at once. Returns false
+//	with the reason in error if the demo is broken, events raised before that stay raised
+bool DP_ParseDemo( const char *path, const demoParseEvents_t *events, char *error, size_t errorSize );
@@ -0,0 +1,62 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// dp_stubs.cpp -- the engine symbols msg.cpp and q_shared.cpp link against, without a common or server
+
+#include "demoparse/dp_local.h"
+#include "qcommon/q_common.h"
+#include "server/server.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+// msg.cpp only looks at these for cl_shownet debug output
+cvar_t		*cl_shownet = nullptr;
+server_t	sv;
+
+sharedEntity_t *SV_GentityNum( int num ) {
+	return nullptr;
+}
+
+void NORETURN QDECL Com_Error( int level, const char *fmt, ... ) {
+	va_list		argptr;
+	char		msg[MAX_STRING_CHARS];
+
+	va_start( argptr, fmt );
+	Q_vsnprintf( msg, sizeof( msg ), fmt, argptr );
+	va_end( argptr );
+
+	throw demoParseError_t( msg );
+}
+
+void QDECL Com_Printf( const char *fmt, ... ) {
+	va_list		argptr;
+
+	va_start( argptr, fmt );
+	vfprintf( stderr, fmt, argptr );
+	va_end( argptr );
+}
+
+void QDECL Com_DPrintf( const char *fmt, ... ) {
+}
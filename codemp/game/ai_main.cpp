@@ -35,6 +35,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "game/ai_chars.h"
 #include "game/g_inventory.h"
 
+#include <chrono>
+
 /*
 #define BOT_CTF_DEBUG	1
 */
@@ -649,6 +651,44 @@ int BotAI(int client, float thinktime) {
 	return true;
 }
 
+static int64_t BotThinkClock(void) {
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+//runs one think and records what it cost, returns the cost in microseconds
+static int BotTimedThink(bot_state_t *bs, int thinktime) {
+	int64_t start = BotThinkClock();
+	int usec;
+
+	BotAI(bs->client, (float) thinktime / 1000);
+
+	usec = (int)(BotThinkClock() - start);
+	bs->thinkUsec = usec;
+	bs->thinkUsecAvg = bs->thinkCount ? (bs->thinkUsecAvg * 7 + usec) / 8 : usec;
+	if (usec > bs->thinkUsecMax) {
+		bs->thinkUsecMax = usec;
+	}
+	bs->thinkCount++;
+
+	return usec;
+}
+
+void Svcmd_BotThinkStats_f(void) {
+	int i;
+	bot_state_t *bs;
+
+	trap->Print("think budget: %i usec per frame\n", bot_thinkBudget.integer);
+	trap->Print("num name                 thinks deferred   last    avg    max\n");
+	for (i = 0; i < MAX_CLIENTS; i++) {
+		bs = botstates[i];
+		if (!bs || !bs->inuse) {
+			continue;
+		}
+		trap->Print("%3i %-20s %6i %8i %6i %6i %6i\n", i, g_entities[i].client ? g_entities[i].client->pers.netname_nocolor : "",
+			bs->thinkCount, bs->thinkDeferTotal, bs->thinkUsec, bs->thinkUsecAvg, bs->thinkUsecMax);
+	}
+}
+
 void BotScheduleBotThink(void) {
 	int i, botnum;
 
@@ -965,13 +1005,11 @@ bool BotPVSCheck( const vec3_t p1, const vec3_t p2 )
 //get the index to the nearest visible waypoint in the global trail
 int GetNearestVisibleWP(vec3_t org, int ignore)
 {
-	int i;
+	static int nearby[MAX_WPARRAY_SIZE];
+	int i, numNearby;
 	float bestdist;
-	float flLen;
-	int bestindex;
-	vec3_t a, mins, maxs;
+	vec3_t mins, maxs;
 
-	i = 0;
 	if (RMG.integer)
 	{
 		bestdist = 300;
@@ -981,7 +1019,6 @@ int GetNearestVisibleWP(vec3_t org, int ignore)
 		bestdist = 800;//99999;
 				   //don't trace over 800 units away to avoid GIANT HORRIBLE SPEED HITS ^_^
 	}
-	bestindex = -1;
 
 	mins[0] = -15;
 	mins[1] = -15;
@@ -990,24 +1027,18 @@ int GetNearestVisibleWP(vec3_t org, int ignore)
 	maxs[1] = 15;
 	maxs[2] = 1;
 
-	while (i < gWPNum)
+	//nearest first, so the first one that can be seen is the answer and the traces stop there
+	numNearby = GetNearbyWPs(org, bestdist, nearby, MAX_WPARRAY_SIZE);
+
+	for (i = 0; i < numNearby; i++)
 	{
-		if (gWPArray[i] && gWPArray[i]->inuse)
+		if ((RMG.integer || BotPVSCheck(org, gWPArray[nearby[i]]->origin)) && OrgVisibleBox(org, mins, maxs, gWPArray[nearby[i]]->origin, ignore))
 		{
-			VectorSubtract(org, gWPArray[i]->origin, a);
-			flLen = VectorLength(a);
-
-			if (flLen < bestdist && (RMG.integer || BotPVSCheck(org, gWPArray[i]->origin)) && OrgVisibleBox(org, mins, maxs, gWPArray[i]->origin, ignore))
-			{
-				bestdist = flLen;
-				bestindex = i;
-			}
+			return nearby[i];
 		}
-
-		i++;
 	}
 
-	return bestindex;
+	return -1;
 }
 
 //wpDirection
@@ -1051,14 +1082,49 @@ int PassWayCheck(bot_state_t *bs, int windex)
 	return 1;
 }
 
+// Prefix sums over the trail, so TotalTrailDistance is a couple of lookups instead of a walk along it. disttonext and
+//	the one way flags are edited in a lot of places, so this is also rebuilt every frame it gets used, which is a single
+//	pass over the waypoints against the walks every bot used to do per candidate goal
+struct wpTrailTable_t {
+	bool	built;
+	int		version;						// gWPVersion it was built for
+	int		time;							// level.time it was built
+	double	dist[MAX_WPARRAY_SIZE+1];		// sum of disttonext over the waypoints before i
+	int		invalid[MAX_WPARRAY_SIZE+1];	// missing or unused waypoints before i
+	int		onewayBack[MAX_WPARRAY_SIZE+1];	// WPFLAG_ONEWAY_BACK waypoints before i
+	int		onewayFwd[MAX_WPARRAY_SIZE+1];	// WPFLAG_ONEWAY_FWD waypoints before i
+};
+
+static wpTrailTable_t wpTrail;
+
+static void BuildTrailTable(void)
+{
+	int i;
+
+	wpTrail.dist[0] = 0;
+	wpTrail.invalid[0] = wpTrail.onewayBack[0] = wpTrail.onewayFwd[0] = 0;
+
+	for (i = 0; i < gWPNum; i++)
+	{
+		wpobject_t *wp = gWPArray[i];
+		bool valid = wp && wp->inuse;
+
+		wpTrail.dist[i+1] = wpTrail.dist[i] + (valid ? wp->disttonext : 0);
+		wpTrail.invalid[i+1] = wpTrail.invalid[i] + !valid;
+		wpTrail.onewayBack[i+1] = wpTrail.onewayBack[i] + (valid && (wp->flags & WPFLAG_ONEWAY_BACK));
+		wpTrail.onewayFwd[i+1] = wpTrail.onewayFwd[i] + (valid && (wp->flags & WPFLAG_ONEWAY_FWD));
+	}
+
+	wpTrail.version = gWPVersion;
+	wpTrail.time = level.time;
+	wpTrail.built = true;
+}
+
 //tally up the distance between two waypoints
 float TotalTrailDistance(int start, int end, bot_state_t *bs)
 {
 	int beginat;
 	int endat;
-	float distancetotal;
-
-	distancetotal = 0;
 
 	if (start > end)
 	{
@@ -1071,28 +1137,36 @@ float TotalTrailDistance(int start, int end, bot_state_t *bs)
 		endat = end;
 	}
 
-	while (beginat < endat)
+	if (beginat == endat)
 	{
-		if (beginat >= gWPNum || !gWPArray[beginat] || !gWPArray[beginat]->inuse)
-		{ //invalid waypoint index
-			return -1;
-		}
+		return 0;
+	}
 
-		if (!RMG.integer)
-		{
-			if ((end > start && gWPArray[beginat]->flags & WPFLAG_ONEWAY_BACK) ||
-				(start > end && gWPArray[beginat]->flags & WPFLAG_ONEWAY_FWD))
-			{ //a one-way point, this means this path cannot be travelled to the final point
-				return -1;
-			}
-		}
+	if (beginat < 0 || endat > gWPNum)
+	{ //invalid waypoint index
+		return -1;
+	}
 
-		distancetotal += gWPArray[beginat]->disttonext;
+	if (!wpTrail.built || wpTrail.version != gWPVersion || wpTrail.time != level.time)
+	{
+		BuildTrailTable();
+	}
+
+	if (wpTrail.invalid[endat] != wpTrail.invalid[beginat])
+	{ //invalid waypoint index
+		return -1;
+	}
 
-		beginat++;
+	if (!RMG.integer)
+	{
+		if ((end > start && wpTrail.onewayBack[endat] != wpTrail.onewayBack[beginat]) ||
+			(start > end && wpTrail.onewayFwd[endat] != wpTrail.onewayFwd[beginat]))
+		{ //a one-way point, this means this path cannot be travelled to the final point
+			return -1;
+		}
 	}
 
-	return distancetotal;
+	return (float)(wpTrail.dist[endat] - wpTrail.dist[beginat]);
 }
 
 //see if there's a route shorter than our current one to get
@@ -6793,9 +6867,14 @@ void StandardBotAI(bot_state_t *bs, float thinktime)
 	MoveTowardIdealAngles(bs);
 }
 
+//client the think pass starts from, moved to the first bot bot_thinkBudget left waiting
+static int botThinkCursor;
+
 int BotAIStartFrame(int time) {
-	int i;
+	int i, n;
 	int elapsed_time, thinktime;
+	int spent, nextCursor;
+	bot_state_t *bs;
 	static int local_time;
 //	static int botlib_residual;
 	static int lastbotthink_time;
@@ -6824,21 +6903,54 @@ int BotAIStartFrame(int time) {
 	if (elapsed_time > BOT_THINK_TIME) thinktime = elapsed_time;
 	else thinktime = BOT_THINK_TIME;
 
-	// execute scheduled bot AI
 	for( i = 0; i < MAX_CLIENTS; i++ ) {
 		if( !botstates[i] || !botstates[i]->inuse ) {
 			continue;
 		}
 
 		botstates[i]->botthink_residual += elapsed_time;
+	}
+
+	// execute scheduled bot AI
+	//with bot_thinkBudget set, thinks stop once the frame has spent that many microseconds and the rest wait, the
+	//	next frame starts from the first bot left waiting so every bot gets its turn
+	spent = 0;
+	nextCursor = -1;
+	for( n = 0; n < MAX_CLIENTS; n++ ) {
+		i = (botThinkCursor + n) % MAX_CLIENTS;
+		bs = botstates[i];
+		if( !bs || !bs->inuse || bs->botthink_residual < thinktime ) {
+			continue;
+		}
 
-		if ( botstates[i]->botthink_residual >= thinktime ) {
-			botstates[i]->botthink_residual -= thinktime;
+		if (g_entities[i].client->pers.connected != CON_CONNECTED) {
+			bs->botthink_residual -= thinktime;
+			continue;
+		}
 
-			if (g_entities[i].client->pers.connected == CON_CONNECTED) {
-				BotAI(i, (float) thinktime / 1000);
+		if (bot_thinkBudget.integer > 0 && spent >= bot_thinkBudget.integer) {
+			if (nextCursor < 0) {
+				nextCursor = i;
 			}
+			bs->thinkDeferred++;
+			bs->thinkDeferTotal++;
+			continue;
 		}
+
+		if (bs->thinkDeferred) {
+			//hand the time spent waiting to this think so the bot's clock keeps up
+			spent += BotTimedThink(bs, bs->botthink_residual);
+			bs->botthink_residual = 0;
+			bs->thinkDeferred = 0;
+		}
+		else {
+			bs->botthink_residual -= thinktime;
+			spent += BotTimedThink(bs, thinktime);
+		}
+	}
+
+	if (nextCursor >= 0) {
+		botThinkCursor = nextCursor;
 	}
 
 	// execute bot user commands every frame
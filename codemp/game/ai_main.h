@@ -144,6 +144,12 @@ struct botskills_t {
 struct bot_state_t {
 	int              inuse;             // true if this state is used by a bot client
 	int              botthink_residual; // residual for the bot thinks
+	int              thinkDeferred;     // frames the due think has been pushed back by bot_thinkBudget
+	int              thinkCount;        // thinks run since the bot was set up
+	int              thinkDeferTotal;   // thinks pushed back by bot_thinkBudget since the bot was set up
+	int              thinkUsec;         // cost of the last think in microseconds
+	int              thinkUsecAvg;      // running average of the think cost
+	int              thinkUsecMax;      // most expensive think so far
 	int              client;            // client number of the bot
 	int              entitynum;         // entity number of the bot
 	playerState_t    cur_ps;            // current player state
@@ -295,6 +301,7 @@ extern int gLastPrintedIndex;
 extern int gLevelFlags;
 extern wpobject_t *gWPArray[MAX_WPARRAY_SIZE];
 extern int gWPNum;
+extern int gWPVersion;
 extern int gWPRenderedFrame;
 extern float gWPRenderTime;
 extern int nodenum;
@@ -310,6 +317,7 @@ int BotDoChat(bot_state_t* bs, char* section, int always);
 int BotGetWeaponRange(bot_state_t* bs);
 int BotIsAChickenWuss(bot_state_t* bs);
 int GetBestIdleGoal(bot_state_t* bs);
+int GetNearbyWPs(const vec3_t org, float radius, int *list, int maxList);
 int GetNearestVisibleWP(vec3_t org, int ignore);
 int NumBots(void);
 int OrgVisibleBox(vec3_t org1, vec3_t mins, vec3_t maxs, vec3_t org2, int ignore);
@@ -321,5 +329,6 @@ void BotUtilizePersonality(bot_state_t* bs);
 void BotWaypointRender(void);
 void LoadPath_ThisLevel(void);
 void StandardBotAI(bot_state_t* bs, float thinktime);
+void WPChanged(void);
 void* B_Alloc(int size);
 void* B_TempAlloc(int size);
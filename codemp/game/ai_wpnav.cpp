@@ -34,9 +34,33 @@ int gWPRenderedFrame = 0;
 
 wpobject_t *gWPArray[MAX_WPARRAY_SIZE];
 int gWPNum = 0;
+int gWPVersion = 0; //bumped whenever waypoints are added, moved or removed, see WPChanged
 
 int gLastPrintedIndex = -1;
 
+// Uniform grid over the waypoint origins in the XY plane, so nearest waypoint lookups only look at the cells in range
+//	instead of every waypoint. Rebuilt on the next lookup after the waypoints change
+#define WPGRID_CELL_SIZE	256
+#define WPGRID_MAX_DIM		128
+
+struct wpGrid_t {
+	bool	built;
+	int		version;					// gWPVersion it was built for
+	float	mins[2];
+	float	cellSize;					// grows past WPGRID_CELL_SIZE on maps too big for WPGRID_MAX_DIM cells
+	int		dims[2];
+	int		cellStart[WPGRID_MAX_DIM*WPGRID_MAX_DIM+1];	// cellWPs[cellStart[c]] to cellWPs[cellStart[c+1]-1]
+	int		cellWPs[MAX_WPARRAY_SIZE];
+};
+
+struct wpCandidate_t {
+	float	dist;
+	int		index;
+};
+
+static wpGrid_t wpGrid;
+static wpCandidate_t wpCandidates[MAX_WPARRAY_SIZE];
+
 nodeobject_t nodetable[MAX_NODETABLE_SIZE];
 int nodenum; //so we can connect broken trails
 
@@ -316,8 +340,167 @@ checkprint:
 	}
 }
 
+//anything cached off the waypoint array is rebuilt after this
+void WPChanged(void)
+{
+	gWPVersion++;
+}
+
+static int WPGridCoord(float v, int axis)
+{
+	return (int)floorf((v - wpGrid.mins[axis]) / wpGrid.cellSize);
+}
+
+static void BuildWPGrid(void)
+{
+	static int cellFill[WPGRID_MAX_DIM*WPGRID_MAX_DIM];
+	float maxs[2] = { 0, 0 };
+	int numCells;
+	int i, axis, cell;
+	bool any = false;
+
+	wpGrid.mins[0] = wpGrid.mins[1] = 0;
+
+	for (i = 0; i < gWPNum; i++)
+	{
+		if (!gWPArray[i] || !gWPArray[i]->inuse)
+		{
+			continue;
+		}
+
+		for (axis = 0; axis < 2; axis++)
+		{
+			if (!any || gWPArray[i]->origin[axis] < wpGrid.mins[axis])
+			{
+				wpGrid.mins[axis] = gWPArray[i]->origin[axis];
+			}
+			if (!any || gWPArray[i]->origin[axis] > maxs[axis])
+			{
+				maxs[axis] = gWPArray[i]->origin[axis];
+			}
+		}
+		any = true;
+	}
+
+	wpGrid.cellSize = WPGRID_CELL_SIZE;
+	while ((maxs[0] - wpGrid.mins[0]) / wpGrid.cellSize >= WPGRID_MAX_DIM ||
+		(maxs[1] - wpGrid.mins[1]) / wpGrid.cellSize >= WPGRID_MAX_DIM)
+	{
+		wpGrid.cellSize *= 2;
+	}
+
+	for (axis = 0; axis < 2; axis++)
+	{
+		wpGrid.dims[axis] = WPGridCoord(maxs[axis], axis) + 1;
+	}
+	numCells = wpGrid.dims[0] * wpGrid.dims[1];
+
+	// counting sort of the waypoints into their cells
+	memset(wpGrid.cellStart, 0, sizeof(wpGrid.cellStart[0]) * (numCells + 1));
+	for (i = 0; i < gWPNum; i++)
+	{
+		if (gWPArray[i] && gWPArray[i]->inuse)
+		{
+			cell = WPGridCoord(gWPArray[i]->origin[1], 1) * wpGrid.dims[0] + WPGridCoord(gWPArray[i]->origin[0], 0);
+			wpGrid.cellStart[cell + 1]++;
+		}
+	}
+	for (cell = 0; cell < numCells; cell++)
+	{
+		wpGrid.cellStart[cell + 1] += wpGrid.cellStart[cell];
+		cellFill[cell] = wpGrid.cellStart[cell];
+	}
+	for (i = 0; i < gWPNum; i++)
+	{
+		if (gWPArray[i] && gWPArray[i]->inuse)
+		{
+			cell = WPGridCoord(gWPArray[i]->origin[1], 1) * wpGrid.dims[0] + WPGridCoord(gWPArray[i]->origin[0], 0);
+			wpGrid.cellWPs[cellFill[cell]++] = i;
+		}
+	}
+
+	wpGrid.version = gWPVersion;
+	wpGrid.built = true;
+}
+
+static int QDECL WPCandidateCompare(const void *a, const void *b)
+{
+	const wpCandidate_t *ca = (const wpCandidate_t *)a;
+	const wpCandidate_t *cb = (const wpCandidate_t *)b;
+
+	if (ca->dist != cb->dist)
+	{
+		return ca->dist < cb->dist ? -1 : 1;
+	}
+	return ca->index - cb->index;
+}
+
+//fills list with the in use waypoints closer than radius to org, nearest first (lowest index first on ties, the order
+//a full scan keeping the first best would settle on)
+int GetNearbyWPs(const vec3_t org, float radius, int *list, int maxList)
+{
+	int lo[2], hi[2];
+	int x, y, k, i, axis;
+	int num = 0;
+	vec3_t a;
+	float flLen;
+
+	if (!wpGrid.built || wpGrid.version != gWPVersion)
+	{
+		BuildWPGrid();
+	}
+
+	for (axis = 0; axis < 2; axis++)
+	{
+		lo[axis] = WPGridCoord(org[axis] - radius, axis);
+		hi[axis] = WPGridCoord(org[axis] + radius, axis);
+
+		if (hi[axis] < 0 || lo[axis] >= wpGrid.dims[axis])
+		{
+			return 0;
+		}
+		lo[axis] = Q_max(lo[axis], 0);
+		hi[axis] = Q_min(hi[axis], wpGrid.dims[axis] - 1);
+	}
+
+	for (y = lo[1]; y <= hi[1]; y++)
+	{
+		for (x = lo[0]; x <= hi[0]; x++)
+		{
+			int cell = y * wpGrid.dims[0] + x;
+
+			for (k = wpGrid.cellStart[cell]; k < wpGrid.cellStart[cell + 1]; k++)
+			{
+				i = wpGrid.cellWPs[k];
+
+				VectorSubtract(org, gWPArray[i]->origin, a);
+				flLen = VectorLength(a);
+
+				if (flLen < radius)
+				{
+					wpCandidates[num].dist = flLen;
+					wpCandidates[num].index = i;
+					num++;
+				}
+			}
+		}
+	}
+
+	qsort(wpCandidates, num, sizeof(wpCandidates[0]), WPCandidateCompare);
+
+	num = Q_min(num, maxList);
+	for (k = 0; k < num; k++)
+	{
+		list[k] = wpCandidates[k].index;
+	}
+
+	return num;
+}
+
 void TransferWPData(int from, int to)
 {
+	WPChanged();
+
 	if (!gWPArray[to])
 	{
 		gWPArray[to] = (wpobject_t *)B_Alloc(sizeof(wpobject_t));
@@ -340,6 +523,8 @@ void TransferWPData(int from, int to)
 
 void CreateNewWP(vec3_t origin, int flags)
 {
+	WPChanged();
+
 	if (gWPNum >= MAX_WPARRAY_SIZE)
 	{
 		if (!RMG.integer)
@@ -374,6 +559,8 @@ void CreateNewWP_FromObject(wpobject_t *wp)
 {
 	int i;
 
+	WPChanged();
+
 	if (gWPNum >= MAX_WPARRAY_SIZE)
 	{
 		return;
@@ -425,6 +612,8 @@ void CreateNewWP_FromObject(wpobject_t *wp)
 
 void RemoveWP(void)
 {
+	WPChanged();
+
 	if (gWPNum <= 0)
 	{
 		return;
@@ -494,6 +683,8 @@ void RemoveWP_InTrail(int afterindex)
 		return;
 	}
 
+	WPChanged();
+
 	i = 0;
 
 	while (i <= gWPNum)
@@ -545,6 +736,8 @@ int CreateNewWP_InTrail(vec3_t origin, int flags, int afterindex)
 		return 0;
 	}
 
+	WPChanged();
+
 	if (afterindex < 0 || afterindex >= gWPNum)
 	{
 		trap->Print(S_COLOR_YELLOW "Waypoint number %i does not exist\n", afterindex);
@@ -623,6 +816,8 @@ int CreateNewWP_InsertUnder(vec3_t origin, int flags, int afterindex)
 		return 0;
 	}
 
+	WPChanged();
+
 	if (afterindex < 0 || afterindex >= gWPNum)
 	{
 		trap->Print(S_COLOR_YELLOW "Waypoint number %i does not exist\n", afterindex);
@@ -736,6 +931,7 @@ void WPFlagsModify(int wpnum, int flags)
 	}
 
 	gWPArray[wpnum]->flags = flags;
+	WPChanged();
 }
 
 static int NotWithinRange(int base, int extent)
@@ -1656,15 +1852,9 @@ float botGlobalNavWeaponWeights[WP_NUM_WEAPONS] =
 
 int GetNearestVisibleWPToItem(vec3_t org, int ignore)
 {
-	int i;
-	float bestdist;
-	float flLen;
-	int bestindex;
-	vec3_t a, mins, maxs;
-
-	i = 0;
-	bestdist = 64; //has to be less than 64 units to the item or it isn't safe enough
-	bestindex = -1;
+	static int nearby[MAX_WPARRAY_SIZE];
+	int i, numNearby;
+	vec3_t mins, maxs;
 
 	mins[0] = -15;
 	mins[1] = -15;
@@ -1673,26 +1863,22 @@ int GetNearestVisibleWPToItem(vec3_t org, int ignore)
 	maxs[1] = 15;
 	maxs[2] = 0;
 
-	while (i < gWPNum)
+	//has to be less than 64 units to the item or it isn't safe enough
+	numNearby = GetNearbyWPs(org, 64, nearby, MAX_WPARRAY_SIZE);
+
+	for (i = 0; i < numNearby; i++)
 	{
-		if (gWPArray[i] && gWPArray[i]->inuse &&
-			gWPArray[i]->origin[2]-15 < org[2] &&
-			gWPArray[i]->origin[2]+15 > org[2])
-		{
-			VectorSubtract(org, gWPArray[i]->origin, a);
-			flLen = VectorLength(a);
+		wpobject_t *wp = gWPArray[nearby[i]];
 
-			if (flLen < bestdist && trap->InPVS(org, gWPArray[i]->origin) && OrgVisibleBox(org, mins, maxs, gWPArray[i]->origin, ignore))
-			{
-				bestdist = flLen;
-				bestindex = i;
-			}
+		if (wp->origin[2]-15 < org[2] &&
+			wp->origin[2]+15 > org[2] &&
+			trap->InPVS(org, wp->origin) && OrgVisibleBox(org, mins, maxs, wp->origin, ignore))
+		{
+			return nearby[i];
 		}
-
-		i++;
 	}
 
-	return bestindex;
+	return -1;
 }
 
 void CalculateWeightGoals(void)
@@ -3530,6 +3716,8 @@ int AcceptBotCommand(char *cmd, gentity_t *pl)
 			i++;
 		}
 
+		WPChanged();
+
 		return 1;
 	}
 
@@ -34,11 +34,18 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define	TIMER_LAND      130
 #define	TIMER_GESTURE   (34*66+50)
 #define	OVERCLIP        1.001F
+#define	PM_TRACE_CACHE  2 // the near and far ground traces
 
 // ======================================================================
 // EXTERN VARIABLE
 // ======================================================================
 
+struct pmTraceCache_t {
+	vec3_t		start, end, mins, maxs;
+	int			contentMask;
+	trace_t		trace;
+};
+
 // all of the locals will be zeroed before each pmove, just to make damn sure we don't have any differences when running on client or server
 extern struct pml_t {
 	vec3_t		forward, right, up;
@@ -55,6 +62,10 @@ extern struct pml_t {
 	vec3_t		previous_origin;
 	vec3_t		previous_velocity;
 	int			previous_waterlevel;
+
+	// ground traces are repeated after the move, which often leaves the origin where it was
+	pmTraceCache_t	traceCache[PM_TRACE_CACHE];
+	int				numTraceCache;
 } pml;
 
 extern float pm_accelerate;
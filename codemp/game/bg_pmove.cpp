@@ -45,6 +45,8 @@ pml_t		pml;
 
 bgEntity_t *pm_entSelf = nullptr;
 
+bool bgPmoveTraceCache = true;
+
 bool gPMDoSlowFall = false;
 
 bool pm_cancelOutZoom = false;
@@ -322,6 +324,42 @@ void PM_SetSpecialMoveValues( void ) {
 
 static void PM_GroundTraceMissed( void );
 
+// pm->trace with the player's box and tracemask, answered from pml when PmoveSingle already asked the same thing.
+// Only the results of earlier traces are reused, nothing in the world moves during a pmove except through a client
+// impact, which clears the cache.
+static void PM_TraceCached( trace_t *results, const vec3_t start, const vec3_t end ) {
+	pmTraceCache_t	*cache;
+	int				i;
+
+	if ( bgPmoveTraceCache ) {
+		for ( i = 0; i < pml.numTraceCache && i < PM_TRACE_CACHE; i++ ) {
+			cache = &pml.traceCache[i];
+
+			if ( !memcmp( cache->start, start, sizeof( vec3_t ) )
+				&& !memcmp( cache->end, end, sizeof( vec3_t ) )
+				&& !memcmp( cache->mins, pm->mins, sizeof( vec3_t ) )
+				&& !memcmp( cache->maxs, pm->maxs, sizeof( vec3_t ) )
+				&& cache->contentMask == pm->tracemask )
+			{
+				*results = cache->trace;
+				return;
+			}
+		}
+	}
+
+	pm->trace( results, start, pm->mins, pm->maxs, end, pm->ps->clientNum, pm->tracemask );
+
+	if ( bgPmoveTraceCache ) {
+		cache = &pml.traceCache[pml.numTraceCache++ % PM_TRACE_CACHE];
+		VectorCopy( start, cache->start );
+		VectorCopy( end, cache->end );
+		VectorCopy( pm->mins, cache->mins );
+		VectorCopy( pm->maxs, cache->maxs );
+		cache->contentMask = pm->tracemask;
+		cache->trace = *results;
+	}
+}
+
 void PM_AddEvent( int newEvent ) {
 	BG_AddPredictableEventToPlayerstate( newEvent, 0, pm->ps );
 }
@@ -2932,7 +2970,7 @@ static void PM_GroundTraceMissed( void ) {
 		VectorCopy( pm->ps->origin, point );
 		point[2] -= 64;
 
-		pm->trace (&trace, pm->ps->origin, pm->mins, pm->maxs, point, pm->ps->clientNum, pm->tracemask);
+		PM_TraceCached( &trace, pm->ps->origin, point );
 		if ( trace.fraction == 1.0 || pm->ps->pm_type == PM_FLOAT ) {
 			if ( pm->ps->velocity[2] <= 0 && !(pm->ps->pm_flags&PMF_JUMP_HELD))
 			{
@@ -2961,7 +2999,7 @@ static void PM_GroundTraceMissed( void ) {
 		VectorCopy( pm->ps->origin, point );
 		point[2] -= 64;
 
-		pm->trace (&trace, pm->ps->origin, pm->mins, pm->maxs, point, pm->ps->clientNum, pm->tracemask);
+		PM_TraceCached( &trace, pm->ps->origin, point );
 		if ( trace.fraction == 1.0 || pm->ps->pm_type == PM_FLOAT )
 		{
 			pm->ps->inAirAnim = true;
@@ -2989,7 +3027,7 @@ static void PM_GroundTrace( void ) {
 	point[1] = pm->ps->origin[1];
 	point[2] = pm->ps->origin[2] - 0.25;
 
-	pm->trace (&trace, pm->ps->origin, pm->mins, pm->maxs, point, pm->ps->clientNum, pm->tracemask);
+	PM_TraceCached( &trace, pm->ps->origin, point );
 	pml.groundTrace = trace;
 
 	// do something corrective if the trace starts in a solid...
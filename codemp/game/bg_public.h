@@ -1305,6 +1305,7 @@ extern int              bgNumAnimEvents;
 extern animation_t bgHumanoidAnimations[MAX_TOTALANIMATIONS];
 extern bgLoadedAnim_t bgAllAnims[MAX_ANIM_FILES];
 extern bool BGPAFtextLoaded;
+extern bool bgPmoveTraceCache;
 extern const char *forceMasteryLevels[NUM_FORCE_MASTERY_LEVELS];
 extern const char *bg_customSiegeSoundNames[MAX_CUSTOM_SIEGE_SOUNDS];
 extern const char *bgToggleableSurfaces[BG_NUM_TOGGLEABLE_SURFACES];
@@ -93,6 +93,9 @@ bool PM_ClientImpact( trace_t *trace )
 
 	traceEnt = &g_entities[otherEntityNum];
 
+	// the impact can break or remove what was hit, so earlier traces may not hold any more
+	pml.numTraceCache = 0;
+
 	if( VectorLength( pm->ps->velocity ) >= 100
 		&& pm->ps->lastOnGround+100 < level.time )
 		//&& pm->ps->groundEntityNum == ENTITYNUM_NONE )
@@ -282,8 +285,6 @@ bool	PM_SlideMove( bool gravity ) {
 				d = DotProduct( dir, pm->ps->velocity );
 				VectorScale( dir, d, clipVelocity );
 
-				CrossProduct (planes[i], planes[j], dir);
-				VectorNormalize( dir );
 				d = DotProduct( dir, endVelocity );
 				VectorScale( dir, d, endClipVelocity );
 
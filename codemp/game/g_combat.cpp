@@ -4351,11 +4351,11 @@ bool G_RadiusDamage ( vec3_t origin, gentity_t *attacker, float damage, float ra
 	float		points, dist;
 	gentity_t	*ent;
 	int			entityList[MAX_GENTITIES];
+	float		distList[MAX_GENTITIES];
 	int			numListedEntities;
-	vec3_t		mins, maxs;
-	vec3_t		v;
+	radiusQuery_t	query;
 	vec3_t		dir;
-	int			i, e;
+	int			e;
 	bool	hitClient = false;
 	bool	roastPeople = false;
 
@@ -4384,37 +4384,21 @@ bool G_RadiusDamage ( vec3_t origin, gentity_t *attacker, float damage, float ra
 		radius = 1;
 	}
 
-	for ( i = 0 ; i < 3 ; i++ ) {
-		mins[i] = origin[i] - radius;
-		maxs[i] = origin[i] + radius;
-	}
+	memset( &query, 0, sizeof( query ) );
+	VectorCopy( origin, query.origin );
+	query.radius = radius;
+	query.passEntityNum = ignore ? ignore->s.number : ENTITYNUM_NONE;
 
-	numListedEntities = trap->EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+	// distance is from the edge of the bounding box
+	numListedEntities = trap->EntitiesInRadius( &query, entityList, distList, MAX_GENTITIES );
 
 	for ( e = 0 ; e < numListedEntities ; e++ ) {
 		ent = &g_entities[entityList[ e ]];
+		dist = distList[ e ];
 
-		if (ent == ignore)
-			continue;
 		if (!ent->takedamage)
 			continue;
 
-		// find the distance from the edge of the bounding box
-		for ( i = 0 ; i < 3 ; i++ ) {
-			if ( origin[i] < ent->r.absmin[i] ) {
-				v[i] = ent->r.absmin[i] - origin[i];
-			} else if ( origin[i] > ent->r.absmax[i] ) {
-				v[i] = origin[i] - ent->r.absmax[i];
-			} else {
-				v[i] = 0;
-			}
-		}
-
-		dist = VectorLength( v );
-		if ( dist >= radius ) {
-			continue;
-		}
-
 	//	if ( ent->health <= 0 )
 	//		continue;
 
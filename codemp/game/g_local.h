@@ -433,6 +433,23 @@ struct gclient_t {
 	} force;
 };
 
+// reads like an int, assigning a time also queues the entity for G_RunFrame (g_think.cpp)
+struct thinkTime_t;
+void G_ScheduleThink( const thinkTime_t *nextthink );
+
+struct thinkTime_t {
+	int time;
+
+	operator int() const { return time; }
+	thinkTime_t &operator=( int t ) {
+		time = t;
+		if ( t > 0 ) {
+			G_ScheduleThink( this );
+		}
+		return *this;
+	}
+};
+
 struct gentity_t {
 
 	// - - - - - - - - - - - - - - - -
@@ -536,7 +553,7 @@ struct gentity_t {
 	vec3_t           movedir;
 	float            mass;
 	int              setTime;
-	int              nextthink;
+	thinkTime_t      nextthink;
 	void             (*think)( gentity_t *self );
 	void             (*reached)( gentity_t *self ); // movers call this when hitting endpoint
 	void             (*blocked)( gentity_t *self, gentity_t *other );
@@ -792,6 +809,7 @@ void             ForceTeamHeal                       ( gentity_t *self );
 void             ForceTelepathy                      ( gentity_t *self );
 void             ForceThrow                          ( gentity_t *self, bool pull );
 bool             G_ActivateBehavior                  ( gentity_t *self, int bset );
+void             G_ActivateEntity                    ( gentity_t *ent );
 void             G_AddEvent                          ( gentity_t *ent, int event, int eventParm );
 void             G_AddPredictableEvent               ( gentity_t *ent, int event, int eventParm );
 void            *G_Alloc                             ( int size );
@@ -805,6 +823,7 @@ int              G_BSPIndex                          ( const char *name );
 int              G_CheckAlertEvents                  ( gentity_t *self, bool checkSight, bool checkSound, float maxSeeDist, float maxHearDist, int ignoreAlert, bool mustHaveOwner, int minAlertLevel );                                                // ignoreAlert = -1, mustHaveOwner = false, minAlertLevel = AEL_MINOR
 void             G_CheckBotSpawn                     ( void );
 void             G_CheckClientTimeouts               ( gentity_t *ent );
+void             G_CheckDormantEntity                ( gentity_t *ent );
 bool             G_CheckForDanger                    ( gentity_t *self, int alertEvent );
 void             G_CheckForDismemberment             ( gentity_t *ent, gentity_t *enemy, vec3_t point, int damage, int deathAnim, bool postDeath );
 bool             G_CheckInSolid                      ( gentity_t *self, bool fix );
@@ -837,6 +856,7 @@ const char      *G_GetStringEdString                 ( char *refSection, char *r
 int              G_IconIndex                         ( const char* name );
 void             G_InitBots                          ( void );
 void             G_InitGentity                       ( gentity_t *e );
+void             G_InitThinkScheduler                ( void );
 void             G_InitMemory                        ( void );
 void             G_InitSessionData                   ( gclient_t *client, char *userinfo, bool isBot );
 void             G_InitWorldSession                  ( void );
@@ -862,6 +882,7 @@ int              G_ModelIndex                        ( const char *name );
 void             G_MoverTouchPushTriggers            ( gentity_t *ent, vec3_t oldOrg );
 void             G_MuteSound                         ( int entnum, int channel );
 char            *G_NewString                         ( const char *string );
+int              G_NextActiveEntity                  ( int num );
 bool             G_ParseSpawnVars                    ( bool inSubBSP );
 gentity_t       *G_PickTarget                        ( char *targetname );
 void             G_PlayDoorLoopSound                 ( gentity_t *ent );
@@ -923,6 +944,7 @@ void             G_UpdateClientAnims                 ( gentity_t *self, float an
 void             G_UpdateCvars                       ( void );
 void             G_UseTargets                        ( gentity_t *ent, gentity_t *activator );
 void             G_UseTargets2                       ( gentity_t *ent, gentity_t *activator, const char *string );
+void             G_WakeThinkers                      ( void );
 void             G_WriteClientSessionData            ( gclient_t *client );
 void             G_WriteSessionData                  ( void );
 void             GetAnglesForDirection               ( const vec3_t p1, const vec3_t p2, vec3_t out );
@@ -1090,6 +1112,7 @@ bool             StringIsInteger                     ( const char *s );
 void             StopFollowing                       ( gentity_t *ent );
 void             Svcmd_AddBot_f                      ( void );
 void             Svcmd_BotList_f                     ( void );
+void             Svcmd_BotThinkStats_f               ( void );
 void             Svcmd_GameMem_f                     ( void );
 void             Svcmd_ToggleAllowVote_f             ( void );
 void             Svcmd_ToggleUserinfoValidation_f    ( void );
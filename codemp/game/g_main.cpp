@@ -212,6 +212,7 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	// initialize all entities for this game
 	memset( g_entities, 0, MAX_GENTITIES * sizeof(g_entities[0]) );
 	level.gentities = g_entities;
+	G_InitThinkScheduler();
 
 	// initialize all clients for this game
 	level.maxclients = sv_maxclients.integer;
@@ -2456,10 +2457,11 @@ void G_RunFrame( int levelTime ) {
 	trap->PrecisionTimer_Start(&timer_ItemRun);
 #endif
 
-	// go through all allocated objects
+	// go through the allocated objects that have something to do this frame
+	G_WakeThinkers();
 
-	ent = &g_entities[0];
-	for (i=0 ; i<level.num_entities ; i++, ent++) {
+	for (i=G_NextActiveEntity(-1) ; i<level.num_entities ; G_CheckDormantEntity(ent), i=G_NextActiveEntity(i)) {
+		ent = &g_entities[i];
 		if ( !ent->inuse ) {
 			continue;
 		}
@@ -30,7 +30,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #define Q3_INFINITE			16777216
 
-#define	GAME_API_VERSION	1
+#define	GAME_API_VERSION	2
 
 // entity->svFlags
 // the server does not know how to interpret most of the values
@@ -239,6 +239,20 @@ struct sharedEntity_t {
 	int				next_roff_time; //rww - npc's need to know when they're getting roff'd
 };
 
+// radiusQuery_t->flags
+#define RQF_CONE				0x00000001	// only entities whose bounds center is within coneDot of coneDir
+
+// EntitiesInRadius returns the linked entities whose bounds come closer than radius to origin, nearest first
+struct radiusQuery_t {
+	vec3_t			origin;
+	float			radius;
+	vec3_t			coneDir;			// normalized
+	float			coneDot;			// minimum dot product of coneDir and the direction to the bounds center
+	int				passEntityNum;		// never returned, ENTITYNUM_NONE to keep everything
+	int				svFlags;			// SVF_ flags an entity needs all of to be returned
+	int				flags;
+};
+
 struct T_G_ICARUS_PLAYSOUND {
 	int taskID;
 	int entID;
@@ -384,6 +398,7 @@ struct gameImport_t {
 	void		(*DebugPolygonDelete)					( int id );
 	void		(*DropClient)							( int clientNum, const char *reason );
 	int			(*EntitiesInBox)						( const vec3_t mins, const vec3_t maxs, int *list, int maxcount );
+	int			(*EntitiesInRadius)						( const radiusQuery_t *query, int *list, float *dists, int maxcount );
 	bool		(*EntityContact)						( const vec3_t mins, const vec3_t maxs, const sharedEntity_t *ent, int capsule );
 	void		(*GetConfigstring)						( int num, char *buffer, int bufferSize );
 	bool		(*GetEntityToken)						( char *buffer, int bufferSize );
@@ -414,6 +414,7 @@ constexpr svcmd_t svcmds[] = {
 	{ "addbot",                   Svcmd_AddBot_f,                   false },
 	{ "addip",                    Svcmd_AddIP_f,                    false },
 	{ "botlist",                  Svcmd_BotList_f,                  false },
+	{ "botthinkstats",            Svcmd_BotThinkStats_f,            false },
 	{ "entitylist",               Svcmd_EntityList_f,               false },
 	{ "forceteam",                Svcmd_ForceTeam_f,                false },
 	{ "game_memory",              Svcmd_GameMem_f,                  false },
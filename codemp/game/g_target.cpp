@@ -791,6 +791,7 @@ void scriptrunner_run (gentity_t *self)
 				if ( trap->ICARUS_ValidEnt( (sharedEntity_t *)self->activator ) )
 				{
 					trap->ICARUS_InitEnt( (sharedEntity_t *)self->activator );
+					G_ActivateEntity( self->activator );
 				}
 				else
 				{
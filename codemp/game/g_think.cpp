@@ -0,0 +1,220 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// g_think.cpp -- decides which entities G_RunFrame has to visit
+
+// Client slots, missiles, items, movers, physics objects, entities with an event to clear and entities with an ICARUS
+//	task manager are active and visited every frame. Everything else is dormant until its nextthink comes up: every
+//	assignment to nextthink queues the entity in a min-heap, and the entries that are due wake their entity at the
+//	start of the frame. Entries are not removed when an entity is rescheduled or freed, they are checked against the
+//	entity when they come up instead.
+
+#include "game/g_local.h"
+
+#define MAX_THINK_QUEUE		( MAX_GENTITIES * 4 )
+#define ACTIVE_WORDS		( MAX_GENTITIES / 32 )
+
+struct thinkQueueEntry_t {
+	int		time;
+	int		entityNum;
+};
+
+static thinkQueueEntry_t	thinkQueue[MAX_THINK_QUEUE];
+static int					numThinkQueue;
+static int					thinkQueued[MAX_GENTITIES];	// time of the latest entry for each entity, 0 for none
+static uint32_t				activeEntities[ACTIVE_WORDS];
+
+void G_InitThinkScheduler( void ) {
+	numThinkQueue = 0;
+	memset( thinkQueued, 0, sizeof( thinkQueued ) );
+	memset( activeEntities, 0, sizeof( activeEntities ) );
+}
+
+void G_ActivateEntity( gentity_t *ent ) {
+	const int num = ent - g_entities;
+
+	activeEntities[num >> 5] |= 1u << ( num & 31 );
+}
+
+static void G_DeactivateEntity( int num ) {
+	activeEntities[num >> 5] &= ~( 1u << ( num & 31 ) );
+}
+
+static bool G_ThinkQueueLess( const thinkQueueEntry_t *a, const thinkQueueEntry_t *b ) {
+	if ( a->time != b->time ) {
+		return a->time < b->time;
+	}
+	return a->entityNum < b->entityNum;
+}
+
+static void G_PushThink( int time, int entityNum ) {
+	int i = numThinkQueue++;
+
+	while ( i > 0 ) {
+		const int parent = ( i - 1 ) >> 1;
+
+		if ( thinkQueue[parent].time < time || ( thinkQueue[parent].time == time && thinkQueue[parent].entityNum < entityNum ) ) {
+			break;
+		}
+		thinkQueue[i] = thinkQueue[parent];
+		i = parent;
+	}
+
+	thinkQueue[i].time = time;
+	thinkQueue[i].entityNum = entityNum;
+	thinkQueued[entityNum] = time;
+}
+
+static void G_PopThink( void ) {
+	const thinkQueueEntry_t last = thinkQueue[--numThinkQueue];
+	int i = 0;
+
+	for ( ;; ) {
+		int child = i * 2 + 1;
+
+		if ( child >= numThinkQueue ) {
+			break;
+		}
+		if ( child + 1 < numThinkQueue && G_ThinkQueueLess( &thinkQueue[child + 1], &thinkQueue[child] ) ) {
+			child++;
+		}
+		if ( !G_ThinkQueueLess( &thinkQueue[child], &last ) ) {
+			break;
+		}
+		thinkQueue[i] = thinkQueue[child];
+		i = child;
+	}
+
+	thinkQueue[i] = last;
+}
+
+// only reachable when entities keep pushing their nextthink further out, the stale entries are dropped
+static void G_RebuildThinkQueue( void ) {
+	numThinkQueue = 0;
+	memset( thinkQueued, 0, sizeof( thinkQueued ) );
+
+	for ( int i = 0; i < level.num_entities; i++ ) {
+		const gentity_t *ent = &g_entities[i];
+
+		if ( ent->inuse && ent->nextthink > 0 ) {
+			G_PushThink( ent->nextthink, i );
+		}
+	}
+}
+
+// called when a time is assigned to an entity's nextthink
+void G_ScheduleThink( const thinkTime_t *nextthink ) {
+	const ptrdiff_t offset = (const char *)nextthink - (const char *)g_entities;
+
+	// not part of g_entities, nothing to schedule
+	if ( offset < 0 || offset >= (ptrdiff_t)sizeof( g_entities ) ) {
+		return;
+	}
+
+	gentity_t *ent = &g_entities[offset / sizeof( gentity_t )];
+	const int num = ent - g_entities;
+
+	// the entity may also have been turned into something that moves, it is visited at least once to find out
+	G_ActivateEntity( ent );
+
+	if ( thinkQueued[num] == nextthink->time ) {
+		return;
+	}
+
+	if ( numThinkQueue == MAX_THINK_QUEUE ) {
+		G_RebuildThinkQueue();
+		if ( thinkQueued[num] == nextthink->time ) {
+			return;
+		}
+	}
+
+	G_PushThink( nextthink->time, num );
+}
+
+// activates the entities whose nextthink has come up
+void G_WakeThinkers( void ) {
+	while ( numThinkQueue && thinkQueue[0].time <= level.time ) {
+		const thinkQueueEntry_t entry = thinkQueue[0];
+		gentity_t *ent = &g_entities[entry.entityNum];
+
+		G_PopThink();
+
+		if ( thinkQueued[entry.entityNum] == entry.time ) {
+			thinkQueued[entry.entityNum] = 0;
+		}
+
+		if ( ent->inuse && ent->nextthink == entry.time ) {
+			G_ActivateEntity( ent );
+		}
+	}
+}
+
+// returns the next entity after num that G_RunFrame has to visit, or level.num_entities
+int G_NextActiveEntity( int num ) {
+	num++;
+
+	// client slots are always visited
+	if ( num < MAX_CLIENTS ) {
+		return num;
+	}
+
+	while ( num < level.num_entities ) {
+		uint32_t bits = activeEntities[num >> 5] >> ( num & 31 );
+
+		if ( bits ) {
+			for ( ; !( bits & 1 ); bits >>= 1 ) {
+				num++;
+			}
+			return num < level.num_entities ? num : level.num_entities;
+		}
+		num = ( num | 31 ) + 1;
+	}
+
+	return level.num_entities;
+}
+
+// called after G_RunFrame has visited the entity, drops it until something wakes it up again
+void G_CheckDormantEntity( gentity_t *ent ) {
+	const int num = ent - g_entities;
+
+	if ( num < MAX_CLIENTS ) {
+		return;
+	}
+
+	if ( ent->inuse ) {
+		if ( ent->s.event || ent->freeAfterEvent || ent->unlinkAfterEvent ) {
+			return;
+		}
+		if ( ent->s.eType == ET_MISSILE || ent->s.eType == ET_ITEM || ent->s.eType == ET_MOVER || ent->physicsObject ) {
+			return;
+		}
+		// scripts can be started on the entity without the game knowing
+		if ( trap->ICARUS_IsInitialized( num ) ) {
+			return;
+		}
+		// due this frame but not run, e.g. set by a think further down the list
+		if ( ent->nextthink > 0 && ent->nextthink <= level.time ) {
+			return;
+		}
+	}
+
+	G_DeactivateEntity( num );
+}
@@ -200,13 +200,11 @@ gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match)
 // given an origin and a radius, return all entities that are in use that are within the list
 int G_RadiusList ( vec3_t origin, float radius,	gentity_t *ignore, bool takeDamage, gentity_t *ent_list[MAX_GENTITIES])
 {
-	float		dist;
 	gentity_t	*ent;
 	int			entityList[MAX_GENTITIES];
 	int			numListedEntities;
-	vec3_t		mins, maxs;
-	vec3_t		v;
-	int			i, e;
+	radiusQuery_t	query;
+	int			e;
 	int			ent_count = 0;
 
 	if ( radius < 1 )
@@ -214,41 +212,19 @@ int G_RadiusList ( vec3_t origin, float radius,	gentity_t *ignore, bool takeDama
 		radius = 1;
 	}
 
-	for ( i = 0 ; i < 3 ; i++ )
-	{
-		mins[i] = origin[i] - radius;
-		maxs[i] = origin[i] + radius;
-	}
+	memset( &query, 0, sizeof( query ) );
+	VectorCopy( origin, query.origin );
+	query.radius = radius;
+	query.passEntityNum = ignore ? ignore->s.number : ENTITYNUM_NONE;
 
-	numListedEntities = trap->EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+	numListedEntities = trap->EntitiesInRadius( &query, entityList, nullptr, MAX_GENTITIES );
 
 	for ( e = 0 ; e < numListedEntities ; e++ )
 	{
 		ent = &g_entities[entityList[ e ]];
 
-		if ((ent == ignore) || !(ent->inuse) || ent->takedamage != takeDamage)
-			continue;
-
-		// find the distance from the edge of the bounding box
-		for ( i = 0 ; i < 3 ; i++ )
-		{
-			if ( origin[i] < ent->r.absmin[i] )
-			{
-				v[i] = ent->r.absmin[i] - origin[i];
-			} else if ( origin[i] > ent->r.absmax[i] )
-			{
-				v[i] = origin[i] - ent->r.absmax[i];
-			} else
-			{
-				v[i] = 0;
-			}
-		}
-
-		dist = VectorLength( v );
-		if ( dist >= radius )
-		{
+		if (!(ent->inuse) || ent->takedamage != takeDamage)
 			continue;
-		}
 
 		// ok, we are within the radius, add us to the incoming list
 		ent_list[ent_count] = ent;
@@ -472,6 +448,7 @@ void G_InitGentity( gentity_t *e ) {
 	e->s.number = e - g_entities;
 	e->r.ownerNum = ENTITYNUM_NONE;
 	e->s.modelGhoul2 = 0; //assume not
+	G_ActivateEntity( e );
 
 	trap->ICARUS_FreeEnt( (sharedEntity_t *)e );	//ICARUS information must be added after this point
 }
@@ -901,6 +878,7 @@ void G_AddEvent( gentity_t *ent, int event, int eventParm ) {
 		ent->s.eventParm = eventParm;
 	}
 	ent->eventTime = level.time;
+	G_ActivateEntity( ent );
 }
 
 gentity_t *G_PlayEffect(int fxID, vec3_t org, vec3_t ang)
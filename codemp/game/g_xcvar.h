@@ -62,6 +62,7 @@ XCVAR_DEF( bot_honorableduelacceptance, "0",           nullptr, CVAR_CHEAT,
 XCVAR_DEF( bot_minplayers,              "0",           nullptr, CVAR_SERVERINFO,                                 true )
 XCVAR_DEF( bot_normgpath,               "1",           nullptr, CVAR_NONE,                                       true )
 XCVAR_DEF( bot_pvstype,                 "1",           nullptr, CVAR_CHEAT,                                      true )
+XCVAR_DEF( bot_thinkBudget,             "0",           nullptr, CVAR_NONE,                                       true )
 XCVAR_DEF( bot_wp_clearweight,          "1",           nullptr, CVAR_NONE,                                       true )
 XCVAR_DEF( bot_wp_distconnect,          "1",           nullptr, CVAR_NONE,                                       true )
 XCVAR_DEF( bot_wp_edit,                 "0",           nullptr, CVAR_CHEAT,                                      true )
@@ -1646,36 +1646,28 @@ void ForceShootLightning( gentity_t *self )
 
 	if ( self->client->ps.fd.forcePowerLevel[FP_LIGHTNING] > FORCE_LEVEL_2 )
 	{//arc
-		vec3_t	center, mins, maxs, dir, ent_org, size, v;
-		float	radius = FORCE_LIGHTNING_RADIUS, dot, dist;
-		gentity_t	*entityList[MAX_GENTITIES];
+		vec3_t	center, dir, ent_org, size;
+		float	radius = FORCE_LIGHTNING_RADIUS;
 		int			iEntityList[MAX_GENTITIES];
-		int		e, numListedEntities, i;
+		int		e, numListedEntities;
+		radiusQuery_t	query;
 
 		VectorCopy( self->client->ps.origin, center );
-		for ( i = 0 ; i < 3 ; i++ )
-		{
-			mins[i] = center[i] - radius;
-			maxs[i] = center[i] + radius;
-		}
-		numListedEntities = trap->EntitiesInBox( mins, maxs, iEntityList, MAX_GENTITIES );
 
-		i = 0;
-		while (i < numListedEntities)
-		{
-			entityList[i] = &g_entities[iEntityList[i]];
-
-			i++;
-		}
+		//must be close enough and in front of me, the cone is measured to the center of the bounds
+		memset( &query, 0, sizeof( query ) );
+		VectorCopy( center, query.origin );
+		query.radius = radius;
+		VectorCopy( forward, query.coneDir );
+		query.coneDot = 0.5f;
+		query.passEntityNum = self->s.number;
+		query.flags = RQF_CONE;
+		numListedEntities = trap->EntitiesInRadius( &query, iEntityList, nullptr, MAX_GENTITIES );
 
 		for ( e = 0 ; e < numListedEntities ; e++ )
 		{
-			traceEnt = entityList[e];
+			traceEnt = &g_entities[iEntityList[e]];
 
-			if ( !traceEnt )
-				continue;
-			if ( traceEnt == self )
-				continue;
 			if ( traceEnt->r.ownerNum == self->s.number && traceEnt->s.weapon != WP_THERMAL )//can push your own thermals
 				continue;
 			if ( !traceEnt->inuse )
@@ -1686,38 +1678,11 @@ void ForceShootLightning( gentity_t *self )
 				continue;
 			if ( !g_friendlyFire.integer && OnSameTeam(self, traceEnt))
 				continue;
-			//this is all to see if we need to start a saber attack, if it's in flight, this doesn't matter
-			// find the distance from the edge of the bounding box
-			for ( i = 0 ; i < 3 ; i++ )
-			{
-				if ( center[i] < traceEnt->r.absmin[i] )
-				{
-					v[i] = traceEnt->r.absmin[i] - center[i];
-				} else if ( center[i] > traceEnt->r.absmax[i] )
-				{
-					v[i] = center[i] - traceEnt->r.absmax[i];
-				} else
-				{
-					v[i] = 0;
-				}
-			}
-
 			VectorSubtract( traceEnt->r.absmax, traceEnt->r.absmin, size );
 			VectorMA( traceEnt->r.absmin, 0.5, size, ent_org );
 
-			//see if they're in front of me
-			//must be within the forward cone
 			VectorSubtract( ent_org, center, dir );
 			VectorNormalize( dir );
-			if ( (dot = DotProduct( dir, forward )) < 0.5 )
-				continue;
-
-			//must be close enough
-			dist = VectorLength( v );
-			if ( dist >= radius )
-			{
-				continue;
-			}
 
 			//in PVS?
 			if ( !traceEnt->r.bmodel && !trap->InPVS( ent_org, self->client->ps.origin ) )
@@ -1922,36 +1887,28 @@ int ForceShootDrain( gentity_t *self )
 
 	if ( self->client->ps.fd.forcePowerLevel[FP_DRAIN] > FORCE_LEVEL_2 )
 	{//arc
-		vec3_t	center, mins, maxs, dir, ent_org, size, v;
-		float	radius = MAX_DRAIN_DISTANCE, dot, dist;
-		gentity_t	*entityList[MAX_GENTITIES];
+		vec3_t	center, dir, ent_org, size;
+		float	radius = MAX_DRAIN_DISTANCE;
 		int			iEntityList[MAX_GENTITIES];
-		int		e, numListedEntities, i;
+		int		e, numListedEntities;
+		radiusQuery_t	query;
 
 		VectorCopy( self->client->ps.origin, center );
-		for ( i = 0 ; i < 3 ; i++ )
-		{
-			mins[i] = center[i] - radius;
-			maxs[i] = center[i] + radius;
-		}
-		numListedEntities = trap->EntitiesInBox( mins, maxs, iEntityList, MAX_GENTITIES );
 
-		i = 0;
-		while (i < numListedEntities)
-		{
-			entityList[i] = &g_entities[iEntityList[i]];
-
-			i++;
-		}
+		//must be close enough and in front of me, the cone is measured to the center of the bounds
+		memset( &query, 0, sizeof( query ) );
+		VectorCopy( center, query.origin );
+		query.radius = radius;
+		VectorCopy( forward, query.coneDir );
+		query.coneDot = 0.5f;
+		query.passEntityNum = self->s.number;
+		query.flags = RQF_CONE;
+		numListedEntities = trap->EntitiesInRadius( &query, iEntityList, nullptr, MAX_GENTITIES );
 
 		for ( e = 0 ; e < numListedEntities ; e++ )
 		{
-			traceEnt = entityList[e];
+			traceEnt = &g_entities[iEntityList[e]];
 
-			if ( !traceEnt )
-				continue;
-			if ( traceEnt == self )
-				continue;
 			if ( !traceEnt->inuse )
 				continue;
 			if ( !traceEnt->takedamage )
@@ -1964,38 +1921,11 @@ int ForceShootDrain( gentity_t *self )
 				continue;
 			if (OnSameTeam(self, traceEnt) && !g_friendlyFire.integer)
 				continue;
-			//this is all to see if we need to start a saber attack, if it's in flight, this doesn't matter
-			// find the distance from the edge of the bounding box
-			for ( i = 0 ; i < 3 ; i++ )
-			{
-				if ( center[i] < traceEnt->r.absmin[i] )
-				{
-					v[i] = traceEnt->r.absmin[i] - center[i];
-				} else if ( center[i] > traceEnt->r.absmax[i] )
-				{
-					v[i] = center[i] - traceEnt->r.absmax[i];
-				} else
-				{
-					v[i] = 0;
-				}
-			}
-
 			VectorSubtract( traceEnt->r.absmax, traceEnt->r.absmin, size );
 			VectorMA( traceEnt->r.absmin, 0.5, size, ent_org );
 
-			//see if they're in front of me
-			//must be within the forward cone
 			VectorSubtract( ent_org, center, dir );
 			VectorNormalize( dir );
-			if ( (dot = DotProduct( dir, forward )) < 0.5 )
-				continue;
-
-			//must be close enough
-			dist = VectorLength( v );
-			if ( dist >= radius )
-			{
-				continue;
-			}
 
 			//in PVS?
 			if ( !traceEnt->r.bmodel && !trap->InPVS( ent_org, self->client->ps.origin ) )
@@ -75,6 +75,13 @@ void CBlockMember::SetData( vec3_t data )
 
 void CBlockMember::SetData( void *data, int size )
 {
+	//waits store their random duration back here every time they run, so keep the buffer when it fits
+	if ( m_data && m_size == size )
+	{
+		memcpy( m_data, data, size );
+		return;
+	}
+
 	if ( m_data )
 		ICARUS_Free( m_data );
 
@@ -194,6 +194,8 @@ void ICARUS_Shutdown( void )
 		iICARUS->Delete();
 		iICARUS = nullptr;
 	}
+
+	ICARUS_ReleasePools();
 }
 
 // Frees all ICARUS resources on an entity
@@ -23,18 +23,103 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "icarus/icarus.h"
 
-// leave these two as standard mallocs for the moment, there's something weird happening in ICARUS...
+// blocks, members and tasks are created and destroyed for every script command, so allocations up to
+//	ICARUS_POOL_MAX bytes come from per size class free lists carved out of zone chunks and are reused
+//	instead of going back to the zone each time
+
+#define ICARUS_POOL_GRANULE	16
+#define ICARUS_POOL_CLASSES	8
+#define ICARUS_POOL_MAX		( ICARUS_POOL_GRANULE * ICARUS_POOL_CLASSES )
+#define ICARUS_POOL_CHUNK	( 16 * 1024 )
+
+// sits in front of every allocation, the data starts one granule further on so it keeps its alignment
+struct icarusAlloc_t {
+	icarusAlloc_t	*next;		// free list link while the slot is unused
+	int				sizeClass;	// -1 when the allocation came straight from the zone
+};
+static_assert( sizeof( icarusAlloc_t ) <= ICARUS_POOL_GRANULE, "ICARUS allocation header must fit in a granule" );
+
+struct icarusChunk_t {
+	icarusChunk_t	*next;
+};
+
+static icarusAlloc_t	*icarusFreeLists[ICARUS_POOL_CLASSES];
+static icarusChunk_t	*icarusChunks;
+static int				icarusPoolLive;
+
+static void ICARUS_GrowPool( int sizeClass )
+{
+	const int slotSize = ( sizeClass + 2 ) * ICARUS_POOL_GRANULE;
+	const int numSlots = ( ICARUS_POOL_CHUNK - ICARUS_POOL_GRANULE ) / slotSize;
+	icarusChunk_t *chunk = (icarusChunk_t *)Z_Malloc( ICARUS_POOL_CHUNK, TAG_ICARUS5, false );
+	byte *slots = (byte *)chunk + ICARUS_POOL_GRANULE;
+
+	chunk->next = icarusChunks;
+	icarusChunks = chunk;
+
+	for ( int i = numSlots - 1; i >= 0; i-- )
+	{
+		icarusAlloc_t *slot = (icarusAlloc_t *)( slots + i * slotSize );
+		slot->sizeClass = sizeClass;
+		slot->next = icarusFreeLists[sizeClass];
+		icarusFreeLists[sizeClass] = slot;
+	}
+}
 
 void *ICARUS_Malloc(int iSize)
 {
-	//return gi.Malloc(iSize, TAG_ICARUS);
-	//return malloc(iSize);
-	return Z_Malloc(iSize, TAG_ICARUS5, false);
+	icarusAlloc_t *header;
+
+	if ( iSize > ICARUS_POOL_MAX )
+	{
+		header = (icarusAlloc_t *)Z_Malloc( ICARUS_POOL_GRANULE + iSize, TAG_ICARUS5, false );
+		header->sizeClass = -1;
+		return (byte *)header + ICARUS_POOL_GRANULE;
+	}
+
+	const int sizeClass = iSize > 0 ? ( iSize - 1 ) / ICARUS_POOL_GRANULE : 0;
+
+	if ( !icarusFreeLists[sizeClass] )
+	{
+		ICARUS_GrowPool( sizeClass );
+	}
+
+	header = icarusFreeLists[sizeClass];
+	icarusFreeLists[sizeClass] = header->next;
+	icarusPoolLive++;
+
+	return (byte *)header + ICARUS_POOL_GRANULE;
 }
 
 void ICARUS_Free(void *pMem)
 {
-	//gi.Free(pMem);
-	//free(pMem);
-	Z_Free(pMem);
+	icarusAlloc_t *header = (icarusAlloc_t *)( (byte *)pMem - ICARUS_POOL_GRANULE );
+
+	if ( header->sizeClass < 0 )
+	{
+		Z_Free( header );
+		return;
+	}
+
+	header->next = icarusFreeLists[header->sizeClass];
+	icarusFreeLists[header->sizeClass] = header;
+	icarusPoolLive--;
+}
+
+// hands the pool chunks back to the zone once nothing is using them any more
+void ICARUS_ReleasePools( void )
+{
+	if ( icarusPoolLive )
+	{
+		return;
+	}
+
+	while ( icarusChunks )
+	{
+		icarusChunk_t *next = icarusChunks->next;
+		Z_Free( icarusChunks );
+		icarusChunks = next;
+	}
+
+	memset( icarusFreeLists, 0, sizeof( icarusFreeLists ) );
 }
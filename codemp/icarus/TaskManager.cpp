@@ -54,6 +54,7 @@ CTask *CTask::Create( int GUID, CBlock *block )
 	task->SetTimeStamp( 0 );
 	task->SetBlock( block );
 	task->SetGUID( GUID );
+	task->SetWaitGroup( nullptr );
 
 	return task;
 }
@@ -863,7 +864,7 @@ CTask *CTaskManager::PopTask( int flag )
 	{
 	case POP_FRONT:
 		task = m_tasks.front();
-		m_tasks.pop_front();
+		m_tasks.erase( m_tasks.begin() );
 
 		return task;
 		break;
@@ -919,7 +920,14 @@ int CTaskManager::Wait( CTask *task, bool &completed  )
 			(m_owner->GetInterface())->I_DPrintf( WL_DEBUG, "%4d wait(\"%s\"); [%d]", m_ownerID, sVal, task->GetTimeStamp() );
 		}
 
-		CTaskGroup	*group = GetTaskGroup( sVal );
+		CTaskGroup	*group = task->GetWaitGroup();
+
+		//groups live until the task manager is freed, so the name only has to be looked up once
+		if ( group == nullptr )
+		{
+			group = GetTaskGroup( sVal );
+			task->SetWaitGroup( group );
+		}
 
 		if ( group == nullptr )
 		{
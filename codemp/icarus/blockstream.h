@@ -88,12 +88,12 @@ public:
 
 	inline void *operator new( size_t size )
 	{	// Allocate the memory.
-		return Z_Malloc( size, TAG_ICARUS4, true );
+		return ICARUS_Malloc( size );
 	}
 	// Overloaded delete operator.
 	inline void operator delete( void *pRawData )
 	{	// Free the Memory.
-		Z_Free( pRawData );
+		ICARUS_Free( pRawData );
 	}
 
 	CBlockMember *Duplicate( void );
@@ -169,6 +169,16 @@ public:
 	int HasFlag( unsigned char flag )	const	{	return ( m_flags & flag );	}
 	unsigned char GetFlags( void )		const	{	return m_flags;				}
 
+	inline void *operator new( size_t size )
+	{	// Allocate the memory.
+		return ICARUS_Malloc( size );
+	}
+	// Overloaded delete operator.
+	inline void operator delete( void *pRawData )
+	{	// Free the Memory.
+		ICARUS_Free( pRawData );
+	}
+
 protected:
 
 	blockMember_v				m_members;			//List of all CBlockMembers owned by this list
@@ -32,6 +32,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 void ICARUS_Free(void* pMem);
 void* ICARUS_Malloc(int iSize);
+void ICARUS_ReleasePools(void);
 
 // ======================================================================
 // INCLUDE
@@ -37,6 +37,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 // ======================================================================
 
 class CSequencer;
+class CTaskGroup;
 
 #define MAX_TASK_NAME	64
 #define TASKFLAG_NORMAL	0x00000000
@@ -85,11 +86,26 @@ public:
 	void	SetBlock( CBlock *block )			{	m_block = block;			}
 	void	SetGUID( int id )					{	m_id = id;					}
 
+	// task group a wait( "name" ) is on, looked up the first time the wait runs
+	CTaskGroup	*GetWaitGroup( void )	const	{	return m_waitGroup;	}
+	void	SetWaitGroup( CTaskGroup *group )		{	m_waitGroup = group;	}
+
+	inline void *operator new( size_t size )
+	{	// Allocate the memory.
+		return ICARUS_Malloc( size );
+	}
+	// Overloaded delete operator.
+	inline void operator delete( void *pRawData )
+	{	// Free the Memory.
+		ICARUS_Free( pRawData );
+	}
+
 protected:
 
 	int		m_id;
 	unsigned int	m_timeStamp;
 	CBlock	*m_block;
+	CTaskGroup	*m_waitGroup;
 };
 
 class CTaskGroup
@@ -132,7 +148,7 @@ class CTaskManager
 	typedef std::map < std::string, CTaskGroup * >	taskGroupName_m;
 	typedef std::map < int, CTaskGroup * >		taskGroupID_m;
 	typedef std::vector < CTaskGroup * >			taskGroup_v;
-	typedef std::list < CTask *>					tasks_l;
+	typedef std::vector < CTask *>					tasks_l;	// a vector so the per frame pop and push of a waiting task reuses its storage
 
 public:
 
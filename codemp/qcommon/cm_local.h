@@ -172,6 +172,7 @@ extern int       c_patch_traces;
 extern int       c_pointcontents;
 extern int       c_traces;
 extern clipMap_t cmg; // rwwRMG - changed from cm
+extern thread_local bool cm_threadedTraces;
 
 
 
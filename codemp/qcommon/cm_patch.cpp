@@ -1147,7 +1147,7 @@ static inline void CM_TracePointThroughPatchCollide( traceWork_t *tw, trace_t &t
 		}
 		if ( j == facet->numBorders ) {
 			// we hit this facet
-			if ( r_debugSurfaceUpdate && r_debugSurfaceUpdate->integer) {
+			if ( r_debugSurfaceUpdate && r_debugSurfaceUpdate->integer && !cm_threadedTraces ) {
 				debugPatchCollide = pc;
 				debugFacet = facet;
 			}
@@ -1326,7 +1326,7 @@ void CM_TraceThroughPatchCollide( traceWork_t *tw, trace_t &trace, const patchCo
 				if (enterFrac < 0) {
 					enterFrac = 0;
 				}
-				if (r_debugSurfaceUpdate && r_debugSurfaceUpdate->integer) {
+				if (r_debugSurfaceUpdate && r_debugSurfaceUpdate->integer && !cm_threadedTraces) {
 					debugPatchCollide = pc;
 					debugFacet = facet;
 				}
@@ -54,6 +54,7 @@ int           CM_PointContents            ( const vec3_t p, clipHandle_t model )
 int           CM_PointLeafnum             ( const vec3_t p );
 char         *CM_SubBSPEntityString       ( int index );
 clipHandle_t  CM_TempBoxModel             ( const vec3_t mins, const vec3_t maxs, int capsule );
+void          CM_ThreadedTraces           ( bool enable );
 int           CM_TransformedPointContents ( const vec3_t p, clipHandle_t model, const vec3_t origin, const vec3_t angles );
 void          CM_TransformedBoxTrace      ( trace_t *results, const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, clipHandle_t model, int brushmask, const vec3_t origin, const vec3_t angles, int capsule );
 int           CM_WriteAreaBits            ( byte *buffer, int area );
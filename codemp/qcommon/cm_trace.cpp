@@ -32,6 +32,27 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 //#define CAPSULE_DEBUG
 
+// Set on threads that trace the world concurrently. They skip everything a trace writes to shared state: the
+//	checkcount marks, so a brush that spans several leafs may be tested more than once, which gives the same result,
+//	the trace statistics and the patch the debug surface display follows.
+thread_local bool cm_threadedTraces = false;
+
+void CM_ThreadedTraces( bool enable ) {
+	cm_threadedTraces = enable;
+}
+
+template<typename T>
+static inline bool CM_AlreadyChecked( T *item, const clipMap_t *local ) {
+	if ( cm_threadedTraces ) {
+		return false;
+	}
+	if ( item->checkcount == local->checkcount ) {
+		return true;
+	}
+	item->checkcount = local->checkcount;
+	return false;
+}
+
 // BASIC MATH
 
 void RotatePoint(vec3_t point, /*const*/ matrix3_t matrix) { // bk: FIXME
@@ -173,10 +194,9 @@ void CM_TestInLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *l
 	for (k=0 ; k<leaf->numLeafBrushes ; k++) {
 		brushnum = local->leafbrushes[leaf->firstLeafBrush+k];
 		b = &local->brushes[brushnum];
-		if (b->checkcount == local->checkcount) {
+		if ( CM_AlreadyChecked( b, local ) ) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
 
 		if ( !(b->contents & tw->contents)) {
 			continue;
@@ -195,10 +215,9 @@ void CM_TestInLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *l
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == local->checkcount ) {
+			if ( CM_AlreadyChecked( patch, local ) ) {
 				continue;	// already checked this brush in another leaf
 			}
-			patch->checkcount = local->checkcount;
 
 			if ( !(patch->contents & tw->contents)) {
 				continue;
@@ -331,11 +350,15 @@ void CM_PositionTest( traceWork_t *tw, trace_t &trace ) {
 	ll.lastLeaf = 0;
 	ll.overflowed = false;
 
-	cmg.checkcount++;
+	if ( !cm_threadedTraces ) {
+		cmg.checkcount++;
+	}
 
 	CM_BoxLeafnums_r( &ll, 0 );
 
-	cmg.checkcount++;
+	if ( !cm_threadedTraces ) {
+		cmg.checkcount++;
+	}
 
 	// test the contents of the leafs
 	for (i=0 ; i < ll.count ; i++) {
@@ -351,7 +374,9 @@ void CM_PositionTest( traceWork_t *tw, trace_t &trace ) {
 void CM_TraceThroughPatch( traceWork_t *tw, trace_t &trace, cPatch_t *patch ) {
 	float		oldFrac;
 
-	c_patch_traces++;
+	if ( !cm_threadedTraces ) {
+		c_patch_traces++;
+	}
 
 	oldFrac = trace.fraction;
 
@@ -552,10 +577,9 @@ void CM_TraceThroughLeaf( traceWork_t *tw, trace_t &trace, clipMap_t *local, cLe
 		brushnum = local->leafbrushes[leaf->firstLeafBrush+k];
 
 		b = &local->brushes[brushnum];
-		if ( b->checkcount == local->checkcount ) {
+		if ( CM_AlreadyChecked( b, local ) ) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
 
 		if ( !(b->contents & tw->contents) ) {
 			continue;
@@ -575,10 +599,9 @@ void CM_TraceThroughLeaf( traceWork_t *tw, trace_t &trace, clipMap_t *local, cLe
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == local->checkcount ) {
+			if ( CM_AlreadyChecked( patch, local ) ) {
 				continue;	// already checked this patch in another leaf
 			}
-			patch->checkcount = local->checkcount;
 
 			if ( !(patch->contents & tw->contents) ) {
 				continue;
@@ -873,11 +896,10 @@ void CM_TraceToLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *
 		brushnum = local->leafbrushes[leaf->firstLeafBrush + k];
 
 		b = &local->brushes[brushnum];
-		if ( b->checkcount == local->checkcount )
+		if ( CM_AlreadyChecked( b, local ) )
 		{
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
 
 		if ( !(b->contents & tw->contents) )
 		{
@@ -898,10 +920,9 @@ void CM_TraceToLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == local->checkcount ) {
+			if ( CM_AlreadyChecked( patch, local ) ) {
 				continue;	// already checked this patch in another leaf
 			}
-			patch->checkcount = local->checkcount;
 
 			if ( !(patch->contents & tw->contents) ) {
 				continue;
@@ -1050,9 +1071,10 @@ void CM_Trace( trace_t *trace, const vec3_t start, const vec3_t end,
 
 	cmod = CM_ClipHandleToModel( model, &local );
 
-	local->checkcount++;		// for multi-check avoidance
-
-	c_traces++;				// for statistics, may be zeroed
+	if ( !cm_threadedTraces ) {
+		local->checkcount++;	// for multi-check avoidance
+		c_traces++;				// for statistics, may be zeroed
+	}
 
 	// fill in a default trace
 	Com_Memset( &tw, 0, sizeof(tw) );
@@ -97,6 +97,8 @@ cvar_t *cl_consoleKeys;
 cvar_t *cl_consoleUseScanCode;
 cvar_t *cl_conXOffset;
 cvar_t *cl_debugMove;
+cvar_t *cl_demoIndex;
+cvar_t *cl_demoIndexInterval;
 cvar_t *cl_drawRecording;
 cvar_t *cl_enableGuid;
 cvar_t *cl_forceavidemo;
@@ -143,6 +145,7 @@ cvar_t *com_affinity;
 cvar_t *com_buildScript;
 cvar_t *com_busyWait;
 cvar_t *com_cameraMode;
+cvar_t *com_jobThreads;
 cvar_t *com_journal;
 cvar_t *com_showtrace;
 cvar_t *com_speeds;
@@ -169,6 +172,7 @@ cvar_t *fs_game;
 cvar_t *fs_homepath;
 cvar_t *fx_countScale;
 cvar_t *fx_debug;
+cvar_t *fx_jobs;
 cvar_t *fx_nearCull;
 cvar_t *g_duelWeaponDisable;
 cvar_t *g_forceBasedTeams;
@@ -220,6 +224,7 @@ cvar_t *rate;
 cvar_t *rconAddress;
 cvar_t *rconPassword;
 cvar_t *s_allowDynamicMusic;
+cvar_t *s_asyncLoad;
 cvar_t *s_debugdynamic;
 cvar_t *s_doppler;
 cvar_t *s_initsound;
@@ -227,6 +232,7 @@ cvar_t *s_khz;
 cvar_t *s_language;
 cvar_t *s_mixahead;
 cvar_t *s_mixPreStep;
+cvar_t *s_mp3Async;
 cvar_t *s_mp3overhead;
 cvar_t *s_musicVolume;
 cvar_t *s_separation;
@@ -280,6 +286,7 @@ cvar_t *sv_paused;
 cvar_t *sv_privateClients;
 cvar_t *sv_privatePassword;
 cvar_t *sv_pure;
+cvar_t *sv_queryPort;
 cvar_t *sv_ratePolicy;
 cvar_t *sv_reconnectlimit;
 cvar_t *sv_referencedPakNames;
@@ -388,6 +395,8 @@ void Com_InitCvars( void ) {
 	cl_conXOffset =             Cvar_Get( "cl_conXOffset",             "0",                                    CVAR_NONE,                                   "" );
 	cl_conXOffset =             Cvar_Get( "cl_conXOffset",             "0",                                    CVAR_NONE,                                   "" );
 	cl_debugMove =              Cvar_Get( "cl_debugMove",              "0",                                    CVAR_NONE,                                   "" );
+	cl_demoIndex =              Cvar_Get( "cl_demoIndex",              "1",                                    CVAR_ARCHIVE,                                "Keep a keyframe index next to played demos so demoseek can jump around them" );
+	cl_demoIndexInterval =      Cvar_Get( "cl_demoIndexInterval",      "10",                                   CVAR_ARCHIVE,                                "Seconds of demo between demo index keyframes" );
 	cl_drawRecording =          Cvar_Get( "cl_drawRecording",          "1",                                    CVAR_ARCHIVE,                                "" );
 	cl_enableGuid =             Cvar_Get( "cl_enableGuid",             "1",                                    CVAR_ARCHIVE_ND,                             "Enable GUID userinfo identifier" ); // enable the ja_guid player identifier in userinfo by default in OpenJK
 	cl_forceavidemo =           Cvar_Get( "cl_forceavidemo",           "0",                                    CVAR_NONE,                                   "" );
@@ -434,6 +443,7 @@ void Com_InitCvars( void ) {
 	com_buildScript =           Cvar_Get( "com_buildScript",           "0",                                    CVAR_NONE,                                   "" );
 	com_busyWait =              Cvar_Get( "com_busyWait",              "0",                                    CVAR_ARCHIVE_ND,                             "" );
 	com_cameraMode =            Cvar_Get( "com_cameraMode",            "0",                                    CVAR_CHEAT,                                  "" );
+	com_jobThreads =            Cvar_Get( "com_jobThreads",            "-1",                                   CVAR_ARCHIVE_ND | CVAR_LATCH,                "Number of worker threads for parallel jobs, -1 picks one per spare core" );
 	com_journal =               Cvar_Get( "com_journal",               "0",                                    CVAR_INIT,                                   "" );
 	com_showtrace =             Cvar_Get( "com_showtrace",             "0",                                    CVAR_CHEAT,                                  "" );
 	com_speeds =                Cvar_Get( "com_speeds",                "0",                                    CVAR_NONE,                                   "" );
@@ -460,6 +470,7 @@ void Com_InitCvars( void ) {
 	fs_homepath =               Cvar_Get( "fs_homepath",               "",                                     CVAR_INIT | CVAR_PROTECTED,                  "(Read/Write) Location for user generated files" );
 	fx_countScale =             Cvar_Get( "fx_countScale",             "1",                                    CVAR_ARCHIVE_ND,                             "" );
 	fx_debug =                  Cvar_Get( "fx_debug",                  "0",                                    CVAR_TEMP,                                   "" );
+	fx_jobs =                   Cvar_Get( "fx_jobs",                   "1",                                    CVAR_ARCHIVE_ND,                             "Update simple particles on the job threads" );
 	fx_nearCull =               Cvar_Get( "fx_nearCull",               "16",                                   CVAR_ARCHIVE_ND,                             "" );
 	g_duelWeaponDisable =       Cvar_Get( "g_duelWeaponDisable",       "1",                                    CVAR_SERVERINFO,                             "" );
 	g_forceBasedTeams =         Cvar_Get( "g_forceBasedTeams",         "0",                                    CVAR_SERVERINFO,                             "" );
@@ -512,6 +523,7 @@ void Com_InitCvars( void ) {
 	rconPassword =              Cvar_Get( "rconPassword",              "",                                     CVAR_TEMP,                                   "" );
 	rconPassword =              Cvar_Get( "rconPassword",              "",                                     CVAR_TEMP,                                   "Password for remote console access" );
 	s_allowDynamicMusic =       Cvar_Get( "s_allowDynamicMusic",       "1",                                    CVAR_ARCHIVE_ND,                             "" );
+	s_asyncLoad =               Cvar_Get( "s_asyncLoad",               "1",                                    CVAR_ARCHIVE_ND | CVAR_LATCH,                "Resample sounds registered during level load on background threads" );
 	s_debugdynamic =            Cvar_Get( "s_debugdynamic",            "0",                                    CVAR_CHEAT,                                  "" );
 	s_doppler =                 Cvar_Get( "s_doppler",                 "1",                                    CVAR_ARCHIVE_ND,                             "" );
 	s_initsound =               Cvar_Get( "s_initsound",               "1",                                    CVAR_NONE,                                   "" );
@@ -519,6 +531,7 @@ void Com_InitCvars( void ) {
 	s_language =                Cvar_Get( "s_language",                "english",                              CVAR_ARCHIVE | CVAR_NORESTART,               "Sound language" );
 	s_mixahead =                Cvar_Get( "s_mixahead",                "0.2",                                  CVAR_ARCHIVE,                                "" );
 	s_mixPreStep =              Cvar_Get( "s_mixPreStep",              "0.05",                                 CVAR_ARCHIVE,                                "" );
+	s_mp3Async =                Cvar_Get( "s_mp3Async",                "1",                                    CVAR_ARCHIVE_ND | CVAR_LATCH,                "Decode streamed MP3 sounds ahead of the mixer on a worker thread" );
 	s_mp3overhead =             Cvar_Get( "s_mp3overhead",             "0",                                    CVAR_ARCHIVE,                                "" );
 	s_musicVolume =             Cvar_Get( "s_musicVolume",             "0.25",                                 CVAR_ARCHIVE,                                "Music Volume" );
 	s_separation =              Cvar_Get( "s_separation",              "0.5",                                  CVAR_ARCHIVE,                                "" );
@@ -574,6 +587,7 @@ void Com_InitCvars( void ) {
 	sv_privateClients =         Cvar_Get( "sv_privateClients",         "0",                                    CVAR_SERVERINFO,                             "Number of reserved client slots available with password" );
 	sv_privatePassword =        Cvar_Get( "sv_privatePassword",        "",                                     CVAR_TEMP,                                   "" );
 	sv_pure =                   Cvar_Get( "sv_pure",                   "0",                                    CVAR_SYSTEMINFO,                             "Pure server" );
+	sv_queryPort =              Cvar_Get( "sv_queryPort",              "0",                                    CVAR_ARCHIVE_ND,                             "Port of a second socket whose getstatus and getinfo queries are answered by a thread of their own, 0 to disable" );
 	sv_ratePolicy =             Cvar_Get( "sv_ratePolicy",             "1",                                    CVAR_ARCHIVE_ND,                             "Determines which policy of enforcement is used for client's \"rate\" cvar" );
 	sv_reconnectlimit =         Cvar_Get( "sv_reconnectlimit",         "3",                                    CVAR_NONE,                                   "" );
 	sv_referencedPakNames =     Cvar_Get( "sv_referencedPakNames",     "",                                     CVAR_SYSTEMINFO | CVAR_ROM,                  "" );
@@ -599,6 +613,7 @@ void Com_InitCvars( void ) {
 	#endif
 	Cvar_CheckRange( scr_conspeed, 1.0f, 100.0f, false );
 	Cvar_CheckRange( sv_privateClients, 0, MAX_CLIENTS, true );
+	Cvar_CheckRange( sv_queryPort, 0, 65535, true );
 	Cvar_CheckRange( sv_ratePolicy, 1, 2, true );
 	Cvar_CheckRange( sv_snapsPolicy, 0, 2, true );
 }
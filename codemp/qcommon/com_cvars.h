@@ -99,6 +99,8 @@ extern cvar_t *cl_consoleKeys;
 extern cvar_t *cl_consoleUseScanCode;
 extern cvar_t *cl_conXOffset;
 extern cvar_t *cl_debugMove;
+extern cvar_t *cl_demoIndex;
+extern cvar_t *cl_demoIndexInterval;
 extern cvar_t *cl_drawRecording;
 extern cvar_t *cl_enableGuid;
 extern cvar_t *cl_forceavidemo;
@@ -145,6 +147,7 @@ extern cvar_t *com_affinity;
 extern cvar_t *com_buildScript;
 extern cvar_t *com_busyWait;
 extern cvar_t *com_cameraMode;
+extern cvar_t *com_jobThreads;
 extern cvar_t *com_journal;
 extern cvar_t *com_showtrace;
 extern cvar_t *com_speeds;
@@ -171,6 +174,7 @@ extern cvar_t *fs_game;
 extern cvar_t *fs_homepath;
 extern cvar_t *fx_countScale;
 extern cvar_t *fx_debug;
+extern cvar_t *fx_jobs;
 extern cvar_t *fx_nearCull;
 extern cvar_t *g_duelWeaponDisable;
 extern cvar_t *g_forceBasedTeams;
@@ -222,6 +226,7 @@ extern cvar_t *rate;
 extern cvar_t *rconAddress;
 extern cvar_t *rconPassword;
 extern cvar_t *s_allowDynamicMusic;
+extern cvar_t *s_asyncLoad;
 extern cvar_t *s_debugdynamic;
 extern cvar_t *s_doppler;
 extern cvar_t *s_initsound;
@@ -229,6 +234,7 @@ extern cvar_t *s_khz;
 extern cvar_t *s_language;
 extern cvar_t *s_mixahead;
 extern cvar_t *s_mixPreStep;
+extern cvar_t *s_mp3Async;
 extern cvar_t *s_mp3overhead;
 extern cvar_t *s_musicVolume;
 extern cvar_t *s_separation;
@@ -284,6 +290,7 @@ extern cvar_t *sv_paused;
 extern cvar_t *sv_privateClients;
 extern cvar_t *sv_privatePassword;
 extern cvar_t *sv_pure;
+extern cvar_t *sv_queryPort;
 extern cvar_t *sv_ratePolicy;
 extern cvar_t *sv_reconnectlimit;
 extern cvar_t *sv_referencedPakNames;
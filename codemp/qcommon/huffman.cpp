@@ -29,7 +29,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/q_common.h"
 #include "qcommon/huffman.h"
 
-static int			bloc = 0;
+static thread_local int	bloc = 0;
 
 void	Huff_putBit( int bit, byte *fout, int *offset) {
 	bloc = *offset;
@@ -0,0 +1,188 @@
+/*
+===========================================================================
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// jobs.cpp -- worker threads for parallel loops
+
+#include "qcommon/q_common.h"
+#include "qcommon/com_cvar.h"
+#include "qcommon/com_cvars.h"
+#include "qcommon/jobs.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define MAX_JOB_WORKERS 8
+
+static std::thread	*jobWorkers[MAX_JOB_WORKERS];
+static int			numJobWorkers;
+
+static std::mutex				jobMutex;
+static std::condition_variable	jobWake;
+static std::condition_variable	jobDone;
+static int						jobGeneration;
+static int						jobBusyWorkers;
+static bool						jobQuit;
+
+// the batch currently being processed, only written while every worker is idle
+static jobFunc_t		jobFunc;
+static void				*jobData;
+static int				jobCount;
+static int				jobBatchSize;
+static std::atomic<int>	jobNext;
+
+static void Job_RunRanges( void )
+{
+	for ( ;; )
+	{
+		const int start = jobNext.fetch_add( jobBatchSize );
+
+		if ( start >= jobCount )
+		{
+			break;
+		}
+
+		jobFunc( jobData, start, Q_min( start + jobBatchSize, jobCount ) );
+	}
+}
+
+static void Job_WorkerLoop( void )
+{
+	int seen = 0;
+	std::unique_lock<std::mutex> lock( jobMutex );
+
+	for ( ;; )
+	{
+		jobWake.wait( lock, [&seen] { return jobQuit || jobGeneration != seen; } );
+
+		if ( jobQuit )
+		{
+			return;
+		}
+
+		seen = jobGeneration;
+
+		lock.unlock();
+		Job_RunRanges();
+		lock.lock();
+
+		if ( --jobBusyWorkers == 0 )
+		{
+			jobDone.notify_one();
+		}
+	}
+}
+
+void Job_Init( void )
+{
+	int count;
+
+	if ( numJobWorkers )
+	{
+		return;
+	}
+
+	count = com_jobThreads->integer;
+	if ( count < 0 )
+	{
+		// leave a core for the main thread
+		count = (int)std::thread::hardware_concurrency() - 1;
+	}
+	count = Com_Clampi( 0, MAX_JOB_WORKERS, count );
+
+	jobQuit = false;
+	for ( int i = 0; i < count; i++ )
+	{
+		jobWorkers[i] = new std::thread( Job_WorkerLoop );
+	}
+	numJobWorkers = count;
+
+	if ( count )
+	{
+		Com_Printf( "Job system: %i worker threads\n", count );
+	}
+}
+
+void Job_Shutdown( void )
+{
+	if ( !numJobWorkers )
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( jobMutex );
+		jobQuit = true;
+	}
+	jobWake.notify_all();
+
+	for ( int i = 0; i < numJobWorkers; i++ )
+	{
+		jobWorkers[i]->join();
+		delete jobWorkers[i];
+		jobWorkers[i] = nullptr;
+	}
+	numJobWorkers = 0;
+}
+
+int Job_NumWorkers( void )
+{
+	return numJobWorkers;
+}
+
+void Job_ParallelFor( jobFunc_t func, void *data, int count, int batchSize )
+{
+	if ( count <= 0 )
+	{
+		return;
+	}
+
+	if ( batchSize < 1 )
+	{
+		batchSize = 1;
+	}
+
+	if ( !numJobWorkers || count <= batchSize )
+	{
+		func( data, 0, count );
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( jobMutex );
+		jobFunc = func;
+		jobData = data;
+		jobCount = count;
+		jobBatchSize = batchSize;
+		jobNext = 0;
+		jobBusyWorkers = numJobWorkers;
+		jobGeneration++;
+	}
+	jobWake.notify_all();
+
+	Job_RunRanges();
+
+	std::unique_lock<std::mutex> lock( jobMutex );
+	jobDone.wait( lock, [] { return jobBusyWorkers == 0; } );
+}
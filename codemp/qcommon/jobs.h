@@ -0,0 +1,39 @@
+/*
+===========================================================================
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#pragma once
+
+// Small fixed pool of worker threads for splitting data parallel work across cores.
+// Jobs are dispatched from the main thread only and Job_ParallelFor does not return
+// until every range has been processed, so callers can treat it like a plain loop.
+
+// processes elements [start, end) of whatever data was handed to Job_ParallelFor
+typedef void (*jobFunc_t)( void *data, int start, int end );
+
+void	Job_Init( void );
+void	Job_Shutdown( void );
+int		Job_NumWorkers( void );
+
+// runs func over [0, count) in ranges of at most batchSize elements, the calling thread takes
+//	ranges as well, falls back to a single direct call when there are no workers or too little work
+void	Job_ParallelFor( jobFunc_t func, void *data, int count, int batchSize );
@@ -757,6 +757,39 @@ void MSG_WriteBits( msg_t *msg, int value, int bits ) {
 	}
 }
 
+// Appends bits that were already huffman coded into a bitstream message starting at bit 0, the bits past the end of the
+//	last byte must be zero as Huff_putBit leaves them
+void MSG_WriteCodedBits( msg_t *msg, const byte *data, int bits ) {
+	int		i, bytes, shift;
+	byte	*out;
+
+	if ( msg->oob ) {
+		Com_Error( ERR_DROP, "MSG_WriteCodedBits: oob message" );
+	}
+
+	bytes = ( bits + 7 ) >> 3;
+	if ( msg->maxsize - msg->cursize < bytes + 4 ) {
+		msg->overflowed = true;
+		return;
+	}
+
+	oldsize += bits;
+
+	out = msg->data + ( msg->bit >> 3 );
+	shift = msg->bit & 7;
+	if ( !shift ) {
+		memcpy( out, data, bytes );
+	} else {
+		for ( i = 0 ; i < bytes ; i++ ) {
+			out[i] |= data[i] << shift;
+			out[i+1] = data[i] >> ( 8 - shift );
+		}
+	}
+
+	msg->bit += bits;
+	msg->cursize = ( msg->bit >> 3 ) + 1;
+}
+
 int MSG_ReadBits( msg_t *msg, int bits ) {
 	int			value;
 	int			get;
@@ -990,7 +1023,7 @@ float MSG_ReadFloat( msg_t *msg ) {
 }
 
 char *MSG_ReadString( msg_t *msg ) {
-	static char	string[MAX_STRING_CHARS];
+	static thread_local char	string[MAX_STRING_CHARS];
 	int		c;
 	unsigned int l;
 
@@ -1028,7 +1061,7 @@ char *MSG_ReadString( msg_t *msg ) {
 }
 
 char *MSG_ReadBigString( msg_t *msg ) {
-	static char	string[BIG_INFO_STRING];
+	static thread_local char	string[BIG_INFO_STRING];
 	int		c;
 	unsigned int l;
 
@@ -1053,7 +1086,7 @@ char *MSG_ReadBigString( msg_t *msg ) {
 }
 
 char *MSG_ReadStringLine( msg_t *msg ) {
-	static char	string[MAX_STRING_CHARS];
+	static thread_local char	string[MAX_STRING_CHARS];
 	int		c;
 	unsigned int l;
 
@@ -91,6 +91,20 @@ static struct sockaddr_in	socksRelayAddr;
 
 static SOCKET	ip_socket = INVALID_SOCKET;
 static SOCKET	socks_socket = INVALID_SOCKET;
+static SOCKET	ip_querySocket = INVALID_SOCKET;
+
+// peers whose latest packet came in on the query socket, anything sent to them goes out through that socket as well
+//	so the replies come from the address they sent to, only touched by the main thread
+#define	MAX_QUERY_ROUTES	256
+
+struct queryRoute_t {
+	netadr_t	adr;
+	int			lastUsed;
+};
+
+static queryRoute_t	queryRoutes[MAX_QUERY_ROUTES];
+static int			numQueryRoutes;
+static int			queryRouteSequence;
 
 #define	MAX_IPS		16
 static	int		numIP;
@@ -208,6 +222,99 @@ bool Sys_StringToAdr( const char *s, netadr_t *a ) {
 	return true;
 }
 
+static queryRoute_t *NET_FindQueryRoute( const netadr_t *adr ) {
+	for ( int i = 0; i < numQueryRoutes; i++ ) {
+		if ( NET_CompareAdr( queryRoutes[i].adr, *adr ) ) {
+			return &queryRoutes[i];
+		}
+	}
+
+	return nullptr;
+}
+
+// called for every packet the server takes over from the query thread, the least recently used route is replaced
+//	when the table is full
+void NET_AddQueryRoute( netadr_t adr ) {
+	queryRoute_t *route;
+
+	if ( ip_querySocket == INVALID_SOCKET || adr.type != NA_IP ) {
+		return;
+	}
+
+	route = NET_FindQueryRoute( &adr );
+	if ( !route ) {
+		if ( numQueryRoutes < MAX_QUERY_ROUTES ) {
+			route = &queryRoutes[numQueryRoutes++];
+		}
+		else {
+			route = &queryRoutes[0];
+			for ( int i = 1; i < numQueryRoutes; i++ ) {
+				if ( queryRoutes[i].lastUsed - route->lastUsed < 0 ) {
+					route = &queryRoutes[i];
+				}
+			}
+		}
+		route->adr = adr;
+	}
+
+	route->lastUsed = ++queryRouteSequence;
+}
+
+// the peer moved over to the main socket
+static void NET_RemoveQueryRoute( const netadr_t *adr ) {
+	queryRoute_t *route = NET_FindQueryRoute( adr );
+
+	if ( route ) {
+		*route = queryRoutes[--numQueryRoutes];
+	}
+}
+
+// waits up to msec for a packet on the query socket, returns its length or 0, does not print so the query thread
+//	can read with it
+int NET_GetQueryPacket( netadr_t *net_from, byte *data, int maxsize, int msec ) {
+	struct timeval		timeout;
+	struct sockaddr_in	from;
+	socklen_t			fromlen;
+	fd_set				fdset;
+	int					ret;
+
+	if ( ip_querySocket == INVALID_SOCKET ) {
+		return 0;
+	}
+
+	FD_ZERO( &fdset );
+	FD_SET( ip_querySocket, &fdset );
+	timeout.tv_sec = msec / 1000;
+	timeout.tv_usec = ( msec % 1000 ) * 1000;
+
+	if ( select( ip_querySocket + 1, &fdset, nullptr, nullptr, &timeout ) <= 0 ) {
+		return 0;
+	}
+
+	fromlen = sizeof( from );
+	ret = recvfrom( ip_querySocket, (char *)data, maxsize, 0, (struct sockaddr *)&from, &fromlen );
+
+	// oversize packets are dropped like they are on the main socket
+	if ( ret == SOCKET_ERROR || ret >= maxsize || from.sin_family != AF_INET ) {
+		return 0;
+	}
+
+	SockadrToNetadr( &from, net_from );
+	return ret;
+}
+
+// quiet like NET_GetQueryPacket, the query socket is never relayed through SOCKS
+void NET_SendQueryPacket( int length, const void *data, netadr_t to ) {
+	struct sockaddr_in addr;
+
+	if ( ip_querySocket == INVALID_SOCKET || to.type != NA_IP ) {
+		return;
+	}
+
+	NetadrToSockadr( &to, &addr );
+	sendto( ip_querySocket, (const char *)data, length, 0, (sockaddr *)&addr, sizeof( addr ) );
+}
+
 // Receive one packet
 #ifdef _DEBUG
 int	recvfromCount;
@@ -257,6 +364,10 @@ bool NET_GetPacket( netadr_t *net_from, msg_t *net_message, fd_set *fdr ) {
 		net_message->readcount = 0;
 	}
 
+	if ( numQueryRoutes ) {
+		NET_RemoveQueryRoute( net_from );
+	}
+
 	if( ret >= net_message->maxsize ) {
 		Com_Printf( "Oversize packet from %s\n", NET_AdrToString (*net_from) );
 		return false;
@@ -277,6 +388,11 @@ void Sys_SendPacket( int length, const void *data, netadr_t to ) {
 		return;
 	}
 
+	if ( numQueryRoutes && to.type == NA_IP && NET_FindQueryRoute( &to ) ) {
+		NET_SendQueryPacket( length, data, to );
+		return;
+	}
+
 	if ( ip_socket == INVALID_SOCKET ) {
 		return;
 	}
@@ -765,6 +881,30 @@ void NET_OpenIP( void )
 	}
 }
 
+// opened and closed by the server on the main thread, while no thread is reading from it
+bool NET_OpenQuerySocket( int port ) {
+	int err;
+
+	NET_CloseQuerySocket();
+
+	if ( !networkingEnabled || !( net_enabled->integer & NET_ENABLEV4 ) ) {
+		return false;
+	}
+
+	ip_querySocket = NET_IPSocket( net_ip->string, port, &err );
+
+	return ip_querySocket != INVALID_SOCKET;
+}
+
+void NET_CloseQuerySocket( void ) {
+	if ( ip_querySocket != INVALID_SOCKET ) {
+		closesocket( ip_querySocket );
+		ip_querySocket = INVALID_SOCKET;
+	}
+
+	numQueryRoutes = 0;
+}
+
 static bool NET_GetCvars( void ) {
 	int	modified =
 		net_enabled->modified +
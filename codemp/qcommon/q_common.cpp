@@ -30,6 +30,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/com_cvars.h"
 #include "qcommon/game_version.h"
 #include "qcommon/huffman.h"
+#include "qcommon/jobs.h"
 #include "qcommon/stringed_ingame.h"
 #include "sys/sys_local.h"
 
@@ -521,7 +522,7 @@ int Com_FilterPath(char *filter, char *name, int casesensitive)
 	return Com_Filter(new_filter, new_name, casesensitive);
 }
 
-int Com_HashKey(char *string, int maxlen) {
+int Com_HashKey(const char *string, int maxlen) {
 	int hash, i;
 
 	hash = 0;
@@ -1001,6 +1002,8 @@ void Com_Init( char *commandLine ) {
 
 		Sys_SetProcessorAffinity();
 
+		Job_Init();
+
 		// Pick a random port value
 		Com_RandomBytes( (byte*)&qport, sizeof(int) );
 		Netchan_Init( qport );	// pick a port value that should be nice and random
@@ -1325,6 +1328,8 @@ void Com_Shutdown (void)
 	}
 
 	MSG_shutdownHuffman();
+
+	Job_Shutdown();
 }
 
 // fills string array with len radom bytes, peferably from the OS randomizer
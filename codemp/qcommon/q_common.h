@@ -341,7 +341,7 @@ int             Com_EventLoop                 ( void );
 int             Com_Filter                    ( char *filter, char *name, int casesensitive );
 int             Com_FilterPath                ( char *filter, char *name, int casesensitive );
 void            Com_Frame                     ( void );
-int             Com_HashKey                   ( char *string, int maxlen );
+int             Com_HashKey                   ( const char *string, int maxlen );
 void            Com_Init                      ( char *commandLine );
 void            Com_InitHunkMemory            ( void );
 void            Com_InitZoneMemory            ( void );
@@ -458,6 +458,7 @@ void            MSG_WriteBigString            ( msg_t *sb, const char *s );
 void            MSG_WriteBits                 ( msg_t *msg, int value, int bits );
 void            MSG_WriteByte                 ( msg_t *sb, int c );
 void            MSG_WriteChar                 ( msg_t *sb, int c );
+void            MSG_WriteCodedBits            ( msg_t *msg, const byte *data, int bits );
 void            MSG_WriteData                 ( msg_t *buf, const void *data, int length );
 void            MSG_WriteDeltaEntity          ( msg_t *msg, entityState_t *from, entityState_t *to, bool force );
 void            MSG_WriteDeltaUsercmdKey      ( msg_t *msg, int key, usercmd_t *from, usercmd_t *to );
@@ -465,18 +466,23 @@ void            MSG_WriteFloat                ( msg_t *sb, float f );
 void            MSG_WriteLong                 ( msg_t *sb, int c );
 void            MSG_WriteShort                ( msg_t *sb, int c );
 void            MSG_WriteString               ( msg_t *sb, const char *s );
+void            NET_AddQueryRoute             ( netadr_t adr );
 const char     *NET_AdrToString               ( netadr_t a );
+void            NET_CloseQuerySocket          ( void );
 bool            NET_CompareAdr                ( netadr_t a, netadr_t b );
 bool            NET_CompareBaseAdr            ( netadr_t a, netadr_t b );
 bool            NET_CompareBaseAdrMask        ( netadr_t a, netadr_t b, int netmask );
 void            NET_Config                    ( bool enableNetworking );
 bool            NET_GetLoopPacket             ( netsrc_e sock, netadr_t *net_from, msg_t *net_message );
+int             NET_GetQueryPacket            ( netadr_t *net_from, byte *data, int maxsize, int msec );
 void            NET_Init                      ( void );
 bool            NET_IsLocalAddress            ( netadr_t adr );
+bool            NET_OpenQuerySocket           ( int port );
 void            NET_OutOfBandData             ( netsrc_e sock, netadr_t adr, byte *format, int len );
 void            NET_OutOfBandPrint            ( netsrc_e net_socket, netadr_t adr, const char *format, ... );
 void            NET_Restart_f                 ( void );
 void            NET_SendPacket                ( netsrc_e sock, int length, const void *data, netadr_t to );
+void            NET_SendQueryPacket           ( int length, const void *data, netadr_t to );
 void            NET_Shutdown                  ( void );
 void            NET_Sleep                     ( int msec );
 bool            NET_StringToAdr               ( const char *s, netadr_t *a );
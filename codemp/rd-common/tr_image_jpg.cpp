@@ -226,6 +226,7 @@ typedef struct my_destination_mgr_t {
 
 	byte* outfile;		/* target stream */
 	int	size;
+	bool	overflowed;
 } my_destination_mgr;
 
 typedef my_destination_mgr * my_dest_ptr;
@@ -237,6 +238,7 @@ static void init_destination (j_compress_ptr cinfo)
 
 	dest->pub.next_output_byte = dest->outfile;
 	dest->pub.free_in_buffer = dest->size;
+	dest->overflowed = false;
 }
 
 // Empty the output buffer --- called whenever buffer fills up.
@@ -252,16 +254,17 @@ static void init_destination (j_compress_ptr cinfo)
 // next_output_byte & free_in_buffer indicate where the restart point will be if the current call returns FALSE.
 // Data beyond this point will be regenerated after resumption, so do not write it out when emptying the buffer
 //	externally.
+// The image doesn't fit. This may be running on the AVI thread where Com_Error can't be raised, so the compressor
+//	is left to finish into the start of the buffer again and RE_SaveJPGToBuffer reports the failure instead.
 static boolean empty_output_buffer (j_compress_ptr cinfo)
 {
 	my_dest_ptr dest = (my_dest_ptr) cinfo->dest;
 
-	jpeg_destroy_compress(cinfo);
-
-	// Make crash fatal or we would probably leak memory.
-	Com_Error(ERR_FATAL, "Output buffer for encoded JPEG image has insufficient size of %d bytes", dest->size);
+	dest->overflowed = true;
+	dest->pub.next_output_byte = dest->outfile;
+	dest->pub.free_in_buffer = dest->size;
 
-	return FALSE;
+	return TRUE;
 }
 
 // Terminate destination --- called by jpeg_finish_compress after all data has been written.
@@ -300,7 +303,7 @@ static void jpegDest (j_compress_ptr cinfo, byte* outfile, int size)
 
 // Encodes JPEG from image in image_buffer and writes to buffer.
 // Expects RGB input data
-// Convert raw image data to JPEG format and store in buffer.
+// Convert raw image data to JPEG format and store in buffer. Returns 0 if the result didn't fit in bufSize.
 size_t RE_SaveJPGToBuffer(byte *buffer, size_t bufSize, int quality,
 	int image_width, int image_height, byte *image_buffer, int padding)
 {
@@ -361,7 +364,7 @@ size_t RE_SaveJPGToBuffer(byte *buffer, size_t bufSize, int quality,
 	jpeg_finish_compress(&cinfo);
 
 	dest = (my_dest_ptr) cinfo.dest;
-	outcount = dest->size - dest->pub.free_in_buffer;
+	outcount = dest->overflowed ? 0 : dest->size - dest->pub.free_in_buffer;
 
 	/* Step 7: release JPEG compression object */
 	jpeg_destroy_compress(&cinfo);
@@ -380,7 +383,10 @@ void RE_SaveJPG(const char * filename, int quality, int image_width, int image_h
 	out = (byte *)Hunk_AllocateTempMemory(bufSize);
 
 	bufSize = RE_SaveJPGToBuffer(out, bufSize, quality, image_width, image_height, image_buffer, padding);
-	ri.FS_WriteFile(filename, out, bufSize);
+	if (bufSize)
+		ri.FS_WriteFile(filename, out, bufSize);
+	else
+		ri.Printf(PRINT_WARNING, "Encoded JPEG image for %s didn't fit in %d bytes\n", filename, image_width * image_height * 3);
 
 	Hunk_FreeTempMemory(out);
 }
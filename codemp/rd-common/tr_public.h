@@ -38,7 +38,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 // DEFINE
 // ======================================================================
 
-#define	REF_API_VERSION 9
+#define	REF_API_VERSION 11
 
 // ======================================================================
 // STRUCT
@@ -139,7 +139,12 @@ struct refexport_t {
 	bool			(*RegisterModels_LevelLoadEnd)			( bool bDeleteEverythingNotUsedThisLevel );
 
 	// AVI recording
-	void				(*TakeVideoFrame)						( int h, int w, byte* captureBuffer, byte *encodeBuffer, bool motionJpeg );
+	// TakeVideoFrame only reads the frame back and hands it to CL_QueueAVIVideoFrame, possibly a couple of frames late
+	void				(*TakeVideoFrame)						( int w, int h, byte *captureBuffer, bool firstFrame );
+	// FlushVideoFrame hands the oldest frame still held back the same way, false once there are none left
+	bool				(*FlushVideoFrame)						( int w, int h, byte *captureBuffer );
+	// safe to call from a thread other than the renderer's
+	size_t				(*SaveJPGToBuffer)						( byte *buffer, size_t bufSize, int quality, int image_width, int image_height, byte *image_buffer, int padding );
 
 	// G2 stuff
 	void				(*InitSkins)							( void );
@@ -312,7 +317,7 @@ struct refimport_t {
 	status_e		(*CIN_RunCinematic)					( int handle );
 	int				(*CIN_PlayCinematic)				( const char *arg0, int xpos, int ypos, int width, int height, int bits );
 	void			(*CIN_UploadCinematic)				( int handle );
-	void			(*CL_WriteAVIVideoFrame)			( const byte *imageBuffer, int size );
+	void			(*CL_QueueAVIVideoFrame)			( const byte *imageBuffer, int size );
 
 	// g2 data access
 	char *			(*GetSharedMemory)					( void ); // cl.mSharedMemory
@@ -1188,7 +1188,7 @@ const char    *RE_ShaderNameFromIndex              ( int index );
 void           RE_Shutdown                         ( bool destroyWindow );
 void           RE_StretchPic                       ( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );
 void           RE_StretchRaw                       ( int x, int y, int w, int h, int cols, int rows, const byte *data, int client, bool dirty );
-void           RE_TakeVideoFrame                   ( int width, int height, byte *captureBuffer, byte *encodeBuffer, bool motionJpeg );
+void           RE_TakeVideoFrame                   ( int width, int height, byte *captureBuffer, bool firstFrame );
 void           RE_UploadCinematic                  ( int cols, int rows, const byte *data, int client, bool dirty );
 bool           ShaderHashTableExists               ( void );
 
@@ -72,6 +72,10 @@ void R_PerformanceCounters( void ) {
 		ri.Printf( PRINT_ALL,  "Tex MB %.2f + buffers %.2f MB = Total %.2fMB\n",
 			texSize, backBuff*2+depthBuff+stencilBuff, texSize+backBuff*2+depthBuff+stencilBuff);
 	}
+	else if (r_speeds->integer == 8) {
+		ri.Printf( PRINT_ALL, "g2 skin cache hits:%i misses:%i skinned verts:%i\n",
+			backEnd.pc.c_g2SkinCacheHits, backEnd.pc.c_g2SkinCacheMisses, backEnd.pc.c_g2SkinnedVerts );
+	}
 
 	memset( &tr.pc, 0, sizeof( tr.pc ) );
 	memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
@@ -394,7 +398,7 @@ void RE_EndFrame( int *frontEndMsec, int *backEndMsec ) {
 	backEnd.pc.msec = 0;
 }
 
-void RE_TakeVideoFrame( int width, int height, byte *captureBuffer, byte *encodeBuffer, bool motionJpeg )
+void RE_TakeVideoFrame( int width, int height, byte *captureBuffer, bool firstFrame )
 {
 	videoFrameCommand_t *cmd;
 
@@ -410,6 +414,5 @@ void RE_TakeVideoFrame( int width, int height, byte *captureBuffer, byte *encode
 	cmd->width = width;
 	cmd->height = height;
 	cmd->captureBuffer = captureBuffer;
-	cmd->encodeBuffer = encodeBuffer;
-	cmd->motionJpeg = motionJpeg;
+	cmd->firstFrame = firstFrame;
 }
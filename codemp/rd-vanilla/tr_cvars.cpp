@@ -60,6 +60,7 @@ cvar_t *r_ext_compress_lightmaps;
 cvar_t *r_ext_compress_textures;
 cvar_t *r_ext_gamma_control;
 cvar_t *r_ext_multitexture;
+cvar_t *r_ext_pixel_buffer_object;
 cvar_t *r_ext_preferred_tc_method;
 cvar_t *r_ext_texture_env_add;
 cvar_t *r_ext_texture_filter_anisotropic;
@@ -72,6 +73,7 @@ cvar_t *r_fullscreen;
 cvar_t *r_gamma;
 cvar_t *r_gammaShaders;
 cvar_t *r_Ghoul2AnimSmooth;
+cvar_t *r_Ghoul2SkinCache;
 cvar_t *r_Ghoul2UnSqashAfterSmooth;
 cvar_t *r_ignore;
 cvar_t *r_ignoreGLErrors;
@@ -201,6 +203,7 @@ void R_InitCvars( void ) {
 	r_ext_compress_textures =          ri.Cvar_Get( "r_ext_compress_textures",          "1",                              CVAR_ARCHIVE_ND | CVAR_LATCH,  "" );
 	r_ext_gamma_control =              ri.Cvar_Get( "r_ext_gamma_control",              "1",                              CVAR_ARCHIVE_ND | CVAR_LATCH,  "" );
 	r_ext_multitexture =               ri.Cvar_Get( "r_ext_multitexture",               "1",                              CVAR_ARCHIVE_ND | CVAR_LATCH,  "" );
+	r_ext_pixel_buffer_object =        ri.Cvar_Get( "r_ext_pixel_buffer_object",        "1",                              CVAR_ARCHIVE_ND | CVAR_LATCH,  "" );
 	r_ext_preferred_tc_method =        ri.Cvar_Get( "r_ext_preferred_tc_method",        "0",                              CVAR_ARCHIVE_ND | CVAR_LATCH,  "" );
 	r_ext_texture_env_add =            ri.Cvar_Get( "r_ext_texture_env_add",            "1",                              CVAR_ARCHIVE_ND | CVAR_LATCH,  "" );
 	r_ext_texture_filter_anisotropic = ri.Cvar_Get( "r_ext_texture_filter_anisotropic", "16",                             CVAR_ARCHIVE_ND,               "" );
@@ -213,6 +216,7 @@ void R_InitCvars( void ) {
 	r_gamma =                          ri.Cvar_Get( "r_gamma",                          "1",                              CVAR_ARCHIVE_ND,               "" );
 	r_gammaShaders =                   ri.Cvar_Get( "r_gammaShaders",                   "0",                              CVAR_ARCHIVE_ND | CVAR_LATCH,  "" );
 	r_Ghoul2AnimSmooth =               ri.Cvar_Get( "r_Ghoul2AnimSmooth",               "0.3",                            CVAR_NONE,                     "" );
+	r_Ghoul2SkinCache =                ri.Cvar_Get( "r_Ghoul2SkinCache",                "1",                              CVAR_ARCHIVE_ND,               "Reuse skinned ghoul2 vertices across passes within a frame" );
 	r_Ghoul2UnSqashAfterSmooth =       ri.Cvar_Get( "r_Ghoul2UnSqashAfterSmooth",       "1",                              CVAR_NONE,                     "" );
 	r_ignore =                         ri.Cvar_Get( "r_ignore",                         "1",                              CVAR_CHEAT,                    "" );
 	r_ignoreGLErrors =                 ri.Cvar_Get( "r_ignoreGLErrors",                 "1",                              CVAR_ARCHIVE_ND,               "" );
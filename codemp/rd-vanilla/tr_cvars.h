@@ -87,6 +87,7 @@ extern cvar_t* r_ext_compress_lightmaps;
 extern cvar_t* r_ext_compress_textures;
 extern cvar_t* r_ext_gamma_control;
 extern cvar_t* r_ext_multitexture;
+extern cvar_t* r_ext_pixel_buffer_object;
 extern cvar_t* r_ext_preferred_tc_method;
 extern cvar_t* r_ext_texture_env_add;
 extern cvar_t* r_ext_texture_filter_anisotropic;
@@ -99,6 +100,7 @@ extern cvar_t* r_fullscreen;
 extern cvar_t* r_gamma;
 extern cvar_t* r_gammaShaders;
 extern cvar_t* r_Ghoul2AnimSmooth;
+extern cvar_t* r_Ghoul2SkinCache;
 extern cvar_t* r_Ghoul2UnSqashAfterSmooth;
 extern cvar_t* r_ignore;
 extern cvar_t* r_ignoreGLErrors;
@@ -34,6 +34,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "qcommon/disablewarnings.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define G2_SIMD_SKINNING
+	#include <xmmintrin.h>
+#endif
+
 #ifdef G2_PERFORMANCE_ANALYSIS
 #include "qcommon/timing.h"
 
@@ -3306,6 +3311,218 @@ static inline float G2_GetVertBoneWeightNotSlow( const mdxmVertex_t *pVert, cons
 	return fBoneWeight;
 }
 
+/*
+RB_G2SkinSurface
+
+Deforms every vertex of a surface by its weighted bones. The bone references of the surface are
+resolved once up front (transposed into columns for the SSE path), so each vertex costs a few
+multiply-adds per weight instead of a bone cache lookup and three dot products per weight.
+Normals are taken from the first bone only, the same as the original per-vertex loop.
+*/
+static void RB_G2SkinSurface( const mdxmSurface_t *surface, CBoneCache *bones, vec4_t *outXYZ, vec4_t *outNormal )
+{
+	const int			*piBoneReferences = (const int *)((const byte *)surface + surface->ofsBoneReferences);
+	const mdxmVertex_t	*v = (const mdxmVertex_t *)((const byte *)surface + surface->ofsVerts);
+	const int			numVerts = surface->numVerts;
+	const int			numBoneRefs = surface->numBoneReferences;
+	int					i, k;
+
+	assert( numBoneRefs <= iMAX_G2_BONEREFS_PER_SURFACE );
+
+#ifdef G2_SIMD_SKINNING
+	__m128 boneCols[iMAX_G2_BONEREFS_PER_SURFACE][4];
+
+	for ( i = 0; i < numBoneRefs; i++ )
+	{
+		const mdxaBone_t &bone = bones->EvalRender( piBoneReferences[i] );
+
+		boneCols[i][0] = _mm_setr_ps( bone.matrix[0][0], bone.matrix[1][0], bone.matrix[2][0], 0.0f );
+		boneCols[i][1] = _mm_setr_ps( bone.matrix[0][1], bone.matrix[1][1], bone.matrix[2][1], 0.0f );
+		boneCols[i][2] = _mm_setr_ps( bone.matrix[0][2], bone.matrix[1][2], bone.matrix[2][2], 0.0f );
+		boneCols[i][3] = _mm_setr_ps( bone.matrix[0][3], bone.matrix[1][3], bone.matrix[2][3], 1.0f );
+	}
+
+	for ( i = 0; i < numVerts; i++, v++ )
+	{
+		const int		iNumWeights = G2_GetVertWeights( v );
+		const __m128	x = _mm_set1_ps( v->vertCoords[0] );
+		const __m128	y = _mm_set1_ps( v->vertCoords[1] );
+		const __m128	z = _mm_set1_ps( v->vertCoords[2] );
+		const __m128	*cols = boneCols[G2_GetVertBoneIndex( v, 0 )];
+		__m128			pos, nrm;
+
+		nrm = _mm_add_ps( _mm_add_ps( _mm_mul_ps( cols[0], _mm_set1_ps( v->normal[0] ) ),
+									  _mm_mul_ps( cols[1], _mm_set1_ps( v->normal[1] ) ) ),
+									  _mm_mul_ps( cols[2], _mm_set1_ps( v->normal[2] ) ) );
+		pos = _mm_add_ps( _mm_add_ps( _mm_mul_ps( cols[0], x ), _mm_mul_ps( cols[1], y ) ),
+						  _mm_add_ps( _mm_mul_ps( cols[2], z ), cols[3] ) );
+
+		if ( iNumWeights > 1 )
+		{
+			float fTotalWeight = G2_GetVertBoneWeightNotSlow( v, 0 );
+			float fBoneWeight;
+
+			pos = _mm_mul_ps( pos, _mm_set1_ps( fTotalWeight ) );
+			for ( k = 1; k < iNumWeights; k++ )
+			{
+				if ( k < iNumWeights - 1 )
+				{
+					fBoneWeight = G2_GetVertBoneWeightNotSlow( v, k );
+					fTotalWeight += fBoneWeight;
+				}
+				else
+				{
+					fBoneWeight = 1.0f - fTotalWeight;
+				}
+
+				cols = boneCols[G2_GetVertBoneIndex( v, k )];
+				const __m128 t = _mm_add_ps( _mm_add_ps( _mm_mul_ps( cols[0], x ), _mm_mul_ps( cols[1], y ) ),
+											 _mm_add_ps( _mm_mul_ps( cols[2], z ), cols[3] ) );
+				pos = _mm_add_ps( pos, _mm_mul_ps( t, _mm_set1_ps( fBoneWeight ) ) );
+			}
+		}
+
+		_mm_store_ps( outXYZ[i], pos );
+		_mm_store_ps( outNormal[i], nrm );
+	}
+#else
+	const mdxaBone_t *boneRefs[iMAX_G2_BONEREFS_PER_SURFACE];
+
+	for ( i = 0; i < numBoneRefs; i++ )
+	{
+		boneRefs[i] = &bones->EvalRender( piBoneReferences[i] );
+	}
+
+	for ( i = 0; i < numVerts; i++, v++ )
+	{
+		const int			iNumWeights = G2_GetVertWeights( v );
+		const mdxaBone_t	*bone = boneRefs[G2_GetVertBoneIndex( v, 0 )];
+		float				*xyz = outXYZ[i];
+
+		outNormal[i][0] = DotProduct( bone->matrix[0], v->normal );
+		outNormal[i][1] = DotProduct( bone->matrix[1], v->normal );
+		outNormal[i][2] = DotProduct( bone->matrix[2], v->normal );
+
+		xyz[0] = DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3];
+		xyz[1] = DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3];
+		xyz[2] = DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3];
+
+		if ( iNumWeights > 1 )
+		{
+			float fTotalWeight = G2_GetVertBoneWeightNotSlow( v, 0 );
+			float fBoneWeight;
+
+			VectorScale( xyz, fTotalWeight, xyz );
+			for ( k = 1; k < iNumWeights; k++ )
+			{
+				if ( k < iNumWeights - 1 )
+				{
+					fBoneWeight = G2_GetVertBoneWeightNotSlow( v, k );
+					fTotalWeight += fBoneWeight;
+				}
+				else
+				{
+					fBoneWeight = 1.0f - fTotalWeight;
+				}
+
+				bone = boneRefs[G2_GetVertBoneIndex( v, k )];
+				xyz[0] += fBoneWeight * ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
+				xyz[1] += fBoneWeight * ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
+				xyz[2] += fBoneWeight * ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
+			}
+		}
+	}
+#endif
+}
+
+// Skinned surfaces are cached for the rest of the frame, keyed on the bone cache of the ghoul2
+// instance, the surface (which identifies the lod) and the bone cache touch count (which changes
+// whenever the skeleton is re-evaluated). The glow, shadow and portal passes that draw the same
+// surface again then only pay for a copy.
+#define G2_SKINCACHE_HASH_SIZE	1024 // must be a power of two
+#define G2_SKINCACHE_MAX_VERTS	(64*1024)
+
+struct g2SkinCacheEntry_t {
+	const CBoneCache	*bones;
+	const mdxmSurface_t	*surface;
+	int					touch;
+	int					frameCount;
+	int					firstVert;
+};
+
+struct g2SkinCache_t {
+	vec4_t				xyz[G2_SKINCACHE_MAX_VERTS] QALIGN(16);
+	vec4_t				normal[G2_SKINCACHE_MAX_VERTS] QALIGN(16);
+	g2SkinCacheEntry_t	entries[G2_SKINCACHE_HASH_SIZE];
+	int					frameCount;
+	int					numEntries;
+	int					numVerts;
+};
+
+static g2SkinCache_t g2SkinCache;
+
+static void RB_G2SkinSurfaceCached( const mdxmSurface_t *surface, CBoneCache *bones, vec4_t *outXYZ, vec4_t *outNormal )
+{
+	g2SkinCache_t		*cache = &g2SkinCache;
+	g2SkinCacheEntry_t	*entry = NULL;
+	const int			numVerts = surface->numVerts;
+
+	if ( r_Ghoul2SkinCache->integer )
+	{
+		if ( cache->frameCount != tr.frameCount )
+		{
+			cache->frameCount = tr.frameCount;
+			cache->numEntries = 0;
+			cache->numVerts = 0;
+		}
+
+		uint32_t hash = (uint32_t)((size_t)bones >> 4) * 31u + (uint32_t)((size_t)surface >> 2) * 17u + (uint32_t)bones->mCurrentTouch;
+		for ( int probe = 0; probe < G2_SKINCACHE_HASH_SIZE; probe++, hash++ )
+		{
+			g2SkinCacheEntry_t *e = &cache->entries[hash & (G2_SKINCACHE_HASH_SIZE - 1)];
+
+			if ( e->frameCount != cache->frameCount )
+			{
+				// free slot, claim it if there is room left this frame
+				if ( cache->numEntries < G2_SKINCACHE_HASH_SIZE / 2 && cache->numVerts + numVerts <= G2_SKINCACHE_MAX_VERTS )
+				{
+					entry = e;
+				}
+				break;
+			}
+
+			if ( e->bones == bones && e->surface == surface && e->touch == bones->mCurrentTouch )
+			{
+				memcpy( outXYZ, cache->xyz[e->firstVert], sizeof( vec4_t ) * numVerts );
+				memcpy( outNormal, cache->normal[e->firstVert], sizeof( vec4_t ) * numVerts );
+				backEnd.pc.c_g2SkinCacheHits++;
+				return;
+			}
+		}
+	}
+
+	backEnd.pc.c_g2SkinCacheMisses++;
+	backEnd.pc.c_g2SkinnedVerts += numVerts;
+
+	if ( !entry )
+	{
+		RB_G2SkinSurface( surface, bones, outXYZ, outNormal );
+		return;
+	}
+
+	entry->bones = bones;
+	entry->surface = surface;
+	entry->touch = bones->mCurrentTouch;
+	entry->frameCount = cache->frameCount;
+	entry->firstVert = cache->numVerts;
+	cache->numEntries++;
+	cache->numVerts += numVerts;
+
+	RB_G2SkinSurface( surface, bones, &cache->xyz[entry->firstVert], &cache->normal[entry->firstVert] );
+	memcpy( outXYZ, cache->xyz[entry->firstVert], sizeof( vec4_t ) * numVerts );
+	memcpy( outNormal, cache->normal[entry->firstVert], sizeof( vec4_t ) * numVerts );
+}
+
 //This is a slightly mangled version of the same function from the sof2sp base.
 //It provides a pretty significant performance increase over the existing one.
 void RB_SurfaceGhoul( CRenderableSurface *surf )
@@ -3314,7 +3531,7 @@ void RB_SurfaceGhoul( CRenderableSurface *surf )
 	G2PerformanceTimer_RB_SurfaceGhoul.Start();
 #endif
 
-	static int				j, k;
+	static int				j;
 	static int				baseIndex, baseVertex;
 	static int				numVerts;
 	static mdxmVertex_t 	*v;
@@ -3322,7 +3539,6 @@ void RB_SurfaceGhoul( CRenderableSurface *surf )
 	static int				indexes;
 	static glIndex_t		*tessIndexes;
 	static mdxmVertexTexCoord_t *pTexCoords;
-	static int				*piBoneReferences;
 
 #ifdef _G2_GORE
 	if (surf->alternateTex)
@@ -3465,87 +3681,17 @@ void RB_SurfaceGhoul( CRenderableSurface *surf )
 
 	numVerts = surface->numVerts;
 
-	piBoneReferences = (int*) ((byte*)surface + surface->ofsBoneReferences);
 	baseVertex = tess.numVertexes;
 	v = (mdxmVertex_t *) ((byte *)surface + surface->ofsVerts);
 	pTexCoords = (mdxmVertexTexCoord_t *) &v[numVerts];
 
-//	if (r_ghoul2fastnormals&&r_ghoul2fastnormals->integer==0)
-		float fTotalWeight;
-		float fBoneWeight;
-		float t1;
-		float t2;
-		const mdxaBone_t *bone;
-		const mdxaBone_t *bone2;
-		for ( j = 0; j < numVerts; j++, baseVertex++,v++ )
-		{
-
-			bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, 0 )]);
-			int iNumWeights = G2_GetVertWeights( v );
-			tess.normal[baseVertex][0] = DotProduct( bone->matrix[0], v->normal );
-			tess.normal[baseVertex][1] = DotProduct( bone->matrix[1], v->normal );
-			tess.normal[baseVertex][2] = DotProduct( bone->matrix[2], v->normal );
-
-			if (iNumWeights==1)
-			{
-				tess.xyz[baseVertex][0] = ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-				tess.xyz[baseVertex][1] = ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-				tess.xyz[baseVertex][2] = ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-			}
-			else
-			{
-				fBoneWeight = G2_GetVertBoneWeightNotSlow( v, 0);
-				if (iNumWeights==2)
-				{
-					bone2 = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, 1 )]);
-					/*
-					useless transposition
-					tess.xyz[baseVertex][0] =
-					v[0]*(w*(bone->matrix[0][0]-bone2->matrix[0][0])+bone2->matrix[0][0])+
-					v[1]*(w*(bone->matrix[0][1]-bone2->matrix[0][1])+bone2->matrix[0][1])+
-					v[2]*(w*(bone->matrix[0][2]-bone2->matrix[0][2])+bone2->matrix[0][2])+
-					w*(bone->matrix[0][3]-bone2->matrix[0][3]) + bone2->matrix[0][3];
-					*/
-					t1 = ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-					t2 = ( DotProduct( bone2->matrix[0], v->vertCoords ) + bone2->matrix[0][3] );
-					tess.xyz[baseVertex][0] = fBoneWeight * (t1-t2) + t2;
-					t1 = ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-					t2 = ( DotProduct( bone2->matrix[1], v->vertCoords ) + bone2->matrix[1][3] );
-					tess.xyz[baseVertex][1] = fBoneWeight * (t1-t2) + t2;
-					t1 = ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-					t2 = ( DotProduct( bone2->matrix[2], v->vertCoords ) + bone2->matrix[2][3] );
-					tess.xyz[baseVertex][2] = fBoneWeight * (t1-t2) + t2;
-				}
-				else
-				{
-
-					tess.xyz[baseVertex][0] = fBoneWeight * ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-					tess.xyz[baseVertex][1] = fBoneWeight * ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-					tess.xyz[baseVertex][2] = fBoneWeight * ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-
-					fTotalWeight=fBoneWeight;
-					for (k=1; k < iNumWeights-1 ; k++)
-					{
-						bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, k )]);
-						fBoneWeight = G2_GetVertBoneWeightNotSlow( v, k);
-						fTotalWeight += fBoneWeight;
-
-						tess.xyz[baseVertex][0] += fBoneWeight * ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-						tess.xyz[baseVertex][1] += fBoneWeight * ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-						tess.xyz[baseVertex][2] += fBoneWeight * ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-					}
-					bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, k )]);
-					fBoneWeight	= 1.0f-fTotalWeight;
+	RB_G2SkinSurfaceCached( surface, bones, &tess.xyz[baseVertex], &tess.normal[baseVertex] );
 
-					tess.xyz[baseVertex][0] += fBoneWeight * ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-					tess.xyz[baseVertex][1] += fBoneWeight * ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-					tess.xyz[baseVertex][2] += fBoneWeight * ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-				}
-			}
-
-			tess.texCoords[baseVertex][0][0] = pTexCoords[j].texCoords[0];
-			tess.texCoords[baseVertex][0][1] = pTexCoords[j].texCoords[1];
-		}
+	for ( j = 0; j < numVerts; j++, baseVertex++ )
+	{
+		tess.texCoords[baseVertex][0][0] = pTexCoords[j].texCoords[0];
+		tess.texCoords[baseVertex][0][1] = pTexCoords[j].texCoords[1];
+	}
 
 #ifdef _G2_GORE
 	CRenderableSurface *storeSurf = surf;
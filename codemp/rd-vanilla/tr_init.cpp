@@ -92,6 +92,13 @@ PFNGLISPROGRAMARBPROC qglIsProgramARB;
 PFNGLLOCKARRAYSEXTPROC qglLockArraysEXT;
 PFNGLUNLOCKARRAYSEXTPROC qglUnlockArraysEXT;
 
+PFNGLBINDBUFFERARBPROC qglBindBufferARB;
+PFNGLBUFFERDATAARBPROC qglBufferDataARB;
+PFNGLDELETEBUFFERSARBPROC qglDeleteBuffersARB;
+PFNGLGENBUFFERSARBPROC qglGenBuffersARB;
+PFNGLMAPBUFFERARBPROC qglMapBufferARB;
+PFNGLUNMAPBUFFERARBPROC qglUnmapBufferARB;
+
 bool g_bTextureRectangleHack = false;
 
 void R_Splash()
@@ -367,6 +374,45 @@ static void GLimp_InitExtensions( void )
 		Com_Printf ("...GL_EXT_compiled_vertex_array not found\n" );
 	}
 
+	// GL_ARB_pixel_buffer_object
+	qglBindBufferARB = nullptr;
+	qglBufferDataARB = nullptr;
+	qglDeleteBuffersARB = nullptr;
+	qglGenBuffersARB = nullptr;
+	qglMapBufferARB = nullptr;
+	qglUnmapBufferARB = nullptr;
+	if ( ri.GL_ExtensionSupported( "GL_ARB_pixel_buffer_object" ) )
+	{
+		if ( r_ext_pixel_buffer_object->integer )
+		{
+			qglBindBufferARB = ( PFNGLBINDBUFFERARBPROC ) ri.GL_GetProcAddress( "glBindBufferARB" );
+			qglBufferDataARB = ( PFNGLBUFFERDATAARBPROC ) ri.GL_GetProcAddress( "glBufferDataARB" );
+			qglDeleteBuffersARB = ( PFNGLDELETEBUFFERSARBPROC ) ri.GL_GetProcAddress( "glDeleteBuffersARB" );
+			qglGenBuffersARB = ( PFNGLGENBUFFERSARBPROC ) ri.GL_GetProcAddress( "glGenBuffersARB" );
+			qglMapBufferARB = ( PFNGLMAPBUFFERARBPROC ) ri.GL_GetProcAddress( "glMapBufferARB" );
+			qglUnmapBufferARB = ( PFNGLUNMAPBUFFERARBPROC ) ri.GL_GetProcAddress( "glUnmapBufferARB" );
+
+			if ( qglBindBufferARB && qglBufferDataARB && qglDeleteBuffersARB && qglGenBuffersARB && qglMapBufferARB && qglUnmapBufferARB )
+			{
+				Com_Printf ("...using GL_ARB_pixel_buffer_object\n" );
+			}
+			else
+			{
+				// only the video capture checks for these, and it only checks qglGenBuffersARB
+				qglGenBuffersARB = nullptr;
+				Com_Printf ("...GL_ARB_pixel_buffer_object failed\n" );
+			}
+		}
+		else
+		{
+			Com_Printf ("...ignoring GL_ARB_pixel_buffer_object\n" );
+		}
+	}
+	else
+	{
+		Com_Printf ("...GL_ARB_pixel_buffer_object not found\n" );
+	}
+
 	bool bNVRegisterCombiners = false;
 	// Register Combiners.
 	if ( ri.GL_ExtensionSupported( "GL_NV_register_combiners" ) )
@@ -946,76 +992,149 @@ void R_ScreenShot_f (void) {
 		ri.Printf( PRINT_ALL, "[skipnotify]Wrote %s\n", checkname );
 }
 
-const void *RB_TakeVideoFrameCmd( const void *data )
+// video frames are read back into a ring of pixel buffers and only mapped AVI_PIXEL_BUFFERS - 1 frames later, by
+//	which time the transfer is done and glReadPixels no longer stalls the frame waiting on the GPU
+#define AVI_PIXEL_BUFFERS 3
+
+static GLuint	aviPixelBuffers[AVI_PIXEL_BUFFERS];
+static int		aviPixelBufferSize;
+static int		aviPixelBufferHead;
+static int		aviPixelBuffersPending;	// read into but not handed out yet, the oldest is ( head - pending ) % size
+
+void R_ShutdownVideoFrameBuffers( void )
 {
-	const videoFrameCommand_t	*cmd;
-	byte				*cBuf;
-	size_t				memcount, linelen;
-	int				padwidth, avipadwidth, padlen, avipadlen;
-	GLint packAlign;
+	if ( aviPixelBufferSize )
+	{
+		qglDeleteBuffersARB( AVI_PIXEL_BUFFERS, aviPixelBuffers );
+		memset( aviPixelBuffers, 0, sizeof( aviPixelBuffers ) );
+		aviPixelBufferSize = 0;
+	}
+	aviPixelBufferHead = 0;
+	aviPixelBuffersPending = 0;
+}
 
-	cmd = (const videoFrameCommand_t *)data;
+// copies the oldest pending frame out of the ring
+static bool RB_MapVideoFramePixels( byte *cBuf, int memcount )
+{
+	const int oldest = ( aviPixelBufferHead - aviPixelBuffersPending + AVI_PIXEL_BUFFERS ) % AVI_PIXEL_BUFFERS;
+	bool ready = false;
 
-	qglGetIntegerv(GL_PACK_ALIGNMENT, &packAlign);
+	qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, aviPixelBuffers[oldest] );
 
-	linelen = cmd->width * 3;
+	const byte *pixels = (const byte *)qglMapBufferARB( GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB );
+	if ( pixels )
+	{
+		Com_Memcpy( cBuf, pixels, memcount );
+		qglUnmapBufferARB( GL_PIXEL_PACK_BUFFER_ARB );
+		ready = true;
+	}
 
-	// Alignment stuff for glReadPixels
-	padwidth = PAD(linelen, packAlign);
-	padlen = padwidth - linelen;
-	// AVI line padding
-	avipadwidth = PAD(linelen, AVI_LINE_PADDING);
-	avipadlen = avipadwidth - linelen;
+	qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, 0 );
+	aviPixelBuffersPending--;
+
+	return ready;
+}
+
+// returns false while the ring is still filling up and there's no finished frame to hand out yet
+static bool RB_ReadVideoFramePixels( const videoFrameCommand_t *cmd, byte *cBuf, int memcount )
+{
+	if ( !qglGenBuffersARB )
+	{
+		qglReadPixels( 0, 0, cmd->width, cmd->height, GL_RGB, GL_UNSIGNED_BYTE, cBuf );
+		return true;
+	}
+
+	// frames still in flight belong to an earlier recording or resolution
+	if ( cmd->firstFrame || aviPixelBufferSize != memcount )
+	{
+		R_ShutdownVideoFrameBuffers();
+
+		qglGenBuffersARB( AVI_PIXEL_BUFFERS, aviPixelBuffers );
+		for ( int i = 0; i < AVI_PIXEL_BUFFERS; i++ )
+		{
+			qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, aviPixelBuffers[i] );
+			qglBufferDataARB( GL_PIXEL_PACK_BUFFER_ARB, memcount, nullptr, GL_STREAM_READ_ARB );
+		}
+		aviPixelBufferSize = memcount;
+	}
 
-	cBuf = (byte *)PADP(cmd->captureBuffer, packAlign);
+	qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, aviPixelBuffers[aviPixelBufferHead] );
+	qglReadPixels( 0, 0, cmd->width, cmd->height, GL_RGB, GL_UNSIGNED_BYTE, nullptr );
+	qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, 0 );
 
-	qglReadPixels(0, 0, cmd->width, cmd->height, GL_RGB,
-		GL_UNSIGNED_BYTE, cBuf);
+	aviPixelBufferHead = ( aviPixelBufferHead + 1 ) % AVI_PIXEL_BUFFERS;
+	aviPixelBuffersPending++;
 
-	memcount = padwidth * cmd->height;
+	// the next buffer to be written is the oldest one
+	if ( aviPixelBuffersPending < AVI_PIXEL_BUFFERS )
+	{
+		return false;
+	}
 
+	return RB_MapVideoFramePixels( cBuf, memcount );
+}
+
+// same layout glReadPixels produces with the current pack alignment
+static byte *RB_VideoFrameBuffer( int width, int height, byte *captureBuffer, size_t *memcount )
+{
+	GLint packAlign;
+
+	qglGetIntegerv(GL_PACK_ALIGNMENT, &packAlign);
+
+	// Alignment stuff for glReadPixels
+	*memcount = PAD(width * 3, packAlign) * height;
+
+	return (byte *)PADP(captureBuffer, packAlign);
+}
+
+static void RB_QueueVideoFrame( byte *cBuf, size_t memcount )
+{
 	// gamma correct
 	if(glConfig.deviceSupportsGamma && !glConfigExt.doGammaCorrectionWithShaders)
 		R_GammaCorrect(cBuf, memcount);
 
-	if(cmd->motionJpeg)
-	{
-		memcount = RE_SaveJPGToBuffer(cmd->encodeBuffer, linelen * cmd->height,
-			r_aviMotionJpegQuality->integer,
-			cmd->width, cmd->height, cBuf, padlen);
-		ri.CL_WriteAVIVideoFrame(cmd->encodeBuffer, memcount);
-	}
-	else
-	{
-		byte *lineend, *memend;
-		byte *srcptr, *destptr;
+	ri.CL_QueueAVIVideoFrame(cBuf, memcount);
+}
 
-		srcptr = cBuf;
-		destptr = cmd->encodeBuffer;
-		memend = srcptr + memcount;
+// Only reads the frame back, the client converts and writes it on its own thread
+const void *RB_TakeVideoFrameCmd( const void *data )
+{
+	const videoFrameCommand_t	*cmd;
+	byte				*cBuf;
+	size_t				memcount;
 
-		// swap R and B and remove line paddings
-		while(srcptr < memend)
-		{
-			lineend = srcptr + linelen;
-			while(srcptr < lineend)
-			{
-				*destptr++ = srcptr[2];
-				*destptr++ = srcptr[1];
-				*destptr++ = srcptr[0];
-				srcptr += 3;
-			}
+	cmd = (const videoFrameCommand_t *)data;
 
-			Com_Memset(destptr, '\0', avipadlen);
-			destptr += avipadlen;
+	cBuf = RB_VideoFrameBuffer( cmd->width, cmd->height, cmd->captureBuffer, &memcount );
 
-			srcptr += padlen;
-		}
+	if ( RB_ReadVideoFramePixels( cmd, cBuf, memcount ) )
+		RB_QueueVideoFrame( cBuf, memcount );
 
-		ri.CL_WriteAVIVideoFrame(cmd->encodeBuffer, avipadwidth * cmd->height);
+	return (const void *)(cmd + 1);
+}
+
+// Hands the oldest frame still in the readback ring to the client, false once the ring is empty
+bool RE_FlushVideoFrame( int width, int height, byte *captureBuffer )
+{
+	size_t	memcount;
+	byte	*cBuf;
+
+	if ( !tr.registered || !aviPixelBuffersPending )
+		return false;
+
+	R_IssuePendingRenderCommands();
+
+	cBuf = RB_VideoFrameBuffer( width, height, captureBuffer, &memcount );
+	if ( (int)memcount != aviPixelBufferSize )
+	{
+		R_ShutdownVideoFrameBuffers();
+		return false;
 	}
 
-	return (const void *)(cmd + 1);
+	if ( RB_MapVideoFramePixels( cBuf, memcount ) )
+		RB_QueueVideoFrame( cBuf, memcount );
+
+	return true;
 }
 
 void GL_SetDefaultState( void )
@@ -1420,6 +1539,7 @@ void RE_Shutdown( bool destroyWindow, bool restarting ) {
 
 	R_ShutdownWorldEffects();
 	R_ShutdownFonts();
+	R_ShutdownVideoFrameBuffers();
 	if ( tr.registered ) {
 		R_IssuePendingRenderCommands();
 		if (destroyWindow)
@@ -1570,6 +1690,8 @@ Q_EXPORT refexport_t* QDECL GetRefAPI( int apiVersion, refimport_t *rimp ) {
 
 	// AVI recording
 	re.TakeVideoFrame						= RE_TakeVideoFrame;
+	re.FlushVideoFrame						= RE_FlushVideoFrame;
+	re.SaveJPGToBuffer						= RE_SaveJPGToBuffer;
 
 	// G2 stuff
 	re.InitSkins							= R_InitSkins;
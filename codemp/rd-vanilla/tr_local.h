@@ -810,6 +810,9 @@ struct backEndCounters_t {
 	int		c_flareAdds;
 	int		c_flareTests;
 	int		c_flareRenders;
+	int		c_g2SkinCacheHits;
+	int		c_g2SkinCacheMisses;
+	int		c_g2SkinnedVerts;
 	int		msec; // total msec for backend run
 };
 
@@ -1006,8 +1009,7 @@ struct videoFrameCommand_t {
 	int		width;
 	int		height;
 	byte	*captureBuffer;
-	byte	*encodeBuffer;
-	bool	motionJpeg;
+	bool	firstFrame;
 };
 
 // all of the information needed by the back end must be contained in a backEndData_t.
@@ -1142,6 +1144,7 @@ void           R_SetColorMappings                  ( void );
 void           R_SetGammaCorrectionLUT             ( void );
 void           R_SetupEntityLighting               ( const trRefdef_t *refdef, trRefEntity_t *ent );
 void           R_ShaderList_f                      ( void );
+void           R_ShutdownVideoFrameBuffers         ( void );
 void           R_SkinList_f                        ( void );
 srfGridMesh_t *R_SubdividePatchToGrid              ( int width, int height, drawVert_t points[MAX_PATCH_SIZE*MAX_PATCH_SIZE] );
 float          R_SumOfUsedImages                   ( bool bUseFormat );
@@ -1210,6 +1213,7 @@ void           RE_BeginRegistration                ( glconfig_t *glconfig );
 void           RE_ClearDecals                      ( void );
 void           RE_ClearScene                       ( void );
 void           RE_EndFrame                         ( int *frontEndMsec, int *backEndMsec );
+bool           RE_FlushVideoFrame                  ( int width, int height, byte *captureBuffer );
 void           RE_GetBModelVerts                   ( int bmodelIndex, vec3_t *verts, vec3_t normal );
 void           RE_HunkClearCrap                    ( void );
 void           RE_InsertModelIntoHash              ( const char *name, model_t *mod );
@@ -1243,7 +1247,7 @@ const char    *RE_ShaderNameFromIndex              ( int index );
 void           RE_Shutdown                         ( bool destroyWindow );
 void           RE_StretchPic                       ( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );
 void           RE_StretchRaw                       ( int x, int y, int w, int h, int cols, int rows, const byte *data, int client, bool dirty );
-void           RE_TakeVideoFrame                   ( int wfidth, int height, byte *captureBuffer, byte *encodeBuffer, bool motionJpeg );
+void           RE_TakeVideoFrame                   ( int width, int height, byte *captureBuffer, bool firstFrame );
 void           RE_UploadCinematic                  ( int cols, int rows, const byte *data, int client, bool dirty );
 void           SetViewportAndScissor               ( void );
 
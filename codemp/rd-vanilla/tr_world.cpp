@@ -1325,6 +1325,10 @@ bool R_inPVS( const vec3_t p1, const vec3_t p2, byte *mask ) {
 
 	leafnum = ri.CM_PointLeafnum (p2);
 	cluster = ri.CM_LeafCluster (leafnum);
+	if ( cluster < 0 ) {
+		// in solid, don't guess
+		return true;
+	}
 	if ( mask && (!(mask[cluster>>3] & (1<<(cluster&7)) ) ) )
 		return false;
 
@@ -31,6 +31,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "rd-common/tr_public.h"
 
 #define MAX_ENT_CLUSTERS	16
+#define MAX_QUERY_CHALLENGE	128
 #define PERS_SCORE			0 // !!! MUST NOT CHANGE, SERVER AND GAME BOTH REFERENCE !!!
 #define SERVER_MAXBANS		1024
 
@@ -111,11 +112,21 @@ struct demoInfo_t {
 	int          botReliableAcknowledge; // for bots, need to maintain a separate reliableAcknowledge to record server messages into the demo file
 };
 
+// A reliable command shared by every client it was added to. It's huffman coded the first time it goes into a client
+//	message, after that sends and resends just copy the bits
+struct svCommand_t {
+	svCommand_t *next; // free list
+	int          refCount;
+	int          codedBits; // 0 until coded, -1 if it didn't fit
+	byte         coded[MAX_STRING_CHARS * 2];
+	char         text[MAX_STRING_CHARS];
+};
+
 struct client_t {
 	clientState_e     state;
 	char              userinfo[MAX_INFO_STRING]; // name, etc
 	bool              sentGamedir; // see if he has been sent an svc_setgame
-	char              reliableCommands[MAX_RELIABLE_COMMANDS][MAX_STRING_CHARS];
+	svCommand_t      *reliableCommands[MAX_RELIABLE_COMMANDS]; // see SV_ServerCommandText
 	int               reliableSequence; // last added reliable message, not necesarily sent or acknowledged yet
 	int               reliableAcknowledge; // last acknowledged reliable message
 	int               reliableSent; // last sent reliable message, not necesarily acknowledged yet
@@ -195,6 +206,28 @@ struct leakyBucket_t {
 	leakyBucket_t *prev, *next;
 };
 
+// This is deliberately quite large to make it more of an effort to DoS
+#define MAX_BUCKETS			16384
+#define MAX_HASHES			1024
+
+struct leakyBucketTable_t {
+	leakyBucket_t  buckets[MAX_BUCKETS];
+	leakyBucket_t *hashes[MAX_HASHES];
+};
+
+// a serialized getstatus or getinfo reply, the requester's challenge is spliced in between head and tail
+struct queryResponse_t {
+	bool	valid;
+	int		serverInfoGeneration;
+	int		clientsGeneration;
+	int		cvarModifications;
+	int		infoLength;			// length of the info string the challenge is added to
+	int		headLength;
+	int		tailLength;
+	char	head[MAX_MSGLEN];	// out of band header and everything before the challenge
+	char	tail[MAX_MSGLEN];	// everything after the challenge
+};
+
 
 
 extern leakyBucket_t   outboundLeakyBucket;
@@ -212,6 +245,8 @@ int             BotImport_DebugPolygonCreate   ( int color, int numPoints, vec3_
 void            BotImport_DebugPolygonDelete   ( int id );
 void            SV_AddOperatorCommands         ( void );
 void            SV_AddServerCommand            ( client_t *client, const char *cmd );
+void            SV_AddServerCommandRef         ( client_t *client, svCommand_t *command );
+svCommand_t    *SV_AllocServerCommand          ( void );
 int             SV_AreaEntities                ( const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount );
 void            SV_AutoRecordDemo              ( client_t *cl );
 void            SV_BeginAutoRecordDemos        ( void );
@@ -224,9 +259,11 @@ int             SV_BotGetSnapshotEntity        ( int client, int ent );
 void            SV_BotInitBotLib               ( void );
 void            SV_BotInitCvars                ( void );
 void            SV_BotWaypointReception        ( int wpnum, wpobject_t **wps );
+int             SV_BuildQueryPacket            ( char *packet, int size, const queryResponse_t *response, const char *challenge );
 void            SV_ChallengeInit               ( void );
 void            SV_ChallengeShutdown           ( void );
 void            SV_ChangeMaxClients            ( void );
+void            SV_ClearServerCommands         ( client_t *client );
 void            SV_ClearWorld                  ( void );
 void            SV_ClientEnterWorld            ( client_t *client, usercmd_t *cmd );
 void            SV_ClientThink                 ( client_t *cl, usercmd_t *cmd );
@@ -249,6 +286,7 @@ const char     *SV_GetStringEdString           ( char *refSection, char *refName
 void            SV_GetUserinfo                 ( int index, char *buffer, int bufferSize );
 void            SV_Heartbeat_f                 ( void );
 void            SV_InitGameProgs               ( void );
+void            SV_InvalidateQueryCache        ( void );
 bool            SV_inPVS                       ( const vec3_t p1, const vec3_t p2 );
 void            SV_LinkEntity                  ( sharedEntity_t *ent );
 void            SV_MasterHeartbeat             ( void );
@@ -258,7 +296,13 @@ void            SV_Netchan_Transmit            ( client_t *client, msg_t *msg );
 void            SV_Netchan_TransmitNextFragment( netchan_t *chan );
 int             SV_NumForGentity               ( sharedEntity_t *ent );
 int             SV_PointContents               ( const vec3_t p, int passEntityNum );
+void            SV_PublishQueryResponses       ( const queryResponse_t *status, const queryResponse_t *info );
+bool            SV_QueryResponsesPublished     ( void );
+bool            SV_QueryThreadFrame            ( void );
+void            SV_QueryThreadShutdown         ( void );
+int             SV_RadiusEntities              ( const radiusQuery_t *query, int *entityList, float *distList, int maxcount );
 void            SV_RecordDemo                  ( client_t *cl, char *demoName );
+void            SV_ReleaseServerCommand        ( svCommand_t *command );
 void            SV_RemoveOperatorCommands      ( void );
 void            SV_SectorList_f                ( void );
 void            SV_SendClientGameState         ( client_t *client );
@@ -267,8 +311,10 @@ void            SV_SendClientMessages          ( void );
 void            SV_SendClientSnapshot          ( client_t *client );
 void            SV_SendMessageToClient         ( msg_t *msg, client_t *client );
 void            SV_SendServerCommand           ( client_t *cl, const char *fmt, ...);
+const char     *SV_ServerCommandText           ( const client_t *client, int sequence );
 void            SV_SetConfigstring             ( int index, const char *val );
 void            SV_SetUserinfo                 ( int index, const char *val );
+void            SV_ShutdownServerCommands      ( void );
 void            SV_SpawnServer                 ( char *server, bool killBots, ForceReload_e eForceReload );
 void            SV_StopAutoRecordDemos         ( void );
 void            SV_StopRecordDemo              ( client_t *cl );
@@ -283,5 +329,5 @@ void            SV_WriteDemoMessage            ( client_t *cl, msg_t *msg, int h
 void            SV_WriteDownloadToClient       ( client_t *cl , msg_t *msg );
 void            SV_WriteFrameToClient          ( client_t *client, msg_t *msg );
 bool            SVC_RateLimit                  ( leakyBucket_t *bucket, int burst, int period );
-bool            SVC_RateLimitAddress           ( netadr_t from, int burst, int period );
+bool            SVC_RateLimitAddress           ( netadr_t from, int burst, int period, leakyBucketTable_t *table = nullptr );
 
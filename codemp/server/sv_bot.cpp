@@ -28,6 +28,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/cm_public.h"
 #include "server/sv_gameapi.h"
 #include "qcommon/com_cvars.h"
+#include "qcommon/jobs.h"
+
+#include <vector>
 
 struct bot_debugpoly_t {
 	int inuse;
@@ -87,28 +90,167 @@ void SV_BotWaypointReception(int wpnum, wpobject_t **wps)
 	}
 }
 
+#define BOTROUTE_CACHE_IDENT	(('C'<<24)+('P'<<16)+('W'<<8)+'B')
+#define BOTROUTE_CACHE_VERSION	1
+
+// cached neighbour lists, written after the header as a neighbour count followed by that many
+//	waypoint indexes for every waypoint
+struct botRouteCacheHeader_t {
+	int			ident;
+	int			version;
+	int			mapChecksum;
+	uint32_t	wpChecksum;
+	int			numWaypoints;
+};
+
+struct wpPathTrace_t {
+	int			from;
+	int			to;
+	bool		worldClear;
+};
+
+static vec3_t wpPathMins = { -15, -15, -15 };
+static vec3_t wpPathMaxs = { 15, 15, 15 };
+
+static uint32_t SV_WaypointChecksum( void ) {
+	std::vector<float> data( gWPNum * 4 );
+
+	for ( int i = 0; i < gWPNum; i++ ) {
+		if ( gWPArray[i] && gWPArray[i]->inuse ) {
+			VectorCopy( gWPArray[i]->origin, &data[i*4] );
+			data[i*4+3] = 1.0f;
+		}
+	}
+
+	return Com_BlockChecksum( data.data(), data.size() * sizeof( float ) );
+}
+
+static void SV_BotRouteCacheHeader( botRouteCacheHeader_t *header ) {
+	header->ident = BOTROUTE_CACHE_IDENT;
+	header->version = BOTROUTE_CACHE_VERSION;
+	header->mapChecksum = sv_mapChecksum->integer;
+	header->wpChecksum = SV_WaypointChecksum();
+	header->numWaypoints = gWPNum;
+}
+
+// validates the whole file before touching any waypoint so a damaged cache just falls back to tracing
+static bool SV_LoadBotRoutes( const char *path, const botRouteCacheHeader_t *expect ) {
+	int *buffer;
+	long len = FS_ReadFile( path, (void **)&buffer );
+
+	if ( !buffer ) {
+		return false;
+	}
+
+	const int numInts = len / sizeof( int );
+	const int headerInts = sizeof( botRouteCacheHeader_t ) / sizeof( int );
+	bool valid = len >= (long)sizeof( botRouteCacheHeader_t ) && !memcmp( buffer, expect, sizeof( *expect ) );
+	int pos = headerInts;
+
+	for ( int i = 0; valid && i < gWPNum; i++ ) {
+		if ( pos >= numInts || buffer[pos] < 0 || buffer[pos] > MAX_NEIGHBOR_SIZE || pos + 1 + buffer[pos] > numInts ) {
+			valid = false;
+			break;
+		}
+		for ( int k = 0; k < buffer[pos]; k++ ) {
+			const int c = buffer[pos + 1 + k];
+			if ( c < 0 || c >= gWPNum || !gWPArray[c] || !gWPArray[c]->inuse || !gWPArray[i] || !gWPArray[i]->inuse ) {
+				valid = false;
+				break;
+			}
+		}
+		pos += 1 + buffer[pos];
+	}
+
+	if ( valid && pos == numInts ) {
+		pos = headerInts;
+		for ( int i = 0; i < gWPNum; i++ ) {
+			const int count = buffer[pos++];
+			for ( int k = 0; k < count; k++ ) {
+				gWPArray[i]->neighbors[k].num = buffer[pos++];
+				gWPArray[i]->neighbors[k].forceJumpTo = 0;
+			}
+			if ( count ) {
+				gWPArray[i]->neighbornum = count;
+			}
+		}
+	}
+	else {
+		valid = false;
+	}
+
+	FS_FreeFile( buffer );
+	return valid;
+}
+
+static void SV_SaveBotRoutes( const char *path, const botRouteCacheHeader_t *header ) {
+	std::vector<int> data( sizeof( *header ) / sizeof( int ) );
+
+	memcpy( data.data(), header, sizeof( *header ) );
+	for ( int i = 0; i < gWPNum; i++ ) {
+		const int count = ( gWPArray[i] && gWPArray[i]->inuse ) ? gWPArray[i]->neighbornum : 0;
+		data.push_back( count );
+		for ( int k = 0; k < count; k++ ) {
+			data.push_back( gWPArray[i]->neighbors[k].num );
+		}
+	}
+
+	FS_WriteFile( path, data.data(), data.size() * sizeof( int ) );
+}
+
+// world only part of SV_OrgVisibleBox, runs on the job workers with the traces kept off shared collision state
+static void SV_TraceWaypointPaths( void *data, int start, int end ) {
+	wpPathTrace_t *traces = (wpPathTrace_t *)data;
+	trace_t tr;
+
+	CM_ThreadedTraces( true );
+	for ( int i = start; i < end; i++ ) {
+		wpPathTrace_t *t = &traces[i];
+		CM_BoxTrace( &tr, gWPArray[t->from]->origin, gWPArray[t->to]->origin, wpPathMins, wpPathMaxs, 0, MASK_SOLID, 0 );
+		t->worldClear = ( tr.fraction == 1 && !tr.startsolid && !tr.allsolid );
+	}
+	CM_ThreadedTraces( false );
+}
+
+// entities can only block more of a trace, so a path the world leaves clear only needs the full
+//	trace when some entity is linked inside the swept box
+static bool SV_WaypointPathVisible( const wpPathTrace_t *t ) {
+	vec3_t boxMins, boxMaxs;
+	int touch;
+
+	if ( !t->worldClear ) {
+		return false;
+	}
+
+	for ( int k = 0; k < 3; k++ ) {
+		const float *from = gWPArray[t->from]->origin;
+		const float *to = gWPArray[t->to]->origin;
+		boxMins[k] = Q_min( from[k], to[k] ) + wpPathMins[k] - 1;
+		boxMaxs[k] = Q_max( from[k], to[k] ) + wpPathMaxs[k] + 1;
+	}
+
+	if ( !SV_AreaEntities( boxMins, boxMaxs, &touch, 1 ) ) {
+		return true;
+	}
+
+	return SV_OrgVisibleBox( gWPArray[t->from]->origin, wpPathMins, wpPathMaxs, gWPArray[t->to]->origin, ENTITYNUM_NONE ) != 0;
+}
+
 void SV_BotCalculatePaths( int /*rmg*/ )
 {
 	int i;
 	int c;
-	int forceJumpable;
 	int maxNeighborDist = MAX_NEIGHBOR_LINK_DISTANCE;
 	float nLDist;
 	vec3_t a;
-	vec3_t mins, maxs;
+	botRouteCacheHeader_t header;
+	const char *cachePath;
 
 	if (!gWPNum)
 	{
 		return;
 	}
 
-	mins[0] = -15;
-	mins[1] = -15;
-	mins[2] = -15; //-1
-	maxs[0] = 15;
-	maxs[1] = 15;
-	maxs[2] = 15; //1
-
 	//now clear out all the neighbor data before we recalculate
 	i = 0;
 
@@ -128,6 +270,18 @@ void SV_BotCalculatePaths( int /*rmg*/ )
 		i++;
 	}
 
+	SV_BotRouteCacheHeader( &header );
+	cachePath = va( "botroutes/%s.wpc", mapname->string );
+
+	if ( SV_LoadBotRoutes( cachePath, &header ) )
+	{
+		Com_DPrintf( "Loaded bot routes for %i waypoints from %s\n", gWPNum, cachePath );
+		return;
+	}
+
+	//gather every pair that passes the cheap tests, in the order the links are made
+	std::vector<wpPathTrace_t> traces;
+
 	i = 0;
 
 	while (i < gWPNum)
@@ -144,27 +298,11 @@ void SV_BotCalculatePaths( int /*rmg*/ )
 					VectorSubtract(gWPArray[i]->origin, gWPArray[c]->origin, a);
 
 					nLDist = VectorLength(a);
-					forceJumpable = false;//CanForceJumpTo(i, c, nLDist);
 
-					if ((nLDist < maxNeighborDist || forceJumpable) &&
-						((int)gWPArray[i]->origin[2] == (int)gWPArray[c]->origin[2] || forceJumpable) &&
-						(SV_OrgVisibleBox(gWPArray[i]->origin, mins, maxs, gWPArray[c]->origin, ENTITYNUM_NONE) || forceJumpable))
+					if (nLDist < maxNeighborDist &&
+						(int)gWPArray[i]->origin[2] == (int)gWPArray[c]->origin[2])
 					{
-						gWPArray[i]->neighbors[gWPArray[i]->neighbornum].num = c;
-						if (forceJumpable && ((int)gWPArray[i]->origin[2] != (int)gWPArray[c]->origin[2] || nLDist < maxNeighborDist))
-						{
-							gWPArray[i]->neighbors[gWPArray[i]->neighbornum].forceJumpTo = 999;//forceJumpable; //FJSR
-						}
-						else
-						{
-							gWPArray[i]->neighbors[gWPArray[i]->neighbornum].forceJumpTo = 0;
-						}
-						gWPArray[i]->neighbornum++;
-					}
-
-					if (gWPArray[i]->neighbornum >= MAX_NEIGHBOR_SIZE)
-					{
-						break;
+						traces.push_back( { i, c, false } );
 					}
 				}
 				c++;
@@ -172,6 +310,29 @@ void SV_BotCalculatePaths( int /*rmg*/ )
 		}
 		i++;
 	}
+
+	//the world traces only read the collision map so they can run on every core
+	Job_ParallelFor( SV_TraceWaypointPaths, traces.data(), traces.size(), 64 );
+
+	//link in the original order so the neighbor cap keeps the same links
+	for ( const wpPathTrace_t &t : traces )
+	{
+		wpobject_t *wp = gWPArray[t.from];
+
+		if (wp->neighbornum >= MAX_NEIGHBOR_SIZE)
+		{
+			continue;
+		}
+
+		if (SV_WaypointPathVisible(&t))
+		{
+			wp->neighbors[wp->neighbornum].num = t.to;
+			wp->neighbors[wp->neighbornum].forceJumpTo = 0;
+			wp->neighbornum++;
+		}
+	}
+
+	SV_SaveBotRoutes( cachePath, &header );
 }
 
 int SV_BotAllocateClient(void) {
@@ -558,7 +719,7 @@ void SV_BotInitBotLib(void) {
 int SV_BotGetConsoleMessage( int client, char *buf, int size )
 {
 	client_t	*cl;
-	int			index;
+	const char	*cmd;
 
 	cl = &svs.clients[client];
 	cl->lastPacketTime = svs.time;
@@ -568,13 +729,13 @@ int SV_BotGetConsoleMessage( int client, char *buf, int size )
 	}
 
 	cl->reliableAcknowledge++;
-	index = cl->reliableAcknowledge & ( MAX_RELIABLE_COMMANDS - 1 );
+	cmd = SV_ServerCommandText( cl, cl->reliableAcknowledge );
 
-	if ( !cl->reliableCommands[index][0] ) {
+	if ( !cmd[0] ) {
 		return false;
 	}
 
-	Q_strncpyz( buf, cl->reliableCommands[index], size );
+	Q_strncpyz( buf, cmd, size );
 	return true;
 }
 
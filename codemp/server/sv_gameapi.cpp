@@ -991,6 +991,7 @@ void SV_BindGame( void ) {
 	gi.DebugPolygonDelete					= BotImport_DebugPolygonDelete;
 	gi.DropClient							= SV_GameDropClient;
 	gi.EntitiesInBox						= SV_AreaEntities;
+	gi.EntitiesInRadius						= SV_RadiusEntities;
 	gi.EntityContact						= SV_EntityContact;
 	gi.Trace								= SV_Trace;
 	gi.TraceEntity							= SV_ClipToEntity;
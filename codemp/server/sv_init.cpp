@@ -33,21 +33,33 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "server/server.h"
 #include "server/sv_gameapi.h"
 
-// Creates and sends the server command necessary to update the CS index for the given client
+// whether a CS_ACTIVE client gets told about changes to the CS index
+static bool SV_ClientWantsConfigstring( const client_t *client, int index ) {
+	// do not always send server info to all clients
+	return index != CS_SERVERINFO || !client->gentity || !(client->gentity->r.svFlags & SVF_NOSERVERINFO);
+}
+
+// Creates the server commands necessary to update the CS index, once, and adds them to the given client or to every
+//	active client that wants them when client is nullptr
 static void SV_SendConfigstring(client_t *client, int index)
 {
 	int maxChunkSize = MAX_STRING_CHARS - 24;
 	int len;
+	int sent = 0;
+	int remaining;
 
 	len = strlen(sv.configstrings[index]);
+	remaining = len;
+
+	do {
+		svCommand_t	*command = SV_AllocServerCommand();
+		client_t	*cl;
+		int			i;
 
-	if( len >= maxChunkSize ) {
-		int		sent = 0;
-		int		remaining = len;
-		char	*cmd;
-		char	buf[MAX_STRING_CHARS];
+		if( len >= maxChunkSize ) {
+			const char	*cmd;
+			char		buf[MAX_STRING_CHARS];
 
-		while (remaining > 0 ) {
 			if ( sent == 0 ) {
 				cmd = "bcs0";
 			}
@@ -60,17 +72,29 @@ static void SV_SendConfigstring(client_t *client, int index)
 			Q_strncpyz( buf, &sv.configstrings[index][sent],
 				maxChunkSize );
 
-			SV_SendServerCommand( client, "%s %i \"%s\"\n", cmd,
+			Com_sprintf( command->text, sizeof( command->text ), "%s %i \"%s\"\n", cmd,
 				index, buf );
 
 			sent += (maxChunkSize - 1);
 			remaining -= (maxChunkSize - 1);
+		} else {
+			// standard cs, just send it
+			Com_sprintf( command->text, sizeof( command->text ), "cs %i \"%s\"\n", index,
+				sv.configstrings[index] );
+			remaining = 0;
 		}
-	} else {
-		// standard cs, just send it
-		SV_SendServerCommand( client, "cs %i \"%s\"\n", index,
-			sv.configstrings[index] );
-	}
+
+		if ( client ) {
+			SV_AddServerCommandRef( client, command );
+		} else {
+			for (i = 0, cl = svs.clients; i < sv_maxclients->integer ; i++, cl++) {
+				if ( cl->state == CS_ACTIVE && SV_ClientWantsConfigstring( cl, index ) ) {
+					SV_AddServerCommandRef( cl, command );
+				}
+			}
+		}
+		SV_ReleaseServerCommand( command );
+	} while ( remaining > 0 );
 }
 
 // Called when a client goes from CS_PRIMED to CS_ACTIVE.
@@ -84,9 +108,7 @@ void SV_UpdateConfigstrings(client_t *client)
 		if(!client->csUpdated[index])
 			continue;
 
-		// do not always send server info to all clients
-		if ( index == CS_SERVERINFO && client->gentity &&
-			(client->gentity->r.svFlags & SVF_NOSERVERINFO) ) {
+		if ( !SV_ClientWantsConfigstring( client, index ) ) {
 			continue;
 		}
 		SV_SendConfigstring(client, index);
@@ -115,24 +137,22 @@ void SV_SetConfigstring (int index, const char *val) {
 	Z_Free( sv.configstrings[index] );
 	sv.configstrings[index] = CopyString( val );
 
+	if ( index == CS_SERVERINFO ) {
+		SV_InvalidateQueryCache();
+	}
+
 	// send it to all the clients if we aren't
 	// spawning a new server
 	if ( sv.state == SS_GAME || sv.restarting ) {
 
-		// send the data to all relevent clients
+		// primed clients pick it up when they go active
 		for (i = 0, client = svs.clients; i < sv_maxclients->integer ; i++, client++) {
-			if ( client->state < CS_ACTIVE ) {
-				if ( client->state == CS_PRIMED )
-					client->csUpdated[ index ] = true;
-				continue;
-			}
-			// do not always send server info to all clients
-			if ( index == CS_SERVERINFO && client->gentity && (client->gentity->r.svFlags & SVF_NOSERVERINFO) ) {
-				continue;
-			}
-
-			SV_SendConfigstring(client, index);
+			if ( client->state == CS_PRIMED )
+				client->csUpdated[ index ] = true;
 		}
+
+		// send the data to all relevent clients
+		SV_SendConfigstring(nullptr, index);
 	}
 }
 
@@ -268,10 +288,16 @@ void SV_ChangeMaxClients( void ) {
 			oldClients[i] = svs.clients[i];
 		}
 		else {
+			SV_ClearServerCommands( &svs.clients[i] );
 			Com_Memset(&oldClients[i], 0, sizeof(client_t));
 		}
 	}
 
+	// the slots past the highest one in use are dropped as well
+	for ( i = count ; i < oldMaxClients ; i++ ) {
+		SV_ClearServerCommands( &svs.clients[i] );
+	}
+
 	// free old clients arrays
 	Z_Free( svs.clients );
 
@@ -753,7 +779,7 @@ static void SV_InitRef( void ) {
 //	ri.CIN_RunCinematic = CIN_RunCinematic;
 //	ri.CIN_PlayCinematic = CIN_PlayCinematic;
 //	ri.CIN_UploadCinematic = CIN_UploadCinematic;
-//	ri.CL_WriteAVIVideoFrame = CL_WriteAVIVideoFrame;
+//	ri.CL_QueueAVIVideoFrame = CL_QueueAVIVideoFrame;
 
 	// g2 data access
 	ri.GetSharedMemory = GetSharedMemory;
@@ -846,6 +872,7 @@ void SV_Shutdown( char *finalmsg )
 
 	SV_RemoveOperatorCommands();
 	SV_MasterShutdown();
+	SV_QueryThreadShutdown();
 	SV_ChallengeShutdown();
 	SV_ShutdownGameProgs();
 	svs.gameStarted = false;
@@ -864,6 +891,7 @@ void SV_Shutdown( char *finalmsg )
 	if ( svs.clients ) {
 		Z_Free( svs.clients );
 	}
+	SV_ShutdownServerCommands();
 	Com_Memset( &svs, 0, sizeof( svs ) );
 
 	Cvar_Set( "sv_running", "0" );
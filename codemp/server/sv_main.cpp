@@ -60,8 +60,81 @@ char	*SV_ExpandNewlines( char *in ) {
 	return string;
 }
 
-// The given command will be transmitted to the client, and is guaranteed to not have future snapshot_t executed before it is executed
-void SV_AddServerCommand( client_t *client, const char *cmd ) {
+// server commands come from a pool that only grows, so a busy server stops allocating once it has enough
+#define	SERVER_COMMAND_BLOCK	64
+
+struct svCommandBlock_t {
+	svCommandBlock_t	*next;
+	svCommand_t			commands[SERVER_COMMAND_BLOCK];
+};
+
+static svCommandBlock_t	*svCommandBlocks;
+static svCommand_t		*svFreeCommands;
+
+// Returns an empty command holding one reference for the caller to fill in, add to clients and release
+svCommand_t *SV_AllocServerCommand( void ) {
+	svCommand_t *command;
+
+	if ( !svFreeCommands ) {
+		svCommandBlock_t *block = (svCommandBlock_t *)Z_Malloc( sizeof( svCommandBlock_t ), TAG_CLIENTS, false );
+
+		block->next = svCommandBlocks;
+		svCommandBlocks = block;
+		for ( int i = 0 ; i < SERVER_COMMAND_BLOCK ; i++ ) {
+			block->commands[i].next = svFreeCommands;
+			svFreeCommands = &block->commands[i];
+		}
+	}
+
+	command = svFreeCommands;
+	svFreeCommands = command->next;
+
+	command->next = nullptr;
+	command->refCount = 1;
+	command->codedBits = 0;
+	command->text[0] = '\0';
+	return command;
+}
+
+void SV_ReleaseServerCommand( svCommand_t *command ) {
+	if ( --command->refCount > 0 ) {
+		return;
+	}
+	command->next = svFreeCommands;
+	svFreeCommands = command;
+}
+
+// Drops every command the client still holds, before its slot is wiped or reused
+void SV_ClearServerCommands( client_t *client ) {
+	for ( int i = 0 ; i < MAX_RELIABLE_COMMANDS ; i++ ) {
+		if ( client->reliableCommands[i] ) {
+			SV_ReleaseServerCommand( client->reliableCommands[i] );
+			client->reliableCommands[i] = nullptr;
+		}
+	}
+}
+
+// Frees the whole pool, every client_t holding commands must be gone
+void SV_ShutdownServerCommands( void ) {
+	while ( svCommandBlocks ) {
+		svCommandBlock_t *next = svCommandBlocks->next;
+
+		Z_Free( svCommandBlocks );
+		svCommandBlocks = next;
+	}
+	svFreeCommands = nullptr;
+}
+
+// The text of the command at the given reliable sequence, empty if that slot was never filled
+const char *SV_ServerCommandText( const client_t *client, int sequence ) {
+	const svCommand_t *command = client->reliableCommands[ sequence & (MAX_RELIABLE_COMMANDS-1) ];
+
+	return command ? command->text : "";
+}
+
+// The given command will be transmitted to the client, and is guaranteed to not have future snapshot_t executed before
+//	it is executed. The client takes its own reference, so the same command can be added to any number of clients
+void SV_AddServerCommandRef( client_t *client, svCommand_t *command ) {
 	int		index, i;
 
 	// do not send commands until the gamestate has been sent
@@ -77,50 +150,67 @@ void SV_AddServerCommand( client_t *client, const char *cmd ) {
 	if ( client->reliableSequence - client->reliableAcknowledge == MAX_RELIABLE_COMMANDS + 1 ) {
 		Com_Printf( "===== pending server commands =====\n" );
 		for ( i = client->reliableAcknowledge + 1 ; i <= client->reliableSequence ; i++ ) {
-			Com_Printf( "cmd %5d: %s\n", i, client->reliableCommands[ i & (MAX_RELIABLE_COMMANDS-1) ] );
+			Com_Printf( "cmd %5d: %s\n", i, SV_ServerCommandText( client, i ) );
 		}
-		Com_Printf( "cmd %5d: %s\n", i, cmd );
+		Com_Printf( "cmd %5d: %s\n", i, command->text );
 		SV_DropClient( client, "Server command overflow" );
 		return;
 	}
 	index = client->reliableSequence & ( MAX_RELIABLE_COMMANDS - 1 );
-	Q_strncpyz( client->reliableCommands[ index ], cmd, sizeof( client->reliableCommands[ index ] ) );
+	if ( client->reliableCommands[ index ] ) {
+		SV_ReleaseServerCommand( client->reliableCommands[ index ] );
+	}
+	command->refCount++;
+	client->reliableCommands[ index ] = command;
+}
+
+void SV_AddServerCommand( client_t *client, const char *cmd ) {
+	svCommand_t *command = SV_AllocServerCommand();
+
+	Q_strncpyz( command->text, cmd, sizeof( command->text ) );
+	SV_AddServerCommandRef( client, command );
+	SV_ReleaseServerCommand( command );
 }
 
 // Sends a reliable command string to be interpreted by the client game module: "cp", "print", "chat", etc
-// A nullptr client will broadcast to all clients
+// A nullptr client will broadcast to all clients, sharing one copy of the command
 void QDECL SV_SendServerCommand(client_t *cl, const char *fmt, ...) {
 	va_list		argptr;
-	byte		message[MAX_MSGLEN];
+	svCommand_t	*command;
 	client_t	*client;
-	int			j;
+	int			j, len;
+
+	command = SV_AllocServerCommand();
 
 	va_start (argptr,fmt);
-	Q_vsnprintf((char *)message, sizeof(message), fmt, argptr);
+	len = Q_vsnprintf(command->text, sizeof(command->text), fmt, argptr);
 	va_end (argptr);
 
 	// Fix to http://aluigi.altervista.org/adv/q3msgboom-adv.txt
 	// The actual cause of the bug is probably further downstream
 	// and should maybe be addressed later, but this certainly
 	// fixes the problem for now
-	if ( strlen ((char *)message) > 1022 ) {
+	if ( len < 0 || len > 1022 ) {
+		SV_ReleaseServerCommand( command );
 		return;
 	}
 
 	if ( cl != nullptr ) {
-		SV_AddServerCommand( cl, (char *)message );
+		SV_AddServerCommandRef( cl, command );
+		SV_ReleaseServerCommand( command );
 		return;
 	}
 
 	// hack to echo broadcast prints to console
-	if ( dedicated->integer && !Q_strncmp( (char *)message, "print", 5) ) {
-		Com_Printf ("broadcast: %s\n", SV_ExpandNewlines((char *)message) );
+	if ( dedicated->integer && !Q_strncmp( command->text, "print", 5) ) {
+		Com_Printf ("broadcast: %s\n", SV_ExpandNewlines(command->text) );
 	}
 
 	// send the data to all relevent clients
 	for (j = 0, client = svs.clients; j < sv_maxclients->integer ; j++, client++) {
-		SV_AddServerCommand( client, (char *)message );
+		SV_AddServerCommandRef( client, command );
 	}
+	SV_ReleaseServerCommand( command );
 }
 
 // MASTER SERVER FUNCTIONS
@@ -214,12 +304,7 @@ void SV_MasterShutdown( void ) {
 
 // CONNECTIONLESS COMMANDS
 
-// This is deliberately quite large to make it more of an effort to DoS
-#define MAX_BUCKETS			16384
-#define MAX_HASHES			1024
-
-static leakyBucket_t buckets[ MAX_BUCKETS ];
-static leakyBucket_t *bucketHashes[ MAX_HASHES ];
+static leakyBucketTable_t bucketTable;
 leakyBucket_t outboundLeakyBucket;
 
 static long SVC_HashForAddress( netadr_t address ) {
@@ -243,13 +328,13 @@ static long SVC_HashForAddress( netadr_t address ) {
 }
 
 // Find or allocate a bucket for an address
-static leakyBucket_t *SVC_BucketForAddress( netadr_t address, int burst, int period ) {
+static leakyBucket_t *SVC_BucketForAddress( leakyBucketTable_t *table, netadr_t address, int burst, int period ) {
 	leakyBucket_t	*bucket = nullptr;
 	int						i;
 	long					hash = SVC_HashForAddress( address );
 	int						now = Sys_Milliseconds();
 
-	for ( bucket = bucketHashes[ hash ]; bucket; bucket = bucket->next ) {
+	for ( bucket = table->hashes[ hash ]; bucket; bucket = bucket->next ) {
 		switch ( bucket->type ) {
 			case NA_IP:
 				if ( memcmp( bucket->ipv._4, address.ip, 4 ) == 0 ) {
@@ -265,7 +350,7 @@ static leakyBucket_t *SVC_BucketForAddress( netadr_t address, int burst, int per
 	for ( i = 0; i < MAX_BUCKETS; i++ ) {
 		int interval;
 
-		bucket = &buckets[ i ];
+		bucket = &table->buckets[ i ];
 		interval = now - bucket->lastTime;
 
 		// Reclaim expired buckets
@@ -274,7 +359,7 @@ static leakyBucket_t *SVC_BucketForAddress( netadr_t address, int burst, int per
 			if ( bucket->prev != nullptr ) {
 				bucket->prev->next = bucket->next;
 			} else {
-				bucketHashes[ bucket->hash ] = bucket->next;
+				table->hashes[ bucket->hash ] = bucket->next;
 			}
 
 			if ( bucket->next != nullptr ) {
@@ -296,13 +381,13 @@ static leakyBucket_t *SVC_BucketForAddress( netadr_t address, int burst, int per
 			bucket->hash = hash;
 
 			// Add to the head of the relevant hash chain
-			bucket->next = bucketHashes[ hash ];
-			if ( bucketHashes[ hash ] != nullptr ) {
-				bucketHashes[ hash ]->prev = bucket;
+			bucket->next = table->hashes[ hash ];
+			if ( table->hashes[ hash ] != nullptr ) {
+				table->hashes[ hash ]->prev = bucket;
 			}
 
 			bucket->prev = nullptr;
-			bucketHashes[ hash ] = bucket;
+			table->hashes[ hash ] = bucket;
 
 			return bucket;
 		}
@@ -337,60 +422,147 @@ bool SVC_RateLimit( leakyBucket_t *bucket, int burst, int period ) {
 	return true;
 }
 
-// Rate limit for a particular address
-bool SVC_RateLimitAddress( netadr_t from, int burst, int period ) {
-	leakyBucket_t *bucket = SVC_BucketForAddress( from, burst, period );
+// Rate limit for a particular address, the query thread passes a table of its own
+bool SVC_RateLimitAddress( netadr_t from, int burst, int period, leakyBucketTable_t *table ) {
+	leakyBucket_t *bucket = SVC_BucketForAddress( table ? table : &bucketTable, from, burst, period );
 
 	return SVC_RateLimit( bucket, burst, period );
 }
 
-// Responds with all the info that qplug or qspy can see about the server and all connected players.
-// Used for getting detailed information after the simple info query.
-void SVC_Status( netadr_t from ) {
-	char	player[1024];
-	char	status[MAX_MSGLEN];
-	int		i;
-	client_t	*cl;
-	playerState_t	*ps;
-	int		statusLength;
-	int		playerLength;
-	char	infostring[MAX_INFO_STRING];
+// getstatus and getinfo replies are serialized once and resent until the server info, the info cvars or one of the
+//	listed clients changes, only the challenge the requester sent is spliced in between the cached halves
+struct queryClient_t {
+	bool	active;
+	bool	bot;
+	int		score;
+	int		ping;
+	char	name[MAX_NAME_LENGTH];
+};
+
+static queryClient_t	queryClients[MAX_CLIENTS];
+static int				queryNumClients;
+static int				queryClientsGeneration;
+static int				queryServerInfoGeneration;
+static queryResponse_t	statusResponse;
+static queryResponse_t	infoResponse;
+
+// called whenever CS_SERVERINFO is updated
+void SV_InvalidateQueryCache( void ) {
+	queryServerInfoGeneration++;
+}
 
-	// Prevent using getstatus as an amplifier
-	if ( SVC_RateLimitAddress( from, 10, 1000 ) ) {
-		if ( developer->integer ) {
-			Com_Printf( "SVC_Status: rate limit from %s exceeded, dropping request\n",
-				NET_AdrToString( from ) );
+// compares the clients against what the cached replies were built from
+static void SV_UpdateQueryClients( void ) {
+	bool changed = queryNumClients != sv_maxclients->integer;
+
+	queryNumClients = sv_maxclients->integer;
+	for ( int i = 0; i < sv_maxclients->integer; i++ ) {
+		client_t *cl = &svs.clients[i];
+		queryClient_t *qc = &queryClients[i];
+
+		if ( cl->state < CS_CONNECTED ) {
+			changed |= qc->active;
+			qc->active = false;
+			continue;
+		}
+
+		playerState_t *ps = SV_GameClientNum( i );
+		const bool bot = cl->netchan.remoteAddress.type == NA_BOT;
+
+		if ( !qc->active || qc->bot != bot || qc->score != ps->persistant[PERS_SCORE] || qc->ping != cl->ping
+			|| strcmp( qc->name, cl->name ) )
+		{
+			qc->active = true;
+			qc->bot = bot;
+			qc->score = ps->persistant[PERS_SCORE];
+			qc->ping = cl->ping;
+			Q_strncpyz( qc->name, cl->name, sizeof( qc->name ) );
+			changed = true;
 		}
-		return;
 	}
 
-	// Allow getstatus to be DoSed relatively easily, but prevent
-	// excess outbound bandwidth usage when being flooded inbound
-	if ( SVC_RateLimit( &outboundLeakyBucket, 10, 100 ) ) {
-		Com_DPrintf( "SVC_Status: rate limit exceeded, dropping request\n" );
-		return;
+	if ( changed ) {
+		queryClientsGeneration++;
 	}
+}
 
-	// A maximum challenge length of 128 should be more than plenty.
-	if(strlen(Cmd_Argv(1)) > 128)
-		return;
+static bool SV_QueryResponseCurrent( const queryResponse_t *response, int cvarModifications ) {
+	return response->valid
+		&& !( cvar_modifiedFlags & CVAR_SERVERINFO )
+		&& response->serverInfoGeneration == queryServerInfoGeneration
+		&& response->clientsGeneration == queryClientsGeneration
+		&& response->cvarModifications == cvarModifications;
+}
 
-	Q_strncpyz( infostring, Cvar_InfoString( CVAR_SERVERINFO ), sizeof( infostring ) );
+static void SV_SetQueryResponse( queryResponse_t *response, const char *command, const char *head, const char *tail,
+	int infoLength, int cvarModifications )
+{
+	Com_sprintf( response->head, sizeof( response->head ), "\xff\xff\xff\xff%s\n", command );
+	Q_strcat( response->head, sizeof( response->head ), head );
+	response->headLength = strlen( response->head );
+	Q_strncpyz( response->tail, tail, sizeof( response->tail ) );
+	response->tailLength = strlen( response->tail );
+	response->infoLength = infoLength;
+	response->serverInfoGeneration = queryServerInfoGeneration;
+	response->clientsGeneration = queryClientsGeneration;
+	response->cvarModifications = cvarModifications;
+	response->valid = true;
+}
+
+// echo back the parameter so master servers can use it as a challenge to prevent timed spoofed reply packets that
+//	add ghost servers, it is added the way Info_SetValueForKey would add it to the info string
+int SV_BuildQueryPacket( char *packet, int size, const queryResponse_t *response, const char *challenge ) {
+	char	field[MAX_INFO_STRING];
+	int		fieldLength = 0;
+	int		length = Q_min( response->headLength, size - 1 );
 
-	// echo back the parameter to status. so master servers can use it as a challenge
-	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv(1) );
+	memcpy( packet, response->head, length );
+
+	if ( challenge[0] && !strpbrk( challenge, "\\;\"" ) ) {
+		Com_sprintf( field, sizeof( field ), "\\challenge\\%s", challenge );
+		fieldLength = strlen( field );
+		if ( response->infoLength + fieldLength >= MAX_INFO_STRING ) {
+			fieldLength = 0;
+		}
+	}
+
+	fieldLength = Q_min( fieldLength, size - 1 - length );
+	memcpy( packet + length, field, fieldLength );
+	length += fieldLength;
+
+	const int tailLength = Q_min( response->tailLength, size - 1 - length );
+	memcpy( packet + length, response->tail, tailLength );
+	length += tailLength;
+
+	return length;
+}
+
+static void SV_SendQueryResponse( netadr_t from, const queryResponse_t *response, const char *challenge ) {
+	static char	packet[MAX_MSGLEN];
+
+	NET_SendPacket( NS_SERVER, SV_BuildQueryPacket( packet, sizeof( packet ), response, challenge ), packet, from );
+}
+
+static void SV_BuildStatusResponse( void ) {
+	char	player[1024];
+	char	status[MAX_MSGLEN];
+	char	tail[MAX_MSGLEN];
+	int		i;
+	int		statusLength;
+	int		playerLength;
+	char	infostring[MAX_INFO_STRING];
+
+	Q_strncpyz( infostring, Cvar_InfoString( CVAR_SERVERINFO ), sizeof( infostring ) );
+	Info_RemoveKey( infostring, "challenge" );
 
 	status[0] = 0;
 	statusLength = 0;
 
 	for (i=0 ; i < sv_maxclients->integer ; i++) {
-		cl = &svs.clients[i];
-		if ( cl->state >= CS_CONNECTED ) {
-			ps = SV_GameClientNum( i );
+		const queryClient_t *qc = &queryClients[i];
+		if ( qc->active ) {
 			Com_sprintf (player, sizeof(player), "%i %i \"%s\"\n",
-				ps->persistant[PERS_SCORE], cl->ping, cl->name);
+				qc->score, qc->ping, qc->name);
 			playerLength = strlen(player);
 			if (statusLength + playerLength >= (int)sizeof(status) ) {
 				break;		// can't hold any more
@@ -400,44 +572,64 @@ void SVC_Status( netadr_t from ) {
 		}
 	}
 
-	NET_OutOfBandPrint( NS_SERVER, from, "statusResponse\n%s\n%s", infostring, status );
+	// the challenge goes in front of the server info
+	Q_strncpyz( tail, infostring, sizeof( tail ) );
+	Q_strcat( tail, sizeof( tail ), "\n" );
+	Q_strcat( tail, sizeof( tail ), status );
+	SV_SetQueryResponse( &statusResponse, "statusResponse", "", tail, strlen( infostring ), 0 );
 }
 
-// Responds with a short info message that should be enough to determine if a user is interested in a server to do a
-//	full status
-void SVC_Info( netadr_t from ) {
-	int		i, count, humans, wDisable;
-	char	infostring[MAX_INFO_STRING];
-
-	// Prevent using getinfo as an amplifier
+// Responds with all the info that qplug or qspy can see about the server and all connected players.
+// Used for getting detailed information after the simple info query.
+void SVC_Status( netadr_t from ) {
+	// Prevent using getstatus as an amplifier
 	if ( SVC_RateLimitAddress( from, 10, 1000 ) ) {
 		if ( developer->integer ) {
-			Com_Printf( "SVC_Info: rate limit from %s exceeded, dropping request\n",
+			Com_Printf( "SVC_Status: rate limit from %s exceeded, dropping request\n",
 				NET_AdrToString( from ) );
 		}
 		return;
 	}
 
-	// Allow getinfo to be DoSed relatively easily, but prevent
+	// Allow getstatus to be DoSed relatively easily, but prevent
 	// excess outbound bandwidth usage when being flooded inbound
 	if ( SVC_RateLimit( &outboundLeakyBucket, 10, 100 ) ) {
-		Com_DPrintf( "SVC_Info: rate limit exceeded, dropping request\n" );
+		Com_DPrintf( "SVC_Status: rate limit exceeded, dropping request\n" );
 		return;
 	}
 
-	// Check whether Cmd_Argv(1) has a sane length. This was not done in the original Quake3 version which led to the
-	//	Infostring bug discovered by Luigi Auriemma. See http://aluigi.altervista.org/ for the advisory.
-
 	// A maximum challenge length of 128 should be more than plenty.
-	if(strlen(Cmd_Argv(1)) > 128)
+	if(strlen(Cmd_Argv(1)) > MAX_QUERY_CHALLENGE)
 		return;
 
+	SV_UpdateQueryClients();
+
+	if ( !SV_QueryResponseCurrent( &statusResponse, 0 ) ) {
+		SV_BuildStatusResponse();
+	}
+
+	SV_SendQueryResponse( from, &statusResponse, Cmd_Argv(1) );
+}
+
+// sums the modification counts of the cvars getinfo reports that may not be flagged as serverinfo
+static int SV_InfoCvarModifications( void ) {
+	return sv_hostname->modificationCount + mapname->modificationCount + sv_maxclients->modificationCount
+		+ sv_privateClients->modificationCount + g_gametype->modificationCount + g_needpass->modificationCount
+		+ g_jediVmerc->modificationCount + g_duelWeaponDisable->modificationCount + g_weaponDisable->modificationCount
+		+ g_forcePowerDisable->modificationCount + sv_autoDemo->modificationCount + sv_minPing->modificationCount
+		+ sv_maxPing->modificationCount + fs_game->modificationCount;
+}
+
+static void SV_BuildInfoResponse( int cvarModifications ) {
+	int		i, count, humans, wDisable;
+	char	infostring[MAX_INFO_STRING];
+
 	// don't count privateclients
 	count = humans = 0;
 	for ( i = sv_privateClients->integer ; i < sv_maxclients->integer ; i++ ) {
-		if ( svs.clients[i].state >= CS_CONNECTED ) {
+		if ( queryClients[i].active ) {
 			count++;
-			if ( svs.clients[i].netchan.remoteAddress.type != NA_BOT ) {
+			if ( !queryClients[i].bot ) {
 				humans++;
 			}
 		}
@@ -445,10 +637,6 @@ void SVC_Info( netadr_t from ) {
 
 	infostring[0] = 0;
 
-	// echo back the parameter to status. so servers can use it as a challenge
-	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv(1) );
-
 	Info_SetValueForKey( infostring, "protocol", va("%i", PROTOCOL_VERSION) );
 	Info_SetValueForKey( infostring, "hostname", sv_hostname->string );
 	Info_SetValueForKey( infostring, "mapname", mapname->string );
@@ -482,7 +670,65 @@ void SVC_Info( netadr_t from ) {
 		Info_SetValueForKey( infostring, "game", fs_game->string );
 	}
 
-	NET_OutOfBandPrint( NS_SERVER, from, "infoResponse\n%s", infostring );
+	// keys are added in front, so the challenge that used to be set first ends up last
+	SV_SetQueryResponse( &infoResponse, "infoResponse", infostring, "", strlen( infostring ), cvarModifications );
+}
+
+// Responds with a short info message that should be enough to determine if a user is interested in a server to do a
+//	full status
+void SVC_Info( netadr_t from ) {
+	int		cvarModifications;
+
+	// Prevent using getinfo as an amplifier
+	if ( SVC_RateLimitAddress( from, 10, 1000 ) ) {
+		if ( developer->integer ) {
+			Com_Printf( "SVC_Info: rate limit from %s exceeded, dropping request\n",
+				NET_AdrToString( from ) );
+		}
+		return;
+	}
+
+	// Allow getinfo to be DoSed relatively easily, but prevent
+	// excess outbound bandwidth usage when being flooded inbound
+	if ( SVC_RateLimit( &outboundLeakyBucket, 10, 100 ) ) {
+		Com_DPrintf( "SVC_Info: rate limit exceeded, dropping request\n" );
+		return;
+	}
+
+	// Check whether Cmd_Argv(1) has a sane length. This was not done in the original Quake3 version which led to the
+	//	Infostring bug discovered by Luigi Auriemma. See http://aluigi.altervista.org/ for the advisory.
+
+	// A maximum challenge length of 128 should be more than plenty.
+	if(strlen(Cmd_Argv(1)) > MAX_QUERY_CHALLENGE)
+		return;
+
+	SV_UpdateQueryClients();
+	cvarModifications = SV_InfoCvarModifications();
+
+	if ( !SV_QueryResponseCurrent( &infoResponse, cvarModifications ) ) {
+		SV_BuildInfoResponse( cvarModifications );
+	}
+
+	SV_SendQueryResponse( from, &infoResponse, Cmd_Argv(1) );
+}
+
+// brings both cached replies up to date for the query thread, returns true when either had to be rebuilt
+static bool SV_RefreshQueryResponses( void ) {
+	const int	cvarModifications = SV_InfoCvarModifications();
+	bool		rebuilt = false;
+
+	SV_UpdateQueryClients();
+
+	if ( !SV_QueryResponseCurrent( &statusResponse, 0 ) ) {
+		SV_BuildStatusResponse();
+		rebuilt = true;
+	}
+	if ( !SV_QueryResponseCurrent( &infoResponse, cvarModifications ) ) {
+		SV_BuildInfoResponse( cvarModifications );
+		rebuilt = true;
+	}
+
+	return rebuilt;
 }
 
 void SV_FlushRedirect( char *outputbuf ) {
@@ -992,6 +1238,11 @@ void SV_Frame( int msec ) {
 		cvar_modifiedFlags &= ~CVAR_SYSTEMINFO;
 	}
 
+	// handle what the query thread passed on and keep its copy of the getstatus and getinfo replies current
+	if ( SV_QueryThreadFrame() && ( SV_RefreshQueryResponses() || !SV_QueryResponsesPublished() ) ) {
+		SV_PublishQueryResponses( &statusResponse, &infoResponse );
+	}
+
 	if ( com_speeds->integer ) {
 		startTime = Sys_Milliseconds ();
 	} else {
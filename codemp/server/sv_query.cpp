@@ -0,0 +1,307 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2019, OpenJK contributors
+Copyright (C) 2019 - 2020, CleanJoKe contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// sv_query.cpp -- answers getstatus and getinfo on a socket of its own from a separate thread
+
+// With sv_queryPort set, a second socket is opened and only the query thread reads from it. getstatus and getinfo
+//	are rate limited and answered right there from the serialized replies of sv_main.cpp, which the main thread
+//	republishes whenever it rebuilds them. Every other packet, connect and rcon included, is passed to the main thread
+//	through a single producer, single consumer ring and handled in SV_Frame as if it came in on the main socket, the
+//	replies are routed back out through the query socket.
+
+#include "server/server.h"
+#include "qcommon/com_cvar.h"
+#include "qcommon/com_cvars.h"
+
+#include <atomic>
+#include <thread>
+
+#define QUERY_QUEUE_SIZE		256 // must be a power of two
+#define QUERY_QUEUE_MASK		( QUERY_QUEUE_SIZE - 1 )
+#define QUERY_PACKET_SIZE		1400 // what clients keep their packets under, anything larger is dropped
+#define NUM_QUERY_SNAPSHOTS		3
+
+struct queryPacket_t {
+	netadr_t	from;
+	int			length;
+	byte		data[QUERY_PACKET_SIZE];
+};
+
+// the query thread holds at most one snapshot, so with three there is always one free for the main thread to write
+struct querySnapshot_t {
+	std::atomic<int>	readers;
+	queryResponse_t		status;
+	queryResponse_t		info;
+};
+
+static queryPacket_t			queryQueue[QUERY_QUEUE_SIZE];
+static std::atomic<unsigned>	queryQueueHead; // written by the query thread
+static std::atomic<unsigned>	queryQueueTail; // written by the main thread
+
+static querySnapshot_t			querySnapshots[NUM_QUERY_SNAPSHOTS];
+static std::atomic<int>			queryCurrentSnapshot( -1 );
+
+// only used by the query thread
+static leakyBucketTable_t		queryBuckets;
+static leakyBucket_t			queryOutboundBucket;
+
+static std::thread				*queryThread;
+static std::atomic<bool>		queryThreadQuit;
+static int						queryPort; // sv_queryPort the socket was opened for, 0 when closed
+
+static const querySnapshot_t *SV_AcquireQuerySnapshot( void ) {
+	for ( ;; ) {
+		const int current = queryCurrentSnapshot.load();
+
+		if ( current < 0 ) {
+			return nullptr;
+		}
+
+		querySnapshots[current].readers.fetch_add( 1 );
+		if ( queryCurrentSnapshot.load() == current ) {
+			return &querySnapshots[current];
+		}
+
+		// republished in between, the slot may be getting rewritten
+		querySnapshots[current].readers.fetch_sub( 1 );
+	}
+}
+
+static void SV_ReleaseQuerySnapshot( const querySnapshot_t *snapshot ) {
+	const_cast<querySnapshot_t *>( snapshot )->readers.fetch_sub( 1 );
+}
+
+// reads the next token of a connectionless command line, quotes are handled like Cmd_TokenizeString does
+static const char *SV_QueryToken( const char *s, char *token, int size ) {
+	int l = 0;
+
+	while ( *s && *(const unsigned char *)s <= ' ' ) {
+		s++;
+	}
+
+	if ( *s == '"' ) {
+		for ( s++; *s && *s != '"'; s++ ) {
+			if ( l < size - 1 ) {
+				token[l++] = *s;
+			}
+		}
+		if ( *s ) {
+			s++;
+		}
+	}
+	else {
+		for ( ; *(const unsigned char *)s > ' ' && *s != '"'; s++ ) {
+			if ( l < size - 1 ) {
+				token[l++] = *s;
+			}
+		}
+	}
+
+	token[l] = 0;
+	return s;
+}
+
+// answers getstatus and getinfo, returns false when the packet has to go to the main thread instead
+static bool SV_AnswerQuery( netadr_t from, const byte *data, int length ) {
+	static char	packet[MAX_MSGLEN];
+	char		line[MAX_STRING_CHARS];
+	char		command[16];
+	char		challenge[MAX_QUERY_CHALLENGE + 2];
+	const char	*s;
+	int			l;
+
+	// the first line of the packet, read the way MSG_ReadStringLine would
+	for ( l = 0; l < (int)sizeof( line ) - 1 && 4 + l < length; l++ ) {
+		const char c = data[4 + l];
+
+		if ( c == 0 || c == '\n' ) {
+			break;
+		}
+		line[l] = c == '%' ? '.' : c;
+	}
+	line[l] = 0;
+
+	// comments are left to the main thread's tokenizer
+	if ( strstr( line, "//" ) || strstr( line, "/*" ) ) {
+		return false;
+	}
+
+	s = SV_QueryToken( line, command, sizeof( command ) );
+	const bool status = !Q_stricmp( command, "getstatus" );
+	if ( !status && Q_stricmp( command, "getinfo" ) ) {
+		return false;
+	}
+
+	// answered on the main thread until the first replies are published
+	const querySnapshot_t *snapshot = SV_AcquireQuerySnapshot();
+	if ( !snapshot ) {
+		return false;
+	}
+
+	// the same limits as SVC_Status and SVC_Info, counted separately from the main socket
+	SV_QueryToken( s, challenge, sizeof( challenge ) );
+	if ( !SVC_RateLimitAddress( from, 10, 1000, &queryBuckets ) && !SVC_RateLimit( &queryOutboundBucket, 10, 100 )
+		&& strlen( challenge ) <= MAX_QUERY_CHALLENGE )
+	{
+		const int packetLength = SV_BuildQueryPacket( packet, sizeof( packet ),
+			status ? &snapshot->status : &snapshot->info, challenge );
+		NET_SendQueryPacket( packetLength, packet, from );
+	}
+
+	SV_ReleaseQuerySnapshot( snapshot );
+	return true;
+}
+
+// a full queue drops the packet like a busy socket would
+static void SV_ForwardQueryPacket( netadr_t from, const byte *data, int length ) {
+	const unsigned head = queryQueueHead.load( std::memory_order_relaxed );
+
+	if ( length > QUERY_PACKET_SIZE || head - queryQueueTail.load( std::memory_order_acquire ) >= QUERY_QUEUE_SIZE ) {
+		return;
+	}
+
+	queryPacket_t *packet = &queryQueue[head & QUERY_QUEUE_MASK];
+	packet->from = from;
+	packet->length = length;
+	memcpy( packet->data, data, length );
+	queryQueueHead.store( head + 1, std::memory_order_release );
+}
+
+static void SV_QueryThreadLoop( void ) {
+	static byte	data[MAX_MSGLEN + 1];
+	netadr_t	from;
+
+	while ( !queryThreadQuit.load() ) {
+		const int length = NET_GetQueryPacket( &from, data, sizeof( data ), 100 );
+
+		if ( !length ) {
+			continue;
+		}
+
+		if ( length >= 4 && *(int *)data == -1 && SV_AnswerQuery( from, data, length ) ) {
+			continue;
+		}
+
+		SV_ForwardQueryPacket( from, data, length );
+	}
+}
+
+// handles the packets the query thread passed on, replies to them are sent through the query socket
+static void SV_ReadQueryPackets( void ) {
+	static byte	data[MAX_MSGLEN + 1];
+	msg_t		msg;
+
+	for ( ;; ) {
+		const unsigned tail = queryQueueTail.load( std::memory_order_relaxed );
+
+		if ( tail == queryQueueHead.load( std::memory_order_acquire ) ) {
+			break;
+		}
+
+		queryPacket_t *packet = &queryQueue[tail & QUERY_QUEUE_MASK];
+		netadr_t from = packet->from;
+
+		// connect packets are decompressed in place, so they get the room a packet off the main socket has
+		MSG_Init( &msg, data, sizeof( data ) );
+		memcpy( data, packet->data, packet->length );
+		msg.cursize = packet->length;
+		queryQueueTail.store( tail + 1, std::memory_order_release );
+
+		NET_AddQueryRoute( from );
+		Com_RunAndTimeServerPacket( &from, &msg );
+	}
+}
+
+// opens the query socket and starts the thread to follow sv_queryPort, passes on what the thread forwarded, returns
+//	true while the thread is running
+bool SV_QueryThreadFrame( void ) {
+	if ( sv_queryPort->integer != queryPort ) {
+		SV_QueryThreadShutdown();
+
+		// a port that can't be opened is not retried until sv_queryPort changes or the server restarts
+		queryPort = sv_queryPort->integer;
+		if ( queryPort && NET_OpenQuerySocket( queryPort ) ) {
+			queryThreadQuit = false;
+			queryThread = new std::thread( SV_QueryThreadLoop );
+		}
+	}
+
+	if ( !queryThread ) {
+		return false;
+	}
+
+	SV_ReadQueryPackets();
+	return true;
+}
+
+void SV_QueryThreadShutdown( void ) {
+	queryPort = 0;
+
+	if ( !queryThread ) {
+		NET_CloseQuerySocket();
+		return;
+	}
+
+	queryThreadQuit = true;
+	queryThread->join();
+	delete queryThread;
+	queryThread = nullptr;
+	NET_CloseQuerySocket();
+
+	// anything still queued is dropped, the replies are republished once the thread runs again
+	queryQueueHead = 0;
+	queryQueueTail = 0;
+	queryCurrentSnapshot = -1;
+}
+
+bool SV_QueryResponsesPublished( void ) {
+	return queryCurrentSnapshot.load() >= 0;
+}
+
+// only the used part of the buffers is copied
+static void SV_CopyQueryResponse( queryResponse_t *to, const queryResponse_t *from ) {
+	to->valid = from->valid;
+	to->serverInfoGeneration = from->serverInfoGeneration;
+	to->clientsGeneration = from->clientsGeneration;
+	to->cvarModifications = from->cvarModifications;
+	to->infoLength = from->infoLength;
+	to->headLength = from->headLength;
+	to->tailLength = from->tailLength;
+	memcpy( to->head, from->head, from->headLength );
+	memcpy( to->tail, from->tail, from->tailLength );
+}
+
+void SV_PublishQueryResponses( const queryResponse_t *status, const queryResponse_t *info ) {
+	const int current = queryCurrentSnapshot.load();
+
+	for ( int i = 0; i < NUM_QUERY_SNAPSHOTS; i++ ) {
+		querySnapshot_t *snapshot = &querySnapshots[i];
+
+		if ( i == current || snapshot->readers.load() ) {
+			continue;
+		}
+
+		SV_CopyQueryResponse( &snapshot->status, status );
+		SV_CopyQueryResponse( &snapshot->info, info );
+		queryCurrentSnapshot.store( i );
+		return;
+	}
+}
@@ -227,6 +227,30 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 	}
 }
 
+// Writes the command string the way MSG_WriteString would. The huffman coding is done once per command and shared by
+//	every client and resend
+static void SV_WriteServerCommandString( msg_t *msg, svCommand_t *command ) {
+	if ( !command ) {
+		MSG_WriteString( msg, "" );
+		return;
+	}
+
+	if ( !command->codedBits ) {
+		msg_t coded;
+
+		MSG_Init( &coded, command->coded, sizeof( command->coded ) );
+		MSG_Bitstream( &coded );
+		MSG_WriteString( &coded, command->text );
+		command->codedBits = coded.overflowed ? -1 : coded.bit;
+	}
+
+	if ( command->codedBits < 0 ) {
+		MSG_WriteString( msg, command->text );
+	} else {
+		MSG_WriteCodedBits( msg, command->coded, command->codedBits );
+	}
+}
+
 // (re)send all server commands the client hasn't acknowledged yet
 void SV_UpdateServerCommandsToClient( client_t *client, msg_t *msg ) {
 	int		i;
@@ -242,7 +266,7 @@ void SV_UpdateServerCommandsToClient( client_t *client, msg_t *msg ) {
 	for ( i = reliableAcknowledge + 1 ; i <= client->reliableSequence ; i++ ) {
 		MSG_WriteByte( msg, svc_serverCommand );
 		MSG_WriteLong( msg, i );
-		MSG_WriteString( msg, client->reliableCommands[ i & (MAX_RELIABLE_COMMANDS-1) ] );
+		SV_WriteServerCommandString( msg, client->reliableCommands[ i & (MAX_RELIABLE_COMMANDS-1) ] );
 	}
 	client->reliableSent = client->reliableSequence;
 }
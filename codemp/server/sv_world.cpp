@@ -398,6 +398,97 @@ int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int *entityList, int
 	return ap.count;
 }
 
+// RADIUS QUERY
+// The area query sorted by the distance to the nearest point of each entity's bounds, so callers that only want
+// the closest few can pass a small maxcount and still get the right ones.
+
+struct radiusEntity_t {
+	float	dist;
+	int		entityNum;
+};
+
+static int SV_RadiusEntityCompare( const void *a, const void *b ) {
+	const radiusEntity_t *ea = (const radiusEntity_t *)a;
+	const radiusEntity_t *eb = (const radiusEntity_t *)b;
+
+	if ( ea->dist != eb->dist ) {
+		return ea->dist < eb->dist ? -1 : 1;
+	}
+	return ea->entityNum - eb->entityNum;
+}
+
+// fills in the numbers of the entities within the query's radius, and their distances if distList is given
+// returns the number of entities filled in
+int SV_RadiusEntities( const radiusQuery_t *query, int *entityList, float *distList, int maxcount ) {
+	static int				touch[MAX_GENTITIES];
+	static radiusEntity_t	found[MAX_GENTITIES];
+	vec3_t					mins, maxs, v, center;
+	const float				radiusSquared = query->radius * query->radius;
+	int						i, num, count = 0;
+
+	for ( i = 0; i < 3; i++ ) {
+		mins[i] = query->origin[i] - query->radius;
+		maxs[i] = query->origin[i] + query->radius;
+	}
+
+	num = SV_AreaEntities( mins, maxs, touch, MAX_GENTITIES );
+
+	for ( int e = 0; e < num; e++ ) {
+		const sharedEntity_t *gEnt = SV_GentityNum( touch[e] );
+
+		if ( touch[e] == query->passEntityNum ) {
+			continue;
+		}
+		if ( ( gEnt->r.svFlags & query->svFlags ) != query->svFlags ) {
+			continue;
+		}
+
+		// distance from the edge of the bounding box
+		for ( i = 0; i < 3; i++ ) {
+			if ( query->origin[i] < gEnt->r.absmin[i] ) {
+				v[i] = gEnt->r.absmin[i] - query->origin[i];
+			}
+			else if ( query->origin[i] > gEnt->r.absmax[i] ) {
+				v[i] = query->origin[i] - gEnt->r.absmax[i];
+			}
+			else {
+				v[i] = 0;
+			}
+		}
+
+		const float distSquared = DotProduct( v, v );
+		if ( distSquared >= radiusSquared ) {
+			continue;
+		}
+
+		if ( query->flags & RQF_CONE ) {
+			VectorAdd( gEnt->r.absmin, gEnt->r.absmax, center );
+			VectorScale( center, 0.5f, center );
+			VectorSubtract( center, query->origin, v );
+			VectorNormalize( v );
+			if ( DotProduct( v, query->coneDir ) < query->coneDot ) {
+				continue;
+			}
+		}
+
+		found[count].dist = distSquared;
+		found[count].entityNum = touch[e];
+		count++;
+	}
+
+	qsort( found, count, sizeof( found[0] ), SV_RadiusEntityCompare );
+
+	count = Q_min( count, maxcount );
+	for ( i = 0; i < count; i++ ) {
+		entityList[i] = found[i].entityNum;
+		if ( distList ) {
+			distList[i] = sqrtf( found[i].dist );
+		}
+	}
+
+	return count;
+}
+
 struct moveclip_t {
 	vec3_t		boxmins, boxmaxs;// enclose the test object along entire move
 	const float	*mins;